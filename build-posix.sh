@@ -20,3 +20,17 @@ if [ ${#CC} -eq "0" ]; then
 fi
 
 $CC $CFLAGS -o nothing nothing.c $LIBS
+
+$CC $CFLAGS -o pack_assets tools/pack_assets.c $LIBS
+./pack_assets assets.pack ./assets \
+    images/charmap-oldschool.bmp \
+    images/cursor.bmp \
+    images/cursor-resize-vert.bmp \
+    images/cursor-resize-horis.bmp \
+    images/cursor-resize-diag1.bmp \
+    images/cursor-resize-diag2.bmp \
+    sounds/nothing.wav \
+    sounds/something.wav \
+    sounds/dev/ding.wav \
+    sounds/dev/click.wav \
+    sounds/dev/save.wav
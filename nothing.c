@@ -1,4 +1,5 @@
 #include "src/color.c"
+#include "src/cvars.c"
 #include "src/game.c"
 #include "src/game/camera.c"
 #include "src/game/level.c"
@@ -10,10 +11,14 @@
 #include "src/game/level/lava/wavy_rect.c"
 #include "src/game/level/platforms.c"
 #include "src/game/level/player.c"
-#include "src/game/level/explosion.c"
+#include "src/game/level/particles.c"
 #include "src/game/level/regions.c"
 #include "src/game/level/rigid_bodies.c"
+#include "src/game/level/rewind.c"
+#include "src/game/level/level_data.c"
 #include "src/game/level_picker.c"
+#include "src/game/level/level_raster.c"
+#include "src/game/level_thumbnails.c"
 #include "src/game/credits.c"
 #include "src/game/settings.c"
 #include "src/game/sound_samples.c"
@@ -21,13 +26,16 @@
 #include "src/main.c"
 #include "src/math/rand.c"
 #include "src/math/rect.c"
+#include "src/math/rect_grid.c"
 #include "src/math/triangle.c"
 #include "src/sdl/renderer.c"
 #include "src/sdl/texture.c"
+#include "src/sdl/atlas.c"
 #include "src/ui/cursor.c"
 #include "src/ui/console.c"
 #include "src/ui/console_log.c"
 #include "src/ui/edit_field.c"
+#include "src/ui/fuzzy_search.c"
 #include "src/ui/history.c"
 #include "src/ui/wiggly_text.c"
 #include "src/ui/slider.c"
@@ -35,6 +43,7 @@
 #include "src/game/level/level_editor/color_picker.c"
 #include "src/game/level/level_editor/rect_layer.c"
 #include "src/game/level/level_editor/layer_picker.c"
+#include "src/game/level/level_editor/minimap.c"
 #include "src/game/level/level_editor/point_layer.c"
 #include "src/game/level/level_editor/player_layer.c"
 #include "src/game/level/level_editor/layer.c"
@@ -48,5 +57,8 @@
 #include "src/system/str.c"
 #include "src/dynarray.c"
 #include "src/system/file.c"
+#include "src/system/jobs.c"
+#include "src/system/id_table.c"
+#include "src/system/assets.c"
 #include "src/ring_buffer.c"
 #include "src/game/level/phantom_platforms.c"
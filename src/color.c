@@ -134,6 +134,24 @@ Color color_scale(Color c, Color fc)
         fmaxf(fminf(c.a * fc.a, 1.0f), 0.0f));
 }
 
+PackedColor color_pack(Color color)
+{
+    const PackedColor result = {
+        .normal = color_for_sdl(color),
+        .desaturated = color_for_sdl(color_desaturate(color))
+    };
+
+    return result;
+}
+
+PackedColor packed_color_alpha(PackedColor color, float a)
+{
+    const Uint8 alpha = (Uint8) roundf(a * 255.0f);
+    color.normal.a = alpha;
+    color.desaturated.a = alpha;
+    return color;
+}
+
 int color_hex_to_stream(Color color, FILE *stream)
 {
     SDL_Color sdl = color_for_sdl(color);
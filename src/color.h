@@ -13,6 +13,13 @@ typedef struct Color {
     float r, g, b, a;
 } Color;
 
+// Color converted for SDL in advance together with its desaturated
+// variant, which is what the camera draws with in the pause mode
+typedef struct {
+    SDL_Color normal;
+    SDL_Color desaturated;
+} PackedColor;
+
 Color rgba(float r, float g, float b, float a);
 Color hsla(float h, float s, float l, float a);
 Color rgba_to_hsla(Color color);
@@ -31,4 +38,7 @@ Color color_invert(Color c);
 
 Color color_scale(Color c, Color fc);
 
+PackedColor color_pack(Color color);
+PackedColor packed_color_alpha(PackedColor color, float a);
+
 #endif  // COLOR_H_
@@ -9,19 +9,36 @@
 
 #define LEVEL_EDITOR_DETH_LEVEL_COLOR hsla(0.0f, 0.8f, 0.6f, 1.0f)
 
+// The defaults of the console variables (see cvars.h)
+#define DEFAULT_FPS 60
+#define LEVEL_GRAVITY 1500.0f
+#define RIGID_BODIES_MAX_RELAXATION_STEPS 100
+#define WAVE_PILLAR_WIDTH 10.0f
+
+// Where the console variables are saved
+#define CVARS_FILE_PATH "./nothing.cfg"
+
 #define BACKGROUND_LAYERS_COUNT 3
 #define BACKGROUND_LAYERS_STEP 0.2f
+// Default of the background_turds_per_chunk console variable
 #define BACKGROUND_TURDS_PER_CHUNK 5
 #define BACKGROUND_CHUNK_WIDTH 500.0f
 #define BACKGROUND_CHUNK_HEIGHT 500.0f
 
 #define ENTITY_MAX_ID_SIZE 36
+#define ID_MAX_SIZE 36
+#define LABEL_LAYER_ID_MAX_SIZE 36
+#define LABEL_LAYER_TEXT_MAX_SIZE 256
 
 #define SNAPPING_THRESHOLD 10.0f
 
 #define CAMERA_RATIO_X 16.0f
 #define CAMERA_RATIO_Y 9.0f
 
+// Text that ends up shorter than that many pixels on the screen is
+// not rendered by the Level Editor
+#define CAMERA_TEXT_MIN_READABLE_HEIGHT 5.0f
+
 #define METADATA_TITLE_MAX_SIZE 256
 #define METADATA_VERSION_MAX_SIZE 256
 #define METADATA_FILEPATH_MAX_SIZE 512
@@ -33,6 +50,15 @@
 
 #define UNDO_HISTORY_CAPACITY 256
 
+// The level remembers that many frames (at 60 updates per second) for
+// rewinding
+#define REWIND_FRAMES (10 * 60)
+#define REWIND_KEYFRAME_INTERVAL 60
+#define REWIND_CAPACITY (4 * MEGA)
+
+// How many particles a level can have at the same time
+#define PARTICLES_CAPACITY 2048
+
 #define EDIT_FIELD_CAPACITY 256
 
 #define TMPMEM_CAPACITY (640 * KILO)
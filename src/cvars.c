@@ -0,0 +1,229 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "cvars.h"
+#include "system/log.h"
+#include "system/stacktrace.h"
+#include "config.h"
+
+// Must be a power of two and a lot bigger than the amount of the
+// variables, so the probes stay short
+#define CVARS_HASH_CAPACITY 64
+#define CVARS_LINE_CAPACITY 256
+
+Cvar cvar_fps = {
+    .name = "fps",
+    .description = "How many frames per second are rendered",
+    .type = CVAR_TYPE_INT,
+    .int_value = DEFAULT_FPS,
+    .min = 1.0f,
+    .max = 1000.0f
+};
+
+Cvar cvar_level_gravity = {
+    .name = "level_gravity",
+    .description = "Downward acceleration applied to every rigid body",
+    .type = CVAR_TYPE_FLOAT,
+    .float_value = LEVEL_GRAVITY,
+    .min = -100000.0f,
+    .max = 100000.0f
+};
+
+Cvar cvar_relaxation_steps = {
+    .name = "relaxation_steps",
+    .description = "How many times the collision solver may push a body out per update",
+    .type = CVAR_TYPE_INT,
+    .int_value = RIGID_BODIES_MAX_RELAXATION_STEPS,
+    .min = 1.0f,
+    .max = 10000.0f
+};
+
+Cvar cvar_background_turds_per_chunk = {
+    .name = "background_turds_per_chunk",
+    .description = "How many rectangles every background chunk has",
+    .type = CVAR_TYPE_INT,
+    .int_value = BACKGROUND_TURDS_PER_CHUNK,
+    .min = 0.0f,
+    .max = 1000.0f
+};
+
+Cvar cvar_wave_pillar_width = {
+    .name = "wave_pillar_width",
+    .description = "Width of a single pillar of the lava waves",
+    .type = CVAR_TYPE_FLOAT,
+    .float_value = WAVE_PILLAR_WIDTH,
+    .min = 1.0f,
+    .max = 1000.0f
+};
+
+static Cvar *const cvars[] = {
+    &cvar_fps,
+    &cvar_level_gravity,
+    &cvar_relaxation_steps,
+    &cvar_background_turds_per_chunk,
+    &cvar_wave_pillar_width
+};
+#define CVARS_COUNT (sizeof(cvars) / sizeof(cvars[0]))
+
+// Indices into cvars plus one, zero is an empty slot. Built on the
+// first lookup.
+static size_t cvars_hash[CVARS_HASH_CAPACITY];
+static int cvars_hash_built;
+
+static
+void cvars_build_hash(void)
+{
+    for (size_t i = 0; i < CVARS_COUNT; ++i) {
+        size_t slot = string_hash(string_nt(cvars[i]->name)) & (CVARS_HASH_CAPACITY - 1);
+        while (cvars_hash[slot] != 0) {
+            slot = (slot + 1) & (CVARS_HASH_CAPACITY - 1);
+        }
+        cvars_hash[slot] = i + 1;
+    }
+    cvars_hash_built = 1;
+}
+
+Cvar *cvars_find(String name)
+{
+    if (!cvars_hash_built) {
+        cvars_build_hash();
+    }
+
+    size_t slot = string_hash(name) & (CVARS_HASH_CAPACITY - 1);
+    while (cvars_hash[slot] != 0) {
+        Cvar *cvar = cvars[cvars_hash[slot] - 1];
+        if (string_equal(string_nt(cvar->name), name)) {
+            return cvar;
+        }
+        slot = (slot + 1) & (CVARS_HASH_CAPACITY - 1);
+    }
+
+    return NULL;
+}
+
+size_t cvars_count(void)
+{
+    return CVARS_COUNT;
+}
+
+Cvar *cvars_at(size_t index)
+{
+    trace_assert(index < CVARS_COUNT);
+    return cvars[index];
+}
+
+int cvar_set(Cvar *cvar, String value)
+{
+    trace_assert(cvar);
+
+    char buffer[CVARS_LINE_CAPACITY];
+    if (value.count == 0 || value.count >= CVARS_LINE_CAPACITY) {
+        return -1;
+    }
+    memcpy(buffer, value.data, value.count);
+    buffer[value.count] = '\0';
+
+    char *end = NULL;
+    errno = 0;
+
+    switch (cvar->type) {
+    case CVAR_TYPE_INT: {
+        const long x = strtol(buffer, &end, 10);
+        if (errno != 0 || *end != '\0' ||
+            (float) x < cvar->min || (float) x > cvar->max) {
+            return -1;
+        }
+        cvar->int_value = (int) x;
+    } break;
+
+    case CVAR_TYPE_FLOAT: {
+        const float x = strtof(buffer, &end);
+        if (errno != 0 || *end != '\0' || !(cvar->min <= x && x <= cvar->max)) {
+            return -1;
+        }
+        cvar->float_value = x;
+    } break;
+    }
+
+    return 0;
+}
+
+void cvar_format(const Cvar *cvar, char *buffer, size_t buffer_size)
+{
+    trace_assert(cvar);
+    trace_assert(buffer);
+
+    switch (cvar->type) {
+    case CVAR_TYPE_INT:
+        snprintf(buffer, buffer_size, "%d", cvar->int_value);
+        break;
+    case CVAR_TYPE_FLOAT:
+        snprintf(buffer, buffer_size, "%g", (double) cvar->float_value);
+        break;
+    }
+}
+
+int cvars_load(const char *file_path)
+{
+    trace_assert(file_path);
+
+    FILE *f = fopen(file_path, "r");
+    if (f == NULL) {
+        return -1;
+    }
+
+    char line[CVARS_LINE_CAPACITY];
+    while (fgets(line, CVARS_LINE_CAPACITY, f) != NULL) {
+        String input = trim(string_nt(line));
+        if (input.count == 0 || *input.data == '#') {
+            continue;
+        }
+
+        String name = chop_word(&input);
+        String value = trim(input);
+
+        Cvar *cvar = cvars_find(name);
+        if (cvar == NULL) {
+            log_warn("%s: unknown variable %.*s\n",
+                     file_path, (int) name.count, name.data);
+            continue;
+        }
+
+        if (cvar_set(cvar, value) < 0) {
+            log_warn("%s: bad value %.*s for %s\n",
+                     file_path, (int) value.count, value.data, cvar->name);
+        }
+    }
+
+    fclose(f);
+
+    return 0;
+}
+
+int cvars_save(const char *file_path)
+{
+    trace_assert(file_path);
+
+    FILE *f = fopen(file_path, "w");
+    if (f == NULL) {
+        log_fail("Could not open %s for writing\n", file_path);
+        return -1;
+    }
+
+    char value[CVARS_LINE_CAPACITY];
+    for (size_t i = 0; i < CVARS_COUNT; ++i) {
+        cvar_format(cvars[i], value, sizeof(value));
+        fprintf(f, "# %s\n%s %s\n", cvars[i]->description, cvars[i]->name, value);
+    }
+
+    const int failed = ferror(f);
+    fclose(f);
+
+    if (failed) {
+        log_fail("Could not write %s\n", file_path);
+        return -1;
+    }
+
+    return 0;
+}
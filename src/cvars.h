@@ -0,0 +1,53 @@
+#ifndef CVARS_H_
+#define CVARS_H_
+
+#include "system/s.h"
+
+// Console variables. The tunables that used to be compile time
+// constants live here, so they can be changed from the console with
+// `set` while the game is running. The defaults are still in
+// config.h. Every change is saved to CVARS_FILE_PATH and loaded back
+// at startup.
+//
+// The variables are only changed on the main thread in between the
+// frames, so the jobs can read them without any synchronization.
+
+typedef enum {
+    CVAR_TYPE_INT = 0,
+    CVAR_TYPE_FLOAT
+} Cvar_Type;
+
+typedef struct {
+    const char *name;
+    const char *description;
+    Cvar_Type type;
+    // Only the field of the type is used
+    int int_value;
+    float float_value;
+    // Values out of range are rejected
+    float min;
+    float max;
+} Cvar;
+
+extern Cvar cvar_fps;
+extern Cvar cvar_level_gravity;
+extern Cvar cvar_relaxation_steps;
+extern Cvar cvar_background_turds_per_chunk;
+extern Cvar cvar_wave_pillar_width;
+
+// Returns NULL if there is no such variable
+Cvar *cvars_find(String name);
+size_t cvars_count(void);
+Cvar *cvars_at(size_t index);
+
+// Returns -1 if the value cannot be parsed or is out of range
+int cvar_set(Cvar *cvar, String value);
+// Writes the value of the variable as text into the buffer
+void cvar_format(const Cvar *cvar, char *buffer, size_t buffer_size);
+
+// Returns -1 if the file cannot be read. Unknown variables and bad
+// values are skipped with a warning.
+int cvars_load(const char *file_path);
+int cvars_save(const char *file_path);
+
+#endif  // CVARS_H_
@@ -9,10 +9,12 @@
 #include "system/log.h"
 #include "system/lt.h"
 #include "system/nth_alloc.h"
+#include "system/jobs.h"
 #include "ui/console.h"
 #include "ui/edit_field.h"
 #include "ui/cursor.h"
 #include "system/str.h"
+#include "sdl/atlas.h"
 #include "sdl/texture.h"
 #include "game/level/level_editor/background_layer.h"
 #include "game/level/level_editor.h"
@@ -23,10 +25,12 @@ typedef struct Game {
     Lt *lt;
 
     Game_state state;
+    Atlas atlas;
     Sprite_font font;
     Memory level_editor_memory;
     LevelPicker level_picker;
     LevelEditor *level_editor;
+    Minimap *minimap;
     Credits credits;
     Level *level;
     Settings settings;
@@ -36,6 +40,7 @@ typedef struct Game {
     Console *console;
     Cursor cursor;
     int console_enabled;
+    Jobs *jobs;
 } Game;
 
 void game_switch_state(Game *game, Game_state state)
@@ -48,6 +53,40 @@ void game_switch_state(Game *game, Game_state state)
     game->state = state;
 }
 
+// The font is the first image of the atlas, the cursors follow
+#define GAME_ATLAS_FONT 0
+#define GAME_ATLAS_CURSORS 1
+#define GAME_ATLAS_COUNT (GAME_ATLAS_CURSORS + CURSOR_STYLE_N)
+
+typedef struct {
+    const char *image_names[GAME_ATLAS_COUNT];
+    Texture_Image images[GAME_ATLAS_COUNT];
+    LevelPicker *level_picker;
+    const char *level_folder;
+} Game_Loading;
+
+static
+void load_images_job(void *data, size_t begin, size_t end)
+{
+    Game_Loading *loading = data;
+    trace_assert(loading);
+
+    for (size_t i = begin; i < end; ++i) {
+        texture_image_load(&loading->images[i], loading->image_names[i]);
+    }
+}
+
+static
+void populate_level_picker_job(void *data, size_t begin, size_t end)
+{
+    Game_Loading *loading = data;
+    trace_assert(loading);
+    (void) begin;
+    (void) end;
+
+    level_picker_populate(loading->level_picker, loading->level_folder);
+}
+
 Game *create_game(const char *level_folder,
                   const char *sound_sample_files[],
                   size_t sound_sample_files_count,
@@ -63,25 +102,50 @@ Game *create_game(const char *level_folder,
     }
     game->lt = lt;
 
-    game->font.texture = load_bmp_font_texture(
-        renderer,
-        "./assets/images/charmap-oldschool.bmp");
+    game->jobs = PUSH_LT(lt, create_jobs(jobs_default_workers_count()), destroy_jobs);
+    if (game->jobs == NULL) {
+        // Not fatal, everything just runs on the main thread
+        log_warn("Could not start the job workers\n");
+    }
+
+    // Everything that does not need the renderer is decoded on the job
+    // workers, only the textures are uploaded here
+    Game_Loading loading = {
+        .level_picker = &game->level_picker,
+        .level_folder = level_folder
+    };
+    loading.image_names[GAME_ATLAS_FONT] = "images/charmap-oldschool.bmp";
+    for (Cursor_Style style = 0; style < CURSOR_STYLE_N; ++style) {
+        loading.image_names[GAME_ATLAS_CURSORS + style] = cursor_style_tex_files[style];
+    }
+
+    Job_Counter loading_counter = {{0}};
+    for (size_t i = 0; i < GAME_ATLAS_COUNT; ++i) {
+        jobs_submit(game->jobs, job(load_images_job, &loading, i, i + 1), &loading_counter);
+    }
+    jobs_submit(game->jobs, job(populate_level_picker_job, &loading, 0, 1), &loading_counter);
 
     game->level_editor_memory.capacity = LEVEL_EDITOR_MEMORY_CAPACITY;
     game->level_editor_memory.buffer = malloc(LEVEL_EDITOR_MEMORY_CAPACITY);
     trace_assert(game->level_editor_memory.buffer);
 
-    level_picker_populate(&game->level_picker, level_folder);
-
     game->credits = create_credits();
 
+    // Converts the samples in parallel with the jobs above
     game->sound_samples = PUSH_LT(
         lt,
         create_sound_samples(
             sound_sample_files,
-            sound_sample_files_count),
+            sound_sample_files_count,
+            game->jobs),
         destroy_sound_samples);
+
+    jobs_wait(game->jobs, &loading_counter);
+
     if (game->sound_samples == NULL) {
+        for (size_t i = 0; i < GAME_ATLAS_COUNT; ++i) {
+            texture_image_free(&loading.images[i]);
+        }
         RETURN_LT(lt, NULL);
     }
 
@@ -89,29 +153,30 @@ Game *create_game(const char *level_folder,
 
     game->renderer = renderer;
 
+    // The font and the cursors share one texture, so the UI is drawn
+    // without switching textures
+    if (atlas_pack(&game->atlas, loading.images, GAME_ATLAS_COUNT, renderer) < 0) {
+        RETURN_LT(lt, NULL);
+    }
+    PUSH_LT(lt, game->atlas.texture, SDL_DestroyTexture);
+
+    game->font.texture = game->atlas.texture;
+    game->font.rect = game->atlas.rects[GAME_ATLAS_FONT];
+
+    game->cursor.texture = game->atlas.texture;
     for (Cursor_Style style = 0; style < CURSOR_STYLE_N; ++style) {
-        game->cursor.texs[style] = PUSH_LT(
-            lt,
-            texture_from_bmp(cursor_style_tex_files[style], renderer),
-            SDL_DestroyTexture);
-        if (SDL_SetTextureBlendMode(
-                game->cursor.texs[style],
-                SDL_ComposeCustomBlendMode(
-                    SDL_BLENDFACTOR_ONE_MINUS_DST_COLOR,
-                    SDL_BLENDFACTOR_ONE_MINUS_SRC_COLOR,
-                    SDL_BLENDOPERATION_ADD,
-                    SDL_BLENDFACTOR_ONE,
-                    SDL_BLENDFACTOR_ZERO,
-                    SDL_BLENDOPERATION_ADD)) < 0) {
-            log_warn("SDL error while setting blending mode for `%s': %s\n",
-                     cursor_style_tex_files[style],
-                     SDL_GetError());
-        }
+        game->cursor.rects[style] = game->atlas.rects[GAME_ATLAS_CURSORS + style];
+    }
+
+    game->minimap = PUSH_LT(lt, create_minimap(), destroy_minimap);
+    if (game->minimap == NULL) {
+        RETURN_LT(lt, NULL);
     }
 
     game->level_editor = create_level_editor(
         &game->level_editor_memory,
-        &game->cursor);
+        &game->cursor,
+        game->minimap);
 
     game->console = PUSH_LT(
         lt,
@@ -220,7 +285,7 @@ int game_update(Game *game, float delta_time)
 
     switch (game->state) {
     case GAME_STATE_LEVEL: {
-        if (level_update(game->level, delta_time) < 0) {
+        if (level_update(game->level, delta_time, game->jobs) < 0) {
             return -1;
         }
 
@@ -231,7 +296,7 @@ int game_update(Game *game, float delta_time)
     } break;
 
     case GAME_STATE_LEVEL_PICKER: {
-        if (level_picker_update(&game->level_picker, &game->camera, delta_time) < 0) {
+        if (level_picker_update(&game->level_picker, &game->camera, game->jobs, delta_time) < 0) {
             return -1;
         }
 
@@ -255,7 +320,9 @@ int game_update(Game *game, float delta_time)
             return -1;
         }
 
-        level_editor_update(game->level_editor, delta_time);
+        if (level_editor_update(game->level_editor, &game->camera, delta_time) < 0) {
+            return -1;
+        }
     } break;
 
     case GAME_STATE_CREDITS: {
@@ -288,15 +355,7 @@ static int game_event_running(Game *game, const SDL_Event *event)
         case SDL_KEYDOWN: {
             switch (event->key.keysym.sym) {
             case SDLK_r: {
-                game->level = RESET_LT(
-                    game->lt,
-                    game->level,
-                    create_level_from_level_editor(
-                        game->level_editor));
-                if (game->level == NULL) {
-                    game_switch_state(game, GAME_STATE_QUIT);
-                    return -1;
-                }
+                level_restart(game->level);
 
                 level_disable_pause_mode(
                     game->level,
@@ -321,6 +380,11 @@ static int game_event_level_picker(Game *game, const SDL_Event *event)
     trace_assert(game);
     trace_assert(event);
 
+    // The keys are typed into the search query
+    if (game->level_picker.searching) {
+        return level_picker_event(&game->level_picker, event);
+    }
+
     switch (event->type) {
     case SDL_KEYDOWN: {
         switch(event->key.keysym.sym) {
@@ -345,7 +409,8 @@ static int game_event_level_picker(Game *game, const SDL_Event *event)
                 memory_clean(&game->level_editor_memory);
                 game->level_editor = create_level_editor(
                     &game->level_editor_memory,
-                    &game->cursor);
+                    &game->cursor,
+                    game->minimap);
 
                 if (game->level == NULL) {
                     game->level = PUSH_LT(
@@ -428,6 +493,13 @@ int game_event(Game *game, const SDL_Event *event)
             return 0;
         }
     } break;
+
+    // The console keeps its log in a render target, which has to be
+    // redrawn even while the console is closed
+    case SDL_RENDER_TARGETS_RESET:
+    case SDL_RENDER_DEVICE_RESET: {
+        console_handle_event(game->console, event);
+    } break;
     }
 
     // Console event handling
@@ -449,6 +521,10 @@ int game_event(Game *game, const SDL_Event *event)
     } else {
         switch (event->type) {
         case SDL_KEYUP: {
+            if (game->state == GAME_STATE_LEVEL_PICKER && game->level_picker.searching) {
+                break;
+            }
+
             switch (event->key.keysym.sym) {
             case SDLK_BACKQUOTE:
             case SDLK_c: {
@@ -554,6 +630,7 @@ int game_load_level(Game *game, const char *level_filename)
         create_level_editor_from_file(
             &game->level_editor_memory,
             &game->cursor,
+            game->minimap,
             level_filename);
 
     if (!game->level_editor) {
@@ -583,3 +660,21 @@ int game_load_level(Game *game, const char *level_filename)
 
     return 0;
 }
+
+Level *game_level(Game *game)
+{
+    trace_assert(game);
+    return game->state == GAME_STATE_LEVEL ? game->level : NULL;
+}
+
+Rect game_view_port(const Game *game)
+{
+    trace_assert(game);
+    return camera_view_port(&game->camera);
+}
+
+void game_record_frame(Game *game, float update_time, float render_time)
+{
+    trace_assert(game);
+    console_record_frame(game->console, update_time, render_time);
+}
@@ -4,8 +4,10 @@
 #include <SDL.h>
 
 #include "game/sound_samples.h"
+#include "math/rect.h"
 
 typedef struct Game Game;
+typedef struct Level Level;
 
 Game *create_game(const char *platforms_file_path,
                     const char *sound_sample_files[],
@@ -36,6 +38,15 @@ typedef enum Game_state {
 void game_switch_state(Game *game, Game_state state);
 int game_load_level(Game *game, const char *filepath);
 
+// NULL unless a level is being played
+Level *game_level(Game *game);
+// What the camera sees right now, in the world coordinates
+Rect game_view_port(const Game *game);
+
+// How long the last iteration of the main loop took, in milliseconds.
+// render_time is zero when nothing was rendered.
+void game_record_frame(Game *game, float update_time, float render_time);
+
 // defined in main.c. is there a better place for this to be declared?
 float get_display_scale(void);
 
@@ -19,6 +19,24 @@ static SDL_Color camera_sdl_color(const Camera *camera, Color color)
     return color_for_sdl(camera->blackwhite_mode ? color_desaturate(color) : color);
 }
 
+static SDL_Color camera_packed_color(const Camera *camera, PackedColor color)
+{
+    return camera->blackwhite_mode ? color.desaturated : color.normal;
+}
+
+static int camera_set_fill_color(const Camera *camera, SDL_Color sdl_color)
+{
+    if (SDL_SetRenderDrawColor(
+            camera->renderer,
+            sdl_color.r, sdl_color.g, sdl_color.b,
+            camera->debug_mode ? sdl_color.a / 2 : sdl_color.a) < 0) {
+        log_fail("SDL_SetRenderDrawColor: %s\n", SDL_GetError());
+        return -1;
+    }
+
+    return 0;
+}
+
 Camera create_camera(SDL_Renderer *renderer,
                      Sprite_font font)
 {
@@ -64,6 +82,27 @@ int camera_fill_rect(const Camera *camera,
     return 0;
 }
 
+int camera_fill_rect_packed(const Camera *camera,
+                            Rect rect,
+                            PackedColor color)
+{
+    trace_assert(camera);
+
+    const SDL_Rect sdl_rect = rect_for_sdl(
+        camera_rect(camera, rect));
+
+    if (camera_set_fill_color(camera, camera_packed_color(camera, color)) < 0) {
+        return -1;
+    }
+
+    if (SDL_RenderFillRect(camera->renderer, &sdl_rect) < 0) {
+        log_fail("SDL_RenderFillRect: %s\n", SDL_GetError());
+        return -1;
+    }
+
+    return 0;
+}
+
 int camera_draw_rect(const Camera *camera,
                      Rect rect,
                      Color color)
@@ -157,6 +196,35 @@ int camera_fill_triangle(const Camera *camera,
     return 0;
 }
 
+int camera_fill_triangles(const Camera *camera,
+                          Triangle *ts,
+                          size_t count,
+                          PackedColor color)
+{
+    trace_assert(camera);
+    trace_assert(ts || count == 0);
+
+    SDL_Rect view_port;
+    SDL_RenderGetViewport(camera->renderer, &view_port);
+
+    // Same as camera_point, but the view port is fetched only once
+    const Vec2f scale = vec_scala_mult(camera->effective_scale, camera->scale);
+    const Vec2f center = vec((float) view_port.w * 0.5f, (float) view_port.h * 0.5f);
+    for (size_t i = 0; i < count; ++i) {
+        Vec2f *ps[3] = {&ts[i].p1, &ts[i].p2, &ts[i].p3};
+        for (size_t j = 0; j < 3; ++j) {
+            ps[j]->x = (ps[j]->x - camera->position.x) * scale.x + center.x;
+            ps[j]->y = (ps[j]->y - camera->position.y) * scale.y + center.y;
+        }
+    }
+
+    if (camera_set_fill_color(camera, camera_packed_color(camera, color)) < 0) {
+        return -1;
+    }
+
+    return fill_triangles(camera->renderer, ts, count);
+}
+
 int camera_render_text(const Camera *camera,
                        const char *text,
                        Vec2f size,
@@ -255,6 +323,14 @@ int camera_is_point_visible(const Camera *camera, Vec2f p)
         camera_point(camera, p));
 }
 
+int camera_is_text_readable(const Camera *camera, Vec2f size)
+{
+    trace_assert(camera);
+
+    return camera_screen_size(camera, size).y * FONT_CHAR_HEIGHT
+        >= CAMERA_TEXT_MIN_READABLE_HEIGHT;
+}
+
 Rect camera_view_port(const Camera *camera)
 {
     trace_assert(camera);
@@ -339,6 +415,13 @@ Rect camera_rect(const Camera *camera, const Rect rect)
             vec(rect.x + rect.w, rect.y + rect.h)));
 }
 
+Vec2f camera_screen_size(const Camera *camera, Vec2f size)
+{
+    return vec_scala_mult(
+        vec_entry_mult(size, camera->effective_scale),
+        camera->scale);
+}
+
 int camera_render_debug_rect(const Camera *camera,
                              Rect rect,
                              Color c)
@@ -430,6 +513,30 @@ void camera_render_text_screen(const Camera *camera,
         text);
 }
 
+int camera_draw_point_screen(const Camera *camera,
+                             Vec2f p,
+                             Color color)
+{
+    trace_assert(camera);
+
+    const SDL_Color sdl_color = camera_sdl_color(camera, color);
+
+    if (SDL_SetRenderDrawColor(camera->renderer, sdl_color.r, sdl_color.g, sdl_color.b, sdl_color.a) < 0) {
+        log_fail("SDL_SetRenderDrawColor: %s\n", SDL_GetError());
+        return -1;
+    }
+
+    if (SDL_RenderDrawPoint(
+            camera->renderer,
+            (int)roundf(p.x),
+            (int)roundf(p.y)) < 0) {
+        log_fail("SDL_RenderDrawPoint: %s\n", SDL_GetError());
+        return -1;
+    }
+
+    return 0;
+}
+
 int camera_draw_thicc_rect_screen(const Camera *camera,
                                   Rect rect,
                                   Color color,
@@ -30,6 +30,10 @@ int camera_fill_rect(const Camera *camera,
                      Rect rect,
                      Color color);
 
+int camera_fill_rect_packed(const Camera *camera,
+                            Rect rect,
+                            PackedColor color);
+
 int camera_draw_rect(const Camera *camera,
                      Rect rect,
                      Color color);
@@ -55,6 +59,12 @@ int camera_fill_triangle(const Camera *camera,
                          Triangle t,
                          Color color);
 
+// ts are transformed into the screen space in place
+int camera_fill_triangles(const Camera *camera,
+                          Triangle *ts,
+                          size_t count,
+                          PackedColor color);
+
 int camera_render_text(const Camera *camera,
                        const char *text,
                        Vec2f size,
@@ -82,6 +92,7 @@ void camera_toggle_debug_mode(Camera *camera);
 void camera_disable_debug_mode(Camera *camera);
 
 int camera_is_point_visible(const Camera *camera, Vec2f p);
+int camera_is_text_readable(const Camera *camera, Vec2f size);
 int camera_is_text_visible(const Camera *camera,
                            Vec2f size,
                            Vec2f position,
@@ -96,6 +107,11 @@ Vec2f camera_map_screen(const Camera *camera,
 
 Vec2f camera_point(const Camera *camera, const Vec2f p);
 Rect camera_rect(const Camera *camera, const Rect rect);
+Vec2f camera_screen_size(const Camera *camera, Vec2f size);
+
+int camera_draw_point_screen(const Camera *camera,
+                             Vec2f p,
+                             Color color);
 
 int camera_fill_rect_screen(const Camera *camera,
                             Rect rect,
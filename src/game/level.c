@@ -11,23 +11,21 @@
 #include "game/level/lava.h"
 #include "game/level/platforms.h"
 #include "game/level/phantom_platforms.h"
+#include "game/level/particles.h"
 #include "game/level/player.h"
 #include "game/level/regions.h"
 #include "game/level/rigid_bodies.h"
-#include "game/level/level_editor/rect_layer.h"
-#include "game/level/level_editor/point_layer.h"
-#include "game/level/level_editor/player_layer.h"
-#include "game/level/level_editor/label_layer.h"
-#include "game/level/level_editor/background_layer.h"
+#include "game/level/rewind.h"
 #include "system/log.h"
 #include "system/lt.h"
 #include "system/nth_alloc.h"
 #include "system/str.h"
-#include "game/level/level_editor.h"
-#include "ui/console.h"
+#include "system/memory.h"
+#include "cvars.h"
 
-#define LEVEL_GRAVITY 1500.0f
 #define JOYSTICK_THRESHOLD 1000
+#define LEVEL_SPAWNED_BOX_SIZE_MIN 20.0f
+#define LEVEL_SPAWNED_BOX_SIZE_MAX 60.0f
 
 typedef enum {
     LEVEL_STATE_IDLE = 0,
@@ -50,11 +48,22 @@ struct Level
     Labels *labels;
     Regions *regions;
     Phantom_Platforms pp;
+    Particles *particles;
+
+    // The state of the level right after it was created. level_restart
+    // goes back to it.
+    size_t snapshot_size;
+    void *initial_snapshot;
+
+    Rewind *rewind;
+    void *snapshot;
+    bool rewinding;
+    bool rewind_disabled;
 };
 
-Level *create_level_from_level_editor(const LevelEditor *level_editor)
+Level *create_level(const Level_Data *data)
 {
-    trace_assert(level_editor);
+    trace_assert(data);
 
     Lt *lt = create_lt();
 
@@ -67,20 +76,25 @@ Level *create_level_from_level_editor(const LevelEditor *level_editor)
     }
     level->lt = lt;
 
-    level->background = create_background(
-        color_picker_rgba(
-            &level_editor->background_layer.color_picker));
+    level->background = create_background(data->background_color);
 
     level->rigid_bodies = PUSH_LT(lt, create_rigid_bodies(1024), destroy_rigid_bodies);
     if (level->rigid_bodies == NULL) {
         RETURN_LT(lt, NULL);
     }
 
+    level->particles = PUSH_LT(lt, create_particles(PARTICLES_CAPACITY), destroy_particles);
+    if (level->particles == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+
     level->player = PUSH_LT(
         lt,
-        create_player_from_player_layer(
-            &level_editor->player_layer,
-            level->rigid_bodies),
+        create_player(
+            data->player_position,
+            data->player_color,
+            level->rigid_bodies,
+            level->particles),
         destroy_player);
     if (level->player == NULL) {
         RETURN_LT(lt, NULL);
@@ -88,7 +102,7 @@ Level *create_level_from_level_editor(const LevelEditor *level_editor)
 
     level->platforms = PUSH_LT(
         lt,
-        create_platforms_from_rect_layer(level_editor->platforms_layer),
+        create_platforms(&data->platforms),
         destroy_platforms);
     if (level->platforms == NULL) {
         RETURN_LT(lt, NULL);
@@ -96,7 +110,7 @@ Level *create_level_from_level_editor(const LevelEditor *level_editor)
 
     level->goals = PUSH_LT(
         lt,
-        create_goals_from_point_layer(level_editor->goals_layer),
+        create_goals(&data->goals),
         destroy_goals);
     if (level->goals == NULL) {
         RETURN_LT(lt, NULL);
@@ -104,7 +118,7 @@ Level *create_level_from_level_editor(const LevelEditor *level_editor)
 
     level->lava = PUSH_LT(
         lt,
-        create_lava_from_rect_layer(level_editor->lava_layer),
+        create_lava(&data->lava),
         destroy_lava);
     if (level->lava == NULL) {
         RETURN_LT(lt, NULL);
@@ -112,7 +126,7 @@ Level *create_level_from_level_editor(const LevelEditor *level_editor)
 
     level->back_platforms = PUSH_LT(
         lt,
-        create_platforms_from_rect_layer(level_editor->back_platforms_layer),
+        create_platforms(&data->back_platforms),
         destroy_platforms);
     if (level->back_platforms == NULL) {
         RETURN_LT(lt, NULL);
@@ -120,7 +134,7 @@ Level *create_level_from_level_editor(const LevelEditor *level_editor)
 
     level->boxes = PUSH_LT(
         lt,
-        create_boxes_from_rect_layer(level_editor->boxes_layer, level->rigid_bodies),
+        create_boxes(&data->boxes, level->rigid_bodies),
         destroy_boxes);
     if (level->boxes == NULL) {
         RETURN_LT(lt, NULL);
@@ -128,7 +142,7 @@ Level *create_level_from_level_editor(const LevelEditor *level_editor)
 
     level->labels = PUSH_LT(
         lt,
-        create_labels_from_label_layer(level_editor->label_layer),
+        create_labels(&data->labels),
         destroy_labels);
     if (level->labels == NULL) {
         RETURN_LT(lt, NULL);
@@ -136,8 +150,8 @@ Level *create_level_from_level_editor(const LevelEditor *level_editor)
 
     level->regions = PUSH_LT(
         lt,
-        create_regions_from_rect_layer(
-            level_editor->regions_layer,
+        create_regions(
+            &data->regions,
             level->labels,
             level->goals),
         destroy_regions);
@@ -145,7 +159,35 @@ Level *create_level_from_level_editor(const LevelEditor *level_editor)
         RETURN_LT(lt, NULL);
     }
 
-    level->pp = create_phantom_platforms(level_editor->pp_layer);
+    level->pp = create_phantom_platforms(&data->pp);
+
+    level->snapshot_size = level_snapshot_size(level);
+    level->initial_snapshot = PUSH_LT(lt, nth_calloc(1, level->snapshot_size), free);
+    if (level->initial_snapshot == NULL) {
+        destroy_phantom_platforms(level->pp);
+        RETURN_LT(lt, NULL);
+    }
+    level_snapshot(level, level->initial_snapshot, level->snapshot_size);
+
+    level->snapshot = PUSH_LT(lt, nth_calloc(1, level->snapshot_size), free);
+    if (level->snapshot == NULL) {
+        destroy_phantom_platforms(level->pp);
+        RETURN_LT(lt, NULL);
+    }
+
+    level->rewind = PUSH_LT(
+        lt,
+        create_rewind(
+            level->snapshot_size,
+            REWIND_FRAMES,
+            REWIND_KEYFRAME_INTERVAL,
+            REWIND_CAPACITY),
+        destroy_rewind);
+    if (level->rewind == NULL) {
+        destroy_phantom_platforms(level->pp);
+        RETURN_LT(lt, NULL);
+    }
+    rewind_push(level->rewind, level->initial_snapshot);
 
     return level;
 }
@@ -175,6 +217,10 @@ int level_render(const Level *level, const Camera *camera)
         return -1;
     }
 
+    if (particles_render(level->particles, camera) < 0) {
+        return -1;
+    }
+
     if (boxes_render(level->boxes, camera) < 0) {
         return -1;
     }
@@ -202,38 +248,254 @@ int level_render(const Level *level, const Camera *camera)
     return 0;
 }
 
-int level_update(Level *level, float delta_time)
+typedef struct {
+    Level *level;
+    float delta_time;
+} LevelUpdate;
+
+static
+void level_update_regions(void *data, size_t begin, size_t end)
+{
+    (void) begin;
+    (void) end;
+    LevelUpdate *update = data;
+
+    regions_update(
+        update->level->regions,
+        update->level->player,
+        update->level->boxes);
+}
+
+static
+void level_update_goals(void *data, size_t begin, size_t end)
+{
+    (void) begin;
+    (void) end;
+    LevelUpdate *update = data;
+
+    goals_update(update->level->goals, update->delta_time);
+}
+
+static
+void level_update_labels(void *data, size_t begin, size_t end)
+{
+    (void) begin;
+    (void) end;
+    LevelUpdate *update = data;
+
+    labels_update(update->level->labels, update->delta_time);
+}
+
+static
+void level_update_lava(void *data, size_t begin, size_t end)
+{
+    (void) begin;
+    (void) end;
+    LevelUpdate *update = data;
+
+    lava_update(update->level->lava, update->delta_time);
+}
+
+static
+void level_update_phantom_platforms(void *data, size_t begin, size_t end)
+{
+    (void) begin;
+    (void) end;
+    LevelUpdate *update = data;
+
+    Rect hitbox = player_hitbox(update->level->player);
+    phantom_platforms_hide_at(&update->level->pp, vec(hitbox.x, hitbox.y));
+    phantom_platforms_update(&update->level->pp, update->delta_time);
+}
+
+static
+void level_update_particles(void *data, size_t begin, size_t end)
+{
+    (void) begin;
+    (void) end;
+    LevelUpdate *update = data;
+
+    particles_update(update->level->particles, update->delta_time);
+}
+
+int level_update(Level *level, float delta_time, Jobs *jobs)
 {
     trace_assert(level);
     trace_assert(delta_time > 0);
 
+    // Only for as long as the key is held. If nobody polled the input
+    // since the last update (the console is open, say) the level goes
+    // on.
+    const bool rewinding = level->rewinding;
+    level->rewinding = false;
+
     if (level->state == LEVEL_STATE_PAUSE) {
         return 0;
     }
 
-    boxes_float_in_lava(level->boxes, level->lava);
-    rigid_bodies_apply_omniforce(level->rigid_bodies, vec(0.0f, LEVEL_GRAVITY));
+    if (rewinding) {
+        if (rewind_step_back(level->rewind, level->snapshot)) {
+            level_restore(level, level->snapshot, level->snapshot_size);
+        }
+        return 0;
+    }
+
+    boxes_float_in_lava(level->boxes, level->lava, jobs);
+    rigid_bodies_apply_omniforce(level->rigid_bodies, vec(0.0f, cvar_level_gravity.float_value));
 
-    boxes_update(level->boxes, delta_time);
+    if (boxes_update(level->boxes, delta_time, jobs) < 0) {
+        return -1;
+    }
     player_update(level->player, delta_time);
 
-    rigid_bodies_collide(level->rigid_bodies, level->platforms);
+    rigid_bodies_collide(level->rigid_bodies, level->platforms, jobs);
 
     player_die_from_lava(level->player, level->lava);
-    regions_player_enter(level->regions, level->player);
-    regions_player_leave(level->regions, level->player);
-
-    goals_update(level->goals, delta_time);
-    lava_update(level->lava, delta_time);
-    labels_update(level->labels, delta_time);
 
-    Rect hitbox = player_hitbox(level->player);
-    phantom_platforms_hide_at(&level->pp, vec(hitbox.x, hitbox.y));
-    phantom_platforms_update(&level->pp, delta_time);
+    // The rest of the update only reads the physics and writes its own
+    // data, so it fans out like this:
+    //
+    //   regions -> goals
+    //           -> labels
+    //   lava
+    //   phantom platforms
+    //   particles
+    //
+    // Regions show and hide goals and labels, that's why those wait
+    // for the regions. Each subsystem still sees exactly the same state
+    // as in the serial order.
+    LevelUpdate update = {
+        .level = level,
+        .delta_time = delta_time
+    };
+    Job_Counter regions_done = {{0}};
+    Job_Counter all_done = {{0}};
+
+    jobs_submit(jobs, job(level_update_regions, &update, 0, 1), &regions_done);
+    jobs_submit_after(jobs, job(level_update_goals, &update, 0, 1), &all_done, &regions_done);
+    jobs_submit_after(jobs, job(level_update_labels, &update, 0, 1), &all_done, &regions_done);
+    jobs_submit(jobs, job(level_update_lava, &update, 0, 1), &all_done);
+    jobs_submit(jobs, job(level_update_phantom_platforms, &update, 0, 1), &all_done);
+    jobs_submit(jobs, job(level_update_particles, &update, 0, 1), &all_done);
+
+    jobs_wait(jobs, &all_done);
+
+    if (!level->rewind_disabled) {
+        level_snapshot(level, level->snapshot, level->snapshot_size);
+        rewind_push(level->rewind, level->snapshot);
+    }
 
     return 0;
 }
 
+static
+void level_snapshot_core(Level *level, Snapshot *snapshot)
+{
+    trace_assert(level);
+    trace_assert(snapshot);
+
+    rigid_bodies_snapshot(level->rigid_bodies, snapshot);
+    player_snapshot(level->player, snapshot);
+    goals_snapshot(level->goals, snapshot);
+    lava_snapshot(level->lava, snapshot);
+    boxes_snapshot(level->boxes, snapshot);
+    labels_snapshot(level->labels, snapshot);
+    regions_snapshot(level->regions, snapshot);
+    phantom_platforms_snapshot(&level->pp, snapshot);
+    particles_snapshot(level->particles, snapshot);
+}
+
+size_t level_snapshot_size(Level *level)
+{
+    trace_assert(level);
+
+    Snapshot snapshot = snapshot_measure();
+    level_snapshot_core(level, &snapshot);
+    return snapshot.size;
+}
+
+void level_snapshot(Level *level, void *buffer, size_t size)
+{
+    trace_assert(level);
+    trace_assert(buffer);
+
+    Snapshot snapshot = snapshot_save(buffer, size);
+    level_snapshot_core(level, &snapshot);
+    trace_assert(snapshot.size == size);
+}
+
+void level_restore(Level *level, const void *buffer, size_t size)
+{
+    trace_assert(level);
+    trace_assert(buffer);
+
+    Snapshot snapshot = snapshot_restore(buffer, size);
+    level_snapshot_core(level, &snapshot);
+    trace_assert(snapshot.size == size);
+}
+
+void level_restart(Level *level)
+{
+    trace_assert(level);
+    level_restore(level, level->initial_snapshot, level->snapshot_size);
+    rewind_clean(level->rewind);
+    rewind_push(level->rewind, level->initial_snapshot);
+}
+
+size_t level_spawn_boxes(Level *level, Rng *rng, size_t count, Rect area)
+{
+    trace_assert(level);
+    trace_assert(rng);
+
+    const size_t capacity_left = boxes_capacity_left(level->boxes);
+    if (count > capacity_left) {
+        count = capacity_left;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        const float size = rng_float_range(
+            rng, LEVEL_SPAWNED_BOX_SIZE_MIN, LEVEL_SPAWNED_BOX_SIZE_MAX);
+        const float x = rng_float_range(rng, area.x, area.x + area.w - size);
+        const float y = rng_float_range(rng, area.y, area.y + area.h - size);
+        const Color color = hsla(rng_float_range(rng, 0.0f, 360.0f), 0.8f, 0.5f, 1.0f);
+
+        boxes_add_box(level->boxes, rect(x, y, size, size), color);
+    }
+
+    return count;
+}
+
+void level_clear_boxes(Level *level)
+{
+    trace_assert(level);
+    boxes_clear(level->boxes);
+}
+
+Player *level_player(Level *level)
+{
+    trace_assert(level);
+    return level->player;
+}
+
+const Goals *level_goals(const Level *level)
+{
+    trace_assert(level);
+    return level->goals;
+}
+
+const Boxes *level_boxes(const Level *level)
+{
+    trace_assert(level);
+    return level->boxes;
+}
+
+void level_disable_rewind(Level *level)
+{
+    trace_assert(level);
+    level->rewind_disabled = true;
+    level->rewinding = false;
+}
+
 static
 int level_event_idle(Level *level, const SDL_Event *event,
                      Camera *camera, Sound_samples *sound_samples)
@@ -322,6 +584,8 @@ int level_input(Level *level,
         return 0;
     }
 
+    level->rewinding = keyboard_state[SDL_SCANCODE_BACKSPACE];
+
     if (keyboard_state[SDL_SCANCODE_A] || keyboard_state[SDL_SCANCODE_LEFT]) {
         player_move_left(level->player);
     } else if (keyboard_state[SDL_SCANCODE_D] || keyboard_state[SDL_SCANCODE_RIGHT]) {
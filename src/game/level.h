@@ -7,17 +7,19 @@
 #include "game/level/platforms.h"
 #include "game/level/player.h"
 #include "sound_samples.h"
+#include "math/rand.h"
+#include "system/jobs.h"
+#include "game/level/level_data.h"
 
 typedef struct Level Level;
-typedef struct LevelEditor LevelEditor;
 
-Level *create_level_from_level_editor(const LevelEditor *level_editor);
+Level *create_level(const Level_Data *data);
 void destroy_level(Level *level);
 
 int level_render(const Level *level, const Camera *camera);
 
 int level_sound(Level *level, Sound_samples *sound_samples);
-int level_update(Level *level, float delta_time);
+int level_update(Level *level, float delta_time, Jobs *jobs);
 
 int level_event(Level *level, const SDL_Event *event,
                 Camera *camera, Sound_samples *sound_samples);
@@ -29,4 +31,27 @@ int level_enter_camera_event(Level *level, Camera *camera);
 void level_disable_pause_mode(Level *level, Camera *camera,
                               Sound_samples *sound_samples);
 
+// Copies all the runtime state of the level into one contiguous
+// buffer of level_snapshot_size bytes and back. The size never
+// changes during the life of the level.
+size_t level_snapshot_size(Level *level);
+void level_snapshot(Level *level, void *buffer, size_t size);
+void level_restore(Level *level, const void *buffer, size_t size);
+
+// Puts the level back into the state it was created in
+void level_restart(Level *level);
+
+// For stress testing. Spawns boxes of random sizes and colors inside
+// of the area and returns how many of them fit into the level.
+size_t level_spawn_boxes(Level *level, Rng *rng, size_t count, Rect area);
+void level_clear_boxes(Level *level);
+
+// For driving the level without the window and the input devices
+// (see tools/validate_levels.c). A level with the rewind disabled
+// does not snapshot itself every update.
+Player *level_player(Level *level);
+const Goals *level_goals(const Level *level);
+const Boxes *level_boxes(const Level *level);
+void level_disable_rewind(Level *level);
+
 #endif  // LEVEL_H_
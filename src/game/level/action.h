@@ -1,6 +1,8 @@
 #ifndef ACTION_H_
 #define ACTION_H_
 
+#include <stdbool.h>
+
 #include "config.h"
 
 typedef enum {
@@ -14,6 +16,8 @@ typedef enum {
 typedef struct {
     ActionType type;
     char entity_id[ENTITY_MAX_ID_SIZE];
+    // The region is activated by the boxes as well as by the player
+    bool boxes;
 } Action;
 
 #endif  // ACTION_H_
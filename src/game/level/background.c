@@ -8,6 +8,7 @@
 #include "system/log.h"
 #include "system/stacktrace.h"
 #include "config.h"
+#include "cvars.h"
 
 static inline
 Vec2i chunk_of_point(Vec2f p)
@@ -73,14 +74,17 @@ int render_chunk(const Camera *camera,
         return 0;
     }
 
-    srand((unsigned int)(roundf((float)chunk.x + (float)chunk.y + camera->scale * 10.0f)));
+    // The same chunk of the same layer always gets the same turds
+    Rng rng = create_rng(
+        hash_2d(chunk.x, chunk.y, (uint32_t) roundf(camera->scale * 10.0f)),
+        0);
 
-    for (size_t i = 0; i < BACKGROUND_TURDS_PER_CHUNK; ++i) {
-        const float rect_x = rand_float_range(0.0f, BACKGROUND_CHUNK_WIDTH);
-        const float rect_y = rand_float_range(0.0f, BACKGROUND_CHUNK_HEIGHT);
+    for (int i = 0; i < cvar_background_turds_per_chunk.int_value; ++i) {
+        const float rect_x = rng_float_range(&rng, 0.0f, BACKGROUND_CHUNK_WIDTH);
+        const float rect_y = rng_float_range(&rng, 0.0f, BACKGROUND_CHUNK_HEIGHT);
 
-        const float rect_w = rand_float_range(0.0f, BACKGROUND_CHUNK_WIDTH * 0.5f);
-        const float rect_h = rand_float_range(rect_w * 0.5f, rect_w * 1.5f);
+        const float rect_w = rng_float_range(&rng, 0.0f, BACKGROUND_CHUNK_WIDTH * 0.5f);
+        const float rect_h = rng_float_range(&rng, rect_w * 0.5f, rect_w * 1.5f);
 
         if (camera_fill_rect(
                 camera,
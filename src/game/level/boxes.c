@@ -2,16 +2,17 @@
 
 #include "dynarray.h"
 #include "game/level/boxes.h"
-#include "game/level/level_editor/rect_layer.h"
 #include "game/level/player.h"
 #include "game/level/rigid_bodies.h"
-#include "math/rand.h"
 #include "system/log.h"
 #include "system/lt.h"
 #include "system/nth_alloc.h"
 #include "system/str.h"
 #include "config.h"
 
+// Levels with fewer boxes than that are updated on a single thread
+#define BOXES_JOB_GRAIN 64
+
 struct Boxes
 {
     Lt *lt;
@@ -21,7 +22,7 @@ struct Boxes
     Dynarray body_colors;
 };
 
-Boxes *create_boxes_from_rect_layer(const RectLayer *layer, RigidBodies *rigid_bodies)
+Boxes *create_boxes(const Level_Rects *layer, RigidBodies *rigid_bodies)
 {
     trace_assert(layer);
     trace_assert(rigid_bodies);
@@ -36,19 +37,20 @@ Boxes *create_boxes_from_rect_layer(const RectLayer *layer, RigidBodies *rigid_b
 
     boxes->boxes_ids = create_dynarray_malloc(ENTITY_MAX_ID_SIZE);
     boxes->body_ids = create_dynarray_malloc(sizeof(RigidBodyId));
-    boxes->body_colors = create_dynarray_malloc(sizeof(Color));
+    boxes->body_colors = create_dynarray_malloc(sizeof(PackedColor));
 
     boxes->rigid_bodies = rigid_bodies;
 
-    const size_t count = rect_layer_count(layer);
-    Rect const *rects = rect_layer_rects(layer);
-    Color const *colors = rect_layer_colors(layer);
-    const char *ids = rect_layer_ids(layer);
+    const size_t count = layer->count;
+    Rect const *rects = layer->rects;
+    Color const *colors = layer->colors;
+    const char *ids = layer->ids;
 
     for (size_t i = 0; i < count; ++i) {
         RigidBodyId body_id = rigid_bodies_add(rigid_bodies, rects[i]);
         dynarray_push(&boxes->body_ids, &body_id);
-        dynarray_push(&boxes->body_colors, &colors[i]);
+        const PackedColor color = color_pack(colors[i]);
+        dynarray_push(&boxes->body_colors, &color);
         dynarray_push(&boxes->boxes_ids, ids + i * ENTITY_MAX_ID_SIZE);
     }
 
@@ -78,7 +80,7 @@ int boxes_render(Boxes *boxes, const Camera *camera)
 
     const size_t count = boxes->body_ids.count;
     RigidBodyId *body_ids = (RigidBodyId *)boxes->body_ids.data;
-    Color *body_colors = (Color *)boxes->body_colors.data;
+    PackedColor *body_colors = (PackedColor *)boxes->body_colors.data;
 
     for (size_t i = 0; i < count; ++i) {
         if (rigid_bodies_render(
@@ -93,34 +95,95 @@ int boxes_render(Boxes *boxes, const Camera *camera)
     return 0;
 }
 
+typedef struct {
+    Boxes *boxes;
+    Lava *lava;
+    float delta_time;
+} BoxesJob;
+
+static
+void boxes_update_job(void *data, size_t begin, size_t end)
+{
+    BoxesJob *boxes_job = data;
+    trace_assert(boxes_job);
+
+    RigidBodyId *body_ids = (RigidBodyId *)boxes_job->boxes->body_ids.data;
+
+    // Every box owns its rigid body, so the ranges never overlap
+    for (size_t i = begin; i < end; ++i) {
+        rigid_bodies_update(
+            boxes_job->boxes->rigid_bodies,
+            body_ids[i],
+            boxes_job->delta_time);
+    }
+}
+
 int boxes_update(Boxes *boxes,
-                 float delta_time)
+                 float delta_time,
+                 Jobs *jobs)
 {
     trace_assert(boxes);
 
-    const size_t count = boxes->body_ids.count;
-    RigidBodyId *body_ids = (RigidBodyId *)boxes->body_ids.data;
+    BoxesJob boxes_job = {
+        .boxes = boxes,
+        .delta_time = delta_time
+    };
 
-    for (size_t i = 0; i < count; ++i) {
-        if (rigid_bodies_update(boxes->rigid_bodies, body_ids[i], delta_time) < 0) {
-            return -1;
-        }
-    }
+    jobs_parallel_for(
+        jobs,
+        boxes_update_job, &boxes_job,
+        boxes->body_ids.count,
+        BOXES_JOB_GRAIN);
 
     return 0;
 }
 
-void boxes_float_in_lava(Boxes *boxes, Lava *lava)
+static
+void boxes_float_in_lava_job(void *data, size_t begin, size_t end)
+{
+    BoxesJob *boxes_job = data;
+    trace_assert(boxes_job);
+
+    RigidBodyId *body_ids = (RigidBodyId*)boxes_job->boxes->body_ids.data;
+
+    for (size_t i = begin; i < end; ++i) {
+        lava_float_rigid_body(
+            boxes_job->lava,
+            boxes_job->boxes->rigid_bodies,
+            body_ids[i]);
+    }
+}
+
+void boxes_float_in_lava(Boxes *boxes, Lava *lava, Jobs *jobs)
 {
     trace_assert(boxes);
     trace_assert(lava);
 
-    const size_t count = boxes->body_ids.count;
-    RigidBodyId *body_ids = (RigidBodyId*)boxes->body_ids.data;
+    BoxesJob boxes_job = {
+        .boxes = boxes,
+        .lava = lava
+    };
 
-    for (size_t i = 0; i < count; ++i) {
-        lava_float_rigid_body(lava, boxes->rigid_bodies, body_ids[i]);
-    }
+    jobs_parallel_for(
+        jobs,
+        boxes_float_in_lava_job, &boxes_job,
+        boxes->body_ids.count,
+        BOXES_JOB_GRAIN);
+}
+
+size_t boxes_count(const Boxes *boxes)
+{
+    trace_assert(boxes);
+    return boxes->body_ids.count;
+}
+
+Rect boxes_hitbox(const Boxes *boxes, size_t index)
+{
+    trace_assert(boxes);
+    trace_assert(index < boxes->body_ids.count);
+
+    const RigidBodyId *body_ids = (const RigidBodyId *)boxes->body_ids.data;
+    return rigid_bodies_hitbox(boxes->rigid_bodies, body_ids[index]);
 }
 
 int boxes_add_box(Boxes *boxes, Rect rect, Color color)
@@ -129,7 +192,8 @@ int boxes_add_box(Boxes *boxes, Rect rect, Color color)
 
     RigidBodyId body_id = rigid_bodies_add(boxes->rigid_bodies, rect);
     dynarray_push(&boxes->body_ids, &body_id);
-    dynarray_push(&boxes->body_colors, &color);
+    const PackedColor packed_color = color_pack(color);
+    dynarray_push(&boxes->body_colors, &packed_color);
 
     return 0;
 }
@@ -155,3 +219,40 @@ int boxes_delete_at(Boxes *boxes, Vec2f position)
 
     return 0;
 }
+
+void boxes_clear(Boxes *boxes)
+{
+    trace_assert(boxes);
+
+    RigidBodyId *body_ids = (RigidBodyId *)boxes->body_ids.data;
+    for (size_t i = 0; i < boxes->body_ids.count; ++i) {
+        rigid_bodies_remove(boxes->rigid_bodies, body_ids[i]);
+    }
+
+    dynarray_clear(&boxes->body_ids);
+    dynarray_clear(&boxes->body_colors);
+}
+
+size_t boxes_capacity_left(const Boxes *boxes)
+{
+    trace_assert(boxes);
+
+    const size_t dynarray_left = DYNARRAY_CAPACITY - boxes->body_ids.count;
+    const size_t rigid_bodies_left = rigid_bodies_capacity_left(boxes->rigid_bodies);
+    return dynarray_left < rigid_bodies_left ? dynarray_left : rigid_bodies_left;
+}
+
+void boxes_snapshot(Boxes *boxes, Snapshot *snapshot)
+{
+    trace_assert(boxes);
+    trace_assert(snapshot);
+
+    // The whole capacity of the arrays is captured so the size of the
+    // snapshot does not depend on how many boxes were added or deleted
+    SNAPSHOT_FIELD(snapshot, boxes->body_ids.count);
+    snapshot_bytes(snapshot, boxes->body_ids.data,
+                   DYNARRAY_CAPACITY * boxes->body_ids.element_size);
+    SNAPSHOT_FIELD(snapshot, boxes->body_colors.count);
+    snapshot_bytes(snapshot, boxes->body_colors.data,
+                   DYNARRAY_CAPACITY * boxes->body_colors.element_size);
+}
@@ -4,21 +4,29 @@
 #include "game/camera.h"
 #include "game/level/platforms.h"
 #include "lava.h"
+#include "system/jobs.h"
+#include "game/level/snapshot.h"
 
 typedef struct Boxes Boxes;
 typedef struct Player Player;
-typedef struct Player Player;
-typedef struct RectLayer RectLayer;
 
-Boxes *create_boxes_from_rect_layer(const RectLayer *layer, RigidBodies *rigid_bodies);
+Boxes *create_boxes(const Level_Rects *layer, RigidBodies *rigid_bodies);
 void destroy_boxes(Boxes *boxes);
 
 int boxes_render(Boxes *boxes, const Camera *camera);
-int boxes_update(Boxes *boxes, float delta_time);
+int boxes_update(Boxes *boxes, float delta_time, Jobs *jobs);
+
+void boxes_float_in_lava(Boxes *boxes, Lava *lava, Jobs *jobs);
 
-void boxes_float_in_lava(Boxes *boxes, Lava *lava);
+size_t boxes_count(const Boxes *boxes);
+Rect boxes_hitbox(const Boxes *boxes, size_t index);
 
 int boxes_add_box(Boxes *boxes, Rect rect, Color color);
 int boxes_delete_at(Boxes *boxes, Vec2f position);
+void boxes_clear(Boxes *boxes);
+// How many more boxes boxes_add_box can take
+size_t boxes_capacity_left(const Boxes *boxes);
+
+void boxes_snapshot(Boxes *boxes, Snapshot *snapshot);
 
 #endif  // BOXES_H_
@@ -3,7 +3,6 @@
 
 #include <SDL.h>
 
-#include "game/level/level_editor/point_layer.h"
 #include "goals.h"
 #include "math/pi.h"
 #include "math/triangle.h"
@@ -12,6 +11,7 @@
 #include "system/nth_alloc.h"
 #include "system/stacktrace.h"
 #include "system/str.h"
+#include "system/id_table.h"
 
 #define GOAL_RADIUS 10.0f
 
@@ -25,7 +25,7 @@ typedef enum Cue_state {
 
 struct Goals {
     Lt *lt;
-    char **ids;
+    Id *ids;
     Vec2f *positions;
     Color *colors;
     Cue_state *cue_states;
@@ -34,9 +34,9 @@ struct Goals {
     float angle;
 };
 
-Goals *create_goals_from_point_layer(const PointLayer *point_layer)
+Goals *create_goals(const Level_Points *layer)
 {
-    trace_assert(point_layer);
+    trace_assert(layer);
 
     Lt *lt = create_lt();
 
@@ -45,21 +45,15 @@ Goals *create_goals_from_point_layer(const PointLayer *point_layer)
         RETURN_LT(lt, NULL);
     }
 
-    goals->count = point_layer_count(point_layer);
+    goals->count = layer->count;
 
     goals->ids = PUSH_LT(
         lt,
-        nth_calloc(1, sizeof(char*) * goals->count),
+        nth_calloc(1, sizeof(Id) * goals->count),
         free);
     if (goals->ids == NULL) {
         RETURN_LT(lt, NULL);
     }
-    for (size_t i = 0; i < goals->count; ++i) {
-        goals->ids[i] = PUSH_LT(lt, nth_calloc(1, sizeof(char) * ENTITY_MAX_ID_SIZE), free);
-        if (goals->ids[i] == NULL) {
-            RETURN_LT(lt, NULL);
-        }
-    }
 
     goals->positions = PUSH_LT(lt, nth_calloc(1, sizeof(Vec2f) * goals->count), free);
     if (goals->positions == NULL) {
@@ -81,15 +75,15 @@ Goals *create_goals_from_point_layer(const PointLayer *point_layer)
         RETURN_LT(lt, NULL);
     }
 
-    const Vec2f *positions = point_layer_positions(point_layer);
-    const Color *colors = point_layer_colors(point_layer);
-    const char *ids = point_layer_ids(point_layer);
+    const Vec2f *positions = layer->positions;
+    const Color *colors = layer->colors;
+    const char *ids = layer->ids;
 
-    // TODO(#835): we could use memcpy in create_goals_from_point_layer
+    // TODO(#835): we could use memcpy in create_goals
     for (size_t i = 0; i < goals->count; ++i) {
         goals->positions[i] = positions[i];
         goals->colors[i] = colors[i];
-        memcpy(goals->ids[i], ids + ID_MAX_SIZE * i, ID_MAX_SIZE);
+        goals->ids[i] = id_table_intern(ids + ID_MAX_SIZE * i);
         goals->cue_states[i] = CUE_STATE_VIRGIN;
         goals->visible[i] = true;
     }
@@ -131,7 +125,7 @@ static int goals_render_core(const Goals *goals,
 
     if (camera_render_debug_text(
             camera,
-            goals->ids[goal_index],
+            id_table_cstr(goals->ids[goal_index]),
             position) < 0) {
         return -1;
     }
@@ -224,25 +218,57 @@ static int goals_is_goal_hidden(const Goals *goals, size_t i)
     return !goals->visible[i];
 }
 
-void goals_hide(Goals *goals, char goal_id[ENTITY_MAX_ID_SIZE])
+size_t goals_count(const Goals *goals)
 {
     trace_assert(goals);
-    trace_assert(goal_id);
+    return goals->count;
+}
 
-    for (size_t i = 0; i < goals->count; ++i) {
-        if (strncmp(goal_id, goals->ids[i], ENTITY_MAX_ID_SIZE) == 0) {
-            goals->visible[i] = false;
-        }
-    }
+Id goals_id(const Goals *goals, size_t goal_index)
+{
+    trace_assert(goals);
+    trace_assert(goal_index < goals->count);
+    return goals->ids[goal_index];
 }
 
-void goals_show(Goals *goals, char goal_id[ENTITY_MAX_ID_SIZE])
+void goals_hide(Goals *goals, size_t goal_index)
 {
     trace_assert(goals);
-    trace_assert(goal_id);
-    for (size_t i = 0; i < goals->count; ++i) {
-        if (strncmp(goal_id, goals->ids[i], ENTITY_MAX_ID_SIZE) == 0) {
-            goals->visible[i] = true;
-        }
-    }
+    trace_assert(goal_index < goals->count);
+    goals->visible[goal_index] = false;
+}
+
+void goals_show(Goals *goals, size_t goal_index)
+{
+    trace_assert(goals);
+    trace_assert(goal_index < goals->count);
+    goals->visible[goal_index] = true;
+}
+
+bool goals_reached(const Goals *goals, size_t goal_index,
+                   const Player *player)
+{
+    trace_assert(goals);
+    trace_assert(goal_index < goals->count);
+    trace_assert(player);
+
+    // Same bobbing as in goals_render_core
+    const Vec2f position = vec_sum(
+        goals->positions[goal_index],
+        vec(0.0f, sinf(goals->angle) * 10.0f));
+
+    return player_overlaps_rect(
+        player,
+        rect(position.x - GOAL_RADIUS, position.y - GOAL_RADIUS,
+             2.0f * GOAL_RADIUS, 2.0f * GOAL_RADIUS));
+}
+
+void goals_snapshot(Goals *goals, Snapshot *snapshot)
+{
+    trace_assert(goals);
+    trace_assert(snapshot);
+
+    SNAPSHOT_ARRAY(snapshot, goals->cue_states, goals->count);
+    SNAPSHOT_ARRAY(snapshot, goals->visible, goals->count);
+    SNAPSHOT_FIELD(snapshot, goals->angle);
 }
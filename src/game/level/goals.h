@@ -6,12 +6,14 @@
 #include "game/camera.h"
 #include "game/level/player.h"
 #include "game/sound_samples.h"
-#include "game/level/level_editor/point_layer.h"
+#include "game/level/level_data.h"
 #include "config.h"
+#include "system/id_table.h"
+#include "game/level/snapshot.h"
 
 typedef struct Goals Goals;
 
-Goals *create_goals_from_point_layer(const PointLayer *point_layer);
+Goals *create_goals(const Level_Points *layer);
 void destroy_goals(Goals *goals);
 
 Rect goals_hitbox(const Goals *goals);
@@ -27,7 +29,17 @@ void goals_checkpoint(const Goals *goals,
 void goals_cue(Goals *goals,
                const Camera *camera);
 
-void goals_hide(Goals *goals, char goal_id[ENTITY_MAX_ID_SIZE]);
-void goals_show(Goals *goals, char goal_id[ENTITY_MAX_ID_SIZE]);
+size_t goals_count(const Goals *goals);
+Id goals_id(const Goals *goals, size_t goal_index);
+
+void goals_hide(Goals *goals, size_t goal_index);
+void goals_show(Goals *goals, size_t goal_index);
+// Whether the player touches the goal right now. The hidden goals
+// count too, the regions usually hide a goal right when the player
+// comes close to it.
+bool goals_reached(const Goals *goals, size_t goal_index,
+                   const Player *player);
+
+void goals_snapshot(Goals *goals, Snapshot *snapshot);
 
 #endif  // GOALS_H_
@@ -4,12 +4,12 @@
 #include "config.h"
 #include "game/camera.h"
 #include "game/level/labels.h"
-#include "game/level/level_editor/label_layer.h"
 #include "system/log.h"
 #include "system/lt.h"
 #include "system/nth_alloc.h"
 #include "system/stacktrace.h"
 #include "system/str.h"
+#include "system/id_table.h"
 
 enum LabelState
 {
@@ -22,7 +22,7 @@ struct Labels
 {
     Lt *lt;
     size_t count;
-    char *ids;
+    Id *ids;
     Vec2f *positions;
     Color *colors;
     char **texts;
@@ -33,9 +33,9 @@ struct Labels
     enum LabelState *states;
 };
 
-Labels *create_labels_from_label_layer(const LabelLayer *label_layer)
+Labels *create_labels(const Level_Labels *layer)
 {
-    trace_assert(label_layer);
+    trace_assert(layer);
 
     Lt *lt = create_lt();
 
@@ -45,22 +45,23 @@ Labels *create_labels_from_label_layer(const LabelLayer *label_layer)
     }
     labels->lt = lt;
 
-    labels->count = label_layer_count(label_layer);
+    labels->count = layer->count;
 
-    labels->ids = PUSH_LT(lt, nth_calloc(labels->count, sizeof(char) * ENTITY_MAX_ID_SIZE), free);
+    labels->ids = PUSH_LT(lt, nth_calloc(labels->count, sizeof(Id)), free);
     if (labels->ids == NULL) {
         RETURN_LT(lt, NULL);
     }
-    memcpy(labels->ids,
-           label_layer_ids(label_layer),
-           labels->count * sizeof(char) * ENTITY_MAX_ID_SIZE);
+    const char *ids = layer->ids;
+    for (size_t i = 0; i < labels->count; ++i) {
+        labels->ids[i] = id_table_intern(ids + i * ENTITY_MAX_ID_SIZE);
+    }
 
     labels->positions = PUSH_LT(lt, nth_calloc(1, sizeof(Vec2f) * labels->count), free);
     if (labels->positions == NULL) {
         RETURN_LT(lt, NULL);
     }
     memcpy(labels->positions,
-           label_layer_positions(label_layer),
+           layer->positions,
            labels->count * sizeof(Vec2f));
 
     labels->colors = PUSH_LT(lt, nth_calloc(1, sizeof(Color) * labels->count), free);
@@ -68,7 +69,7 @@ Labels *create_labels_from_label_layer(const LabelLayer *label_layer)
         RETURN_LT(lt, NULL);
     }
     memcpy(labels->colors,
-           label_layer_colors(label_layer),
+           layer->colors,
            labels->count * sizeof(Color));
 
     labels->texts = PUSH_LT(lt, nth_calloc(1, sizeof(char*) * labels->count), free);
@@ -76,7 +77,7 @@ Labels *create_labels_from_label_layer(const LabelLayer *label_layer)
         RETURN_LT(lt, NULL);
     }
 
-    char *texts = labels_layer_texts(label_layer);
+    const char *texts = layer->texts;
     for (size_t i = 0; i < labels->count; ++i) {
         labels->texts[i] = PUSH_LT(
             labels->lt,
@@ -176,19 +177,37 @@ void labels_enter_camera_event(Labels *labels,
     }
 }
 
-void labels_hide(Labels *labels, char id[ENTITY_MAX_ID_SIZE])
+size_t labels_count(const Labels *labels)
 {
     trace_assert(labels);
-    trace_assert(id);
+    return labels->count;
+}
 
-    for (size_t i = 0; i < labels->count; ++i) {
-        if (strncmp(id, labels->ids + i * ENTITY_MAX_ID_SIZE, ENTITY_MAX_ID_SIZE) == 0) {
-            if (labels->states[i] != LABEL_STATE_HIDDEN) {
-                labels->states[i] = LABEL_STATE_HIDDEN;
-                labels->alphas[i] = 1.0f;
-                labels->delta_alphas[i] = -3.0f;
-            }
-            return;
-        }
+Id labels_id(const Labels *labels, size_t label_index)
+{
+    trace_assert(labels);
+    trace_assert(label_index < labels->count);
+    return labels->ids[label_index];
+}
+
+void labels_hide(Labels *labels, size_t label_index)
+{
+    trace_assert(labels);
+    trace_assert(label_index < labels->count);
+
+    if (labels->states[label_index] != LABEL_STATE_HIDDEN) {
+        labels->states[label_index] = LABEL_STATE_HIDDEN;
+        labels->alphas[label_index] = 1.0f;
+        labels->delta_alphas[label_index] = -3.0f;
     }
 }
+
+void labels_snapshot(Labels *labels, Snapshot *snapshot)
+{
+    trace_assert(labels);
+    trace_assert(snapshot);
+
+    SNAPSHOT_ARRAY(snapshot, labels->alphas, labels->count);
+    SNAPSHOT_ARRAY(snapshot, labels->delta_alphas, labels->count);
+    SNAPSHOT_ARRAY(snapshot, labels->states, labels->count);
+}
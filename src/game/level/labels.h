@@ -4,11 +4,15 @@
 #include "math/vec.h"
 #include "color.h"
 #include "config.h"
-#include "game/level/level_editor/label_layer.h"
+#include "system/id_table.h"
+#include "game/level/level_data.h"
+#include "game/level/snapshot.h"
+
+#define LABELS_SIZE vec(2.0f, 2.0f)
 
 typedef struct Labels Labels;
 
-Labels *create_labels_from_label_layer(const LabelLayer *label_layer);
+Labels *create_labels(const Level_Labels *layer);
 void destroy_labels(Labels *label);
 
 int labels_render(const Labels *label,
@@ -17,6 +21,11 @@ void labels_update(Labels *label,
                    float delta_time);
 void labels_enter_camera_event(Labels *label,
                                const Camera *camera);
-void labels_hide(Labels *label, char id[ENTITY_MAX_ID_SIZE]);
+size_t labels_count(const Labels *labels);
+Id labels_id(const Labels *labels, size_t label_index);
+
+void labels_hide(Labels *labels, size_t label_index);
+
+void labels_snapshot(Labels *labels, Snapshot *snapshot);
 
 #endif  // LABELS_H_
@@ -9,7 +9,6 @@
 #include "system/lt.h"
 #include "system/nth_alloc.h"
 #include "system/log.h"
-#include "game/level/level_editor/rect_layer.h"
 
 #define LAVA_BOINGNESS 2500.0f
 
@@ -19,8 +18,10 @@ struct Lava {
     Wavy_rect **rects;
 };
 
-Lava *create_lava_from_rect_layer(const RectLayer *rect_layer)
+Lava *create_lava(const Level_Rects *layer)
 {
+    trace_assert(layer);
+
     Lt *lt = create_lt();
 
     Lava *lava = PUSH_LT(lt, nth_calloc(1, sizeof(Lava)), free);
@@ -29,16 +30,14 @@ Lava *create_lava_from_rect_layer(const RectLayer *rect_layer)
     }
     lava->lt = lt;
 
-    lava->rects_count = rect_layer_count(rect_layer);
+    lava->rects_count = layer->count;
     lava->rects = PUSH_LT(lt, nth_calloc(lava->rects_count, sizeof(Wavy_rect*)), free);
     if (lava->rects == NULL) {
         RETURN_LT(lt, NULL);
     }
 
-    const Rect *rects = rect_layer_rects(rect_layer);
-    const Color *colors = rect_layer_colors(rect_layer);
     for (size_t i = 0; i < lava->rects_count; ++i) {
-        lava->rects[i] = PUSH_LT(lt, create_wavy_rect(rects[i], colors[i]), destroy_wavy_rect);
+        lava->rects[i] = PUSH_LT(lt, create_wavy_rect(layer->rects[i], layer->colors[i]), destroy_wavy_rect);
         if (lava->rects[i] == NULL) {
             RETURN_LT(lt, NULL);
         }
@@ -114,3 +113,13 @@ void lava_float_rigid_body(Lava *lava, RigidBodies *rigid_bodies, RigidBodyId id
         }
     }
 }
+
+void lava_snapshot(Lava *lava, Snapshot *snapshot)
+{
+    trace_assert(lava);
+    trace_assert(snapshot);
+
+    for (size_t i = 0; i < lava->rects_count; ++i) {
+        wavy_rect_snapshot(lava->rects[i], snapshot);
+    }
+}
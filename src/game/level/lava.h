@@ -6,11 +6,12 @@
 #include "game/camera.h"
 #include "game/level/rigid_bodies.h"
 #include "math/rect.h"
+#include "game/level/snapshot.h"
+#include "game/level/level_data.h"
 
 typedef struct Lava Lava;
-typedef struct RectLayer RectLayer;
 
-Lava *create_lava_from_rect_layer(const RectLayer *rect_layer);
+Lava *create_lava(const Level_Rects *layer);
 void destroy_lava(Lava *lava);
 
 int lava_render(const Lava *lava,
@@ -21,4 +22,6 @@ bool lava_overlaps_rect(const Lava *lava, Rect rect);
 
 void lava_float_rigid_body(Lava *lava, RigidBodies *rigid_bodies, RigidBodyId id);
 
+void lava_snapshot(Lava *lava, Snapshot *snapshot);
+
 #endif  // LAVA_H_
@@ -2,22 +2,23 @@
 #include "system/stacktrace.h"
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
 
 #include "math/pi.h"
+#include "math/rand.h"
 #include "system/log.h"
 #include "system/lt.h"
 #include "system/nth_alloc.h"
 #include "wavy_rect.h"
+#include "cvars.h"
 
-#define WAVE_PILLAR_WIDTH 10.0f
+#define WAVE_PILLAR_SEED 42
 
 struct Wavy_rect
 {
     Lt *lt;
 
     Rect rect;
-    Color color;
+    PackedColor color;
     float angle;
 };
 
@@ -31,7 +32,7 @@ Wavy_rect *create_wavy_rect(Rect rect, Color color)
     }
 
     wavy_rect->rect = rect;
-    wavy_rect->color = color;
+    wavy_rect->color = color_pack(color);
     wavy_rect->angle = 0.0f;
     wavy_rect->lt = lt;
 
@@ -50,24 +51,26 @@ int wavy_rect_render(const Wavy_rect *wavy_rect,
     trace_assert(wavy_rect);
     trace_assert(camera);
 
-    srand(42);
+    const float pillar_width = cvar_wave_pillar_width.float_value;
+
+    int32_t pillar = 0;
     for (float wave_scanner = 0;
          wave_scanner < wavy_rect->rect.w;
-         wave_scanner += WAVE_PILLAR_WIDTH) {
+         wave_scanner += pillar_width, ++pillar) {
 
-        const float s = (float) (rand() % 50) * 0.1f;
-        if (camera_fill_rect(
+        // Every pillar keeps its amplitude from frame to frame
+        const float s = (float) (hash_2d(pillar, 0, WAVE_PILLAR_SEED) % 50) * 0.1f;
+        if (camera_fill_rect_packed(
                 camera,
                 rect(
                     wavy_rect->rect.x + wave_scanner,
-                    wavy_rect->rect.y + s * sinf(wavy_rect->angle + wave_scanner / WAVE_PILLAR_WIDTH),
-                    WAVE_PILLAR_WIDTH * 1.20f,
+                    wavy_rect->rect.y + s * sinf(wavy_rect->angle + wave_scanner / pillar_width),
+                    pillar_width * 1.20f,
                     wavy_rect->rect.h),
                 wavy_rect->color) < 0) {
             return -1;
         }
     }
-    srand((unsigned int) time(NULL));
 
     return 0;
 }
@@ -85,3 +88,11 @@ Rect wavy_rect_hitbox(const Wavy_rect *wavy_rect)
 {
     return wavy_rect->rect;
 }
+
+void wavy_rect_snapshot(Wavy_rect *wavy_rect, Snapshot *snapshot)
+{
+    trace_assert(wavy_rect);
+    trace_assert(snapshot);
+
+    SNAPSHOT_FIELD(snapshot, wavy_rect->angle);
+}
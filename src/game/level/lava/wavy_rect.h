@@ -6,6 +6,7 @@
 #include "color.h"
 #include "game/camera.h"
 #include "math/rect.h"
+#include "game/level/snapshot.h"
 
 typedef struct Wavy_rect Wavy_rect;
 
@@ -19,4 +20,6 @@ int wavy_rect_update(Wavy_rect *wavy_rect,
 
 Rect wavy_rect_hitbox(const Wavy_rect *wavy_rect);
 
+void wavy_rect_snapshot(Wavy_rect *wavy_rect, Snapshot *snapshot);
+
 #endif  // WAVY_RECT_H_
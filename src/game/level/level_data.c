@@ -0,0 +1,158 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "game/level/level_data.h"
+#include "math/extrema.h"
+#include "system/log.h"
+#include "system/stacktrace.h"
+#include "system/str.h"
+
+static
+size_t chop_count(Memory *memory, String *input)
+{
+    const int n = atoi(string_to_cstr(memory, trim(chop_by_delim(input, '\n'))));
+    return n > 0 ? (size_t) n : 0;
+}
+
+static
+void copy_id(char *id, size_t id_size, String string_id)
+{
+    memset(id, 0, id_size);
+    memcpy(id, string_id.data, min_size_t(id_size - 1, string_id.count));
+}
+
+static
+void chop_level_rects(Level_Rects *result, Memory *memory, String *input)
+{
+    const size_t n = chop_count(memory, input);
+    char *ids = memory_alloc(memory, n * ENTITY_MAX_ID_SIZE);
+    Rect *rects = memory_alloc(memory, n * sizeof(Rect));
+    Color *colors = memory_alloc(memory, n * sizeof(Color));
+    Action *actions = memory_alloc(memory, n * sizeof(Action));
+
+    for (size_t i = 0; i < n; ++i) {
+        String line = trim(chop_by_delim(input, '\n'));
+        copy_id(ids + i * ENTITY_MAX_ID_SIZE, ENTITY_MAX_ID_SIZE, trim(chop_word(&line)));
+        rects[i].x = strtof(string_to_cstr(memory, trim(chop_word(&line))), NULL);
+        rects[i].y = strtof(string_to_cstr(memory, trim(chop_word(&line))), NULL);
+        rects[i].w = strtof(string_to_cstr(memory, trim(chop_word(&line))), NULL);
+        rects[i].h = strtof(string_to_cstr(memory, trim(chop_word(&line))), NULL);
+        colors[i] = hexs(trim(chop_word(&line)));
+
+        Action *action = &actions[i];
+        memset(action, 0, sizeof(*action));
+        action->type = ACTION_NONE;
+
+        String action_string = trim(chop_word(&line));
+        if (action_string.count > 0) {
+            action->type = (ActionType)atol(string_to_cstr(memory, action_string));
+            switch (action->type) {
+            case ACTION_NONE: break;
+            case ACTION_TOGGLE_GOAL:
+            case ACTION_HIDE_LABEL: {
+                String entity_id = trim(chop_word(&line));
+                trace_assert(entity_id.count > 0);
+                copy_id(action->entity_id, ENTITY_MAX_ID_SIZE, entity_id);
+
+                String activator = trim(chop_word(&line));
+                action->boxes = string_equal(activator, STRING_LIT("boxes"));
+            } break;
+
+            case ACTION_N: break;
+            }
+        }
+    }
+
+    result->count = n;
+    result->ids = ids;
+    result->rects = rects;
+    result->colors = colors;
+    result->actions = actions;
+}
+
+static
+void chop_level_points(Level_Points *result, Memory *memory, String *input)
+{
+    const size_t n = chop_count(memory, input);
+    char *ids = memory_alloc(memory, n * ID_MAX_SIZE);
+    Vec2f *positions = memory_alloc(memory, n * sizeof(Vec2f));
+    Color *colors = memory_alloc(memory, n * sizeof(Color));
+
+    for (size_t i = 0; i < n; ++i) {
+        String line = trim(chop_by_delim(input, '\n'));
+        copy_id(ids + i * ID_MAX_SIZE, ID_MAX_SIZE, trim(chop_word(&line)));
+        positions[i].x = strtof(string_to_cstr(memory, trim(chop_word(&line))), NULL);
+        positions[i].y = strtof(string_to_cstr(memory, trim(chop_word(&line))), NULL);
+        colors[i] = hexs(trim(chop_word(&line)));
+    }
+
+    result->count = n;
+    result->ids = ids;
+    result->positions = positions;
+    result->colors = colors;
+}
+
+static
+void chop_level_labels(Level_Labels *result, Memory *memory, String *input)
+{
+    const size_t n = chop_count(memory, input);
+    char *ids = memory_alloc(memory, n * LABEL_LAYER_ID_MAX_SIZE);
+    Vec2f *positions = memory_alloc(memory, n * sizeof(Vec2f));
+    Color *colors = memory_alloc(memory, n * sizeof(Color));
+    char *texts = memory_alloc(memory, n * LABEL_LAYER_TEXT_MAX_SIZE);
+
+    for (size_t i = 0; i < n; ++i) {
+        String meta = trim(chop_by_delim(input, '\n'));
+        copy_id(ids + i * LABEL_LAYER_ID_MAX_SIZE, LABEL_LAYER_ID_MAX_SIZE, trim(chop_word(&meta)));
+        positions[i].x = strtof(string_to_cstr(memory, trim(chop_word(&meta))), NULL);
+        positions[i].y = strtof(string_to_cstr(memory, trim(chop_word(&meta))), NULL);
+        colors[i] = hexs(trim(chop_word(&meta)));
+
+        // The text takes the whole next line
+        copy_id(texts + i * LABEL_LAYER_TEXT_MAX_SIZE, LABEL_LAYER_TEXT_MAX_SIZE,
+                trim(chop_by_delim(input, '\n')));
+    }
+
+    result->count = n;
+    result->ids = ids;
+    result->positions = positions;
+    result->colors = colors;
+    result->texts = texts;
+}
+
+int level_data_load(Level_Data *data, Memory *memory, String input)
+{
+    trace_assert(data);
+    trace_assert(memory);
+
+    String version = trim(chop_by_delim(&input, '\n'));
+
+    if (string_equal(version, STRING_LIT("1"))) {
+        chop_by_delim(&input, '\n');
+    } else if (string_equal(version, STRING_LIT("2"))) {
+        // Nothing
+    } else {
+        log_fail("Version `%s` is not supported. Expected version `%s`.\n",
+                 string_to_cstr(memory, version),
+                 VERSION);
+        return -1;
+    }
+
+    data->background_color = hexs(trim(chop_by_delim(&input, '\n')));
+
+    String player = chop_by_delim(&input, '\n');
+    data->player_position.x = strtof(string_to_cstr(memory, chop_word(&player)), NULL);
+    data->player_position.y = strtof(string_to_cstr(memory, chop_word(&player)), NULL);
+    data->player_color = hexs(chop_word(&player));
+
+    chop_level_rects(&data->platforms, memory, &input);
+    chop_level_points(&data->goals, memory, &input);
+    chop_level_rects(&data->lava, memory, &input);
+    chop_level_rects(&data->back_platforms, memory, &input);
+    chop_level_rects(&data->boxes, memory, &input);
+    chop_level_labels(&data->labels, memory, &input);
+    chop_level_rects(&data->regions, memory, &input);
+    chop_level_rects(&data->pp, memory, &input);
+
+    return 0;
+}
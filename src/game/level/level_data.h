@@ -0,0 +1,59 @@
+#ifndef LEVEL_DATA_H_
+#define LEVEL_DATA_H_
+
+#include "color.h"
+#include "math/rect.h"
+#include "math/vec.h"
+#include "game/level/action.h"
+#include "system/memory.h"
+#include "system/s.h"
+#include "config.h"
+
+// Everything a level file describes, without any of the level editor
+// state, so a Level can be created without the editor (see
+// create_level). The arrays belong to whoever filled them in:
+// level_data_load puts them into the Memory, the level editor points
+// them at its layers.
+
+typedef struct {
+    size_t count;
+    const char *ids;            // count * ENTITY_MAX_ID_SIZE
+    const Rect *rects;
+    const Color *colors;
+    const Action *actions;
+} Level_Rects;
+
+typedef struct {
+    size_t count;
+    const char *ids;            // count * ID_MAX_SIZE
+    const Vec2f *positions;
+    const Color *colors;
+} Level_Points;
+
+typedef struct {
+    size_t count;
+    const char *ids;            // count * LABEL_LAYER_ID_MAX_SIZE
+    const Vec2f *positions;
+    const Color *colors;
+    const char *texts;          // count * LABEL_LAYER_TEXT_MAX_SIZE
+} Level_Labels;
+
+typedef struct {
+    Color background_color;
+    Vec2f player_position;
+    Color player_color;
+    Level_Rects platforms;
+    Level_Points goals;
+    Level_Rects lava;
+    Level_Rects back_platforms;
+    Level_Rects boxes;
+    Level_Labels labels;
+    Level_Rects regions;
+    Level_Rects pp;
+} Level_Data;
+
+// Parses the contents of a level file. Returns -1 if the version of
+// the file is not supported.
+int level_data_load(Level_Data *data, Memory *memory, String input);
+
+#endif  // LEVEL_DATA_H_
@@ -32,7 +32,7 @@ static int level_editor_dump(LevelEditor *level_editor);
 
 // TODO(#994): too much duplicate code between create_level_editor and create_level_editor_from_file
 
-LevelEditor *create_level_editor(Memory *memory, Cursor *cursor)
+LevelEditor *create_level_editor(Memory *memory, Cursor *cursor, Minimap *minimap)
 {
     LevelEditor *level_editor = memory_alloc(memory, sizeof(LevelEditor));
     memset(level_editor, 0, sizeof(*level_editor));
@@ -76,49 +76,98 @@ LevelEditor *create_level_editor(Memory *memory, Cursor *cursor)
     level_editor->camera_scale = 1.0f;
     level_editor->undo_history = create_undo_history(memory);
 
+    level_editor->minimap = minimap;
+    level_editor->minimap_enabled = true;
+    minimap_reset(minimap);
+
     return level_editor;
 }
 
-LevelEditor *create_level_editor_from_file(Memory *memory, Cursor *cursor, const char *file_name)
+LevelEditor *create_level_editor_from_file(Memory *memory, Cursor *cursor, Minimap *minimap, const char *file_name)
 {
     trace_assert(memory);
     trace_assert(cursor);
+    trace_assert(minimap);
     trace_assert(file_name);
 
-    LevelEditor *level_editor = create_level_editor(memory, cursor);
+    LevelEditor *level_editor = create_level_editor(memory, cursor, minimap);
     level_editor->file_name = strdup_to_memory(memory, file_name);
 
     String input = read_whole_file(memory, file_name);
     trace_assert(input.data);
 
-    String version = trim(chop_by_delim(&input, '\n'));
-
-    if (string_equal(version, STRING_LIT("1"))) {
-        chop_by_delim(&input, '\n');
-    } else if (string_equal(version, STRING_LIT("2"))) {
-        // Nothing
-    } else {
-        log_fail("Version `%s` is not supported. Expected version `%s`.\n",
-                 string_to_cstr(memory, version),
-                 VERSION);
+    Level_Data data;
+    if (level_data_load(&data, memory, input) < 0) {
         return NULL;
     }
 
-    level_editor->background_layer = chop_background_layer(&input);
-    level_editor->player_layer = chop_player_layer(memory, &input);
-    rect_layer_load(level_editor->platforms_layer, memory, &input);
-    point_layer_load(level_editor->goals_layer, memory, &input);
-    rect_layer_load(level_editor->lava_layer, memory, &input);
-    rect_layer_load(level_editor->back_platforms_layer, memory, &input);
-    rect_layer_load(level_editor->boxes_layer, memory, &input);
-    label_layer_load(level_editor->label_layer, memory, &input);
-    rect_layer_load(level_editor->regions_layer, memory, &input);
-    rect_layer_load(level_editor->pp_layer, memory, &input);
+    level_editor->background_layer = create_background_layer(data.background_color);
+    level_editor->player_layer = create_player_layer(data.player_position, data.player_color);
+    rect_layer_load(level_editor->platforms_layer, &data.platforms);
+    point_layer_load(level_editor->goals_layer, &data.goals);
+    rect_layer_load(level_editor->lava_layer, &data.lava);
+    rect_layer_load(level_editor->back_platforms_layer, &data.back_platforms);
+    rect_layer_load(level_editor->boxes_layer, &data.boxes);
+    label_layer_load(level_editor->label_layer, &data.labels);
+    rect_layer_load(level_editor->regions_layer, &data.regions);
+    rect_layer_load(level_editor->pp_layer, &data.pp);
     undo_history_clean(level_editor->undo_history);
 
     return level_editor;
 }
 
+static
+Level_Rects level_rects_of_rect_layer(const RectLayer *layer)
+{
+    Level_Rects result = {
+        .count = rect_layer_count(layer),
+        .ids = rect_layer_ids(layer),
+        .rects = rect_layer_rects(layer),
+        .colors = rect_layer_colors(layer),
+        .actions = rect_layer_actions(layer)
+    };
+    return result;
+}
+
+static
+Level_Data level_data_of_level_editor(const LevelEditor *level_editor)
+{
+    Level_Data data = {
+        .background_color = color_picker_rgba(&level_editor->background_layer.color_picker),
+        .player_position = level_editor->player_layer.position,
+        .player_color = color_picker_rgba(&level_editor->player_layer.color_picker),
+        .platforms = level_rects_of_rect_layer(level_editor->platforms_layer),
+        .goals = {
+            .count = point_layer_count(level_editor->goals_layer),
+            .ids = point_layer_ids(level_editor->goals_layer),
+            .positions = point_layer_positions(level_editor->goals_layer),
+            .colors = point_layer_colors(level_editor->goals_layer)
+        },
+        .lava = level_rects_of_rect_layer(level_editor->lava_layer),
+        .back_platforms = level_rects_of_rect_layer(level_editor->back_platforms_layer),
+        .boxes = level_rects_of_rect_layer(level_editor->boxes_layer),
+        .labels = {
+            .count = label_layer_count(level_editor->label_layer),
+            .ids = label_layer_ids(level_editor->label_layer),
+            .positions = label_layer_positions(level_editor->label_layer),
+            .colors = label_layer_colors(level_editor->label_layer),
+            .texts = labels_layer_texts(level_editor->label_layer)
+        },
+        .regions = level_rects_of_rect_layer(level_editor->regions_layer),
+        .pp = level_rects_of_rect_layer(level_editor->pp_layer)
+    };
+
+    return data;
+}
+
+Level *create_level_from_level_editor(const LevelEditor *level_editor)
+{
+    trace_assert(level_editor);
+
+    const Level_Data data = level_data_of_level_editor(level_editor);
+    return create_level(&data);
+}
+
 int level_editor_render(const LevelEditor *level_editor,
                         const Camera *camera)
 {
@@ -155,6 +204,11 @@ int level_editor_render(const LevelEditor *level_editor,
         return -1;
     }
 
+    if (level_editor->minimap_enabled &&
+        minimap_render(level_editor->minimap, camera) < 0) {
+        return -1;
+    }
+
     if (level_editor->state == LEVEL_EDITOR_SAVEAS) {
         /* CSS */
         const Vec2f size = LEVEL_EDITOR_EDIT_FIELD_SIZE;
@@ -222,6 +276,22 @@ int level_editor_saveas_event(LevelEditor *level_editor,
     return edit_field_event(&level_editor->edit_field_filename, event);
 }
 
+// Centers the camera on the point of the level under the mouse
+static
+bool level_editor_minimap_jump(LevelEditor *level_editor,
+                               Camera *camera,
+                               Vec2f mouse_position)
+{
+    Vec2f position;
+    if (!minimap_world_position(level_editor->minimap, camera, mouse_position, &position)) {
+        return false;
+    }
+
+    level_editor->camera_position = position;
+    camera_center_at(camera, level_editor->camera_position);
+    return true;
+}
+
 static
 int level_editor_idle_event(LevelEditor *level_editor,
                             const SDL_Event *event,
@@ -254,6 +324,13 @@ int level_editor_idle_event(LevelEditor *level_editor,
                 undo_history_pop(level_editor->undo_history);
             }
         } break;
+
+        case SDLK_m: {
+            if (!SDL_IsTextInputActive()) {
+                level_editor->minimap_enabled = !level_editor->minimap_enabled;
+                level_editor->minimap_drag = false;
+            }
+        } break;
         }
     } break;
 
@@ -279,6 +356,23 @@ int level_editor_idle_event(LevelEditor *level_editor,
 
     case SDL_MOUSEBUTTONUP:
     case SDL_MOUSEBUTTONDOWN: {
+        if (event->type == SDL_MOUSEBUTTONDOWN &&
+            event->button.button == SDL_BUTTON_LEFT &&
+            level_editor->minimap_enabled &&
+            level_editor_minimap_jump(
+                level_editor, camera,
+                vec((float) event->button.x, (float) event->button.y))) {
+            level_editor->minimap_drag = true;
+            return 0;
+        }
+
+        if (event->type == SDL_MOUSEBUTTONUP &&
+            event->button.button == SDL_BUTTON_LEFT &&
+            level_editor->minimap_drag) {
+            level_editor->minimap_drag = false;
+            return 0;
+        }
+
         if (event->type == SDL_MOUSEBUTTONDOWN && event->button.button == SDL_BUTTON_MIDDLE) {
             level_editor->drag = true;
         }
@@ -289,6 +383,13 @@ int level_editor_idle_event(LevelEditor *level_editor,
     } break;
 
     case SDL_MOUSEMOTION: {
+        if (level_editor->minimap_drag) {
+            level_editor_minimap_jump(
+                level_editor, camera,
+                vec((float) event->motion.x, (float) event->motion.y));
+            return 0;
+        }
+
         if (level_editor->drag) {
             const Vec2f next_position = camera_map_screen(camera, event->motion.x, event->motion.y);
             const Vec2f prev_position = camera_map_screen(
@@ -398,8 +499,18 @@ static int level_editor_dump(LevelEditor *level_editor)
     return 0;
 }
 
-int level_editor_update(LevelEditor *level_editor, float delta_time)
+int level_editor_update(LevelEditor *level_editor, const Camera *camera, float delta_time)
 {
+    trace_assert(level_editor);
+    trace_assert(camera);
+
+    if (level_editor->minimap_enabled) {
+        const Level_Data data = level_data_of_level_editor(level_editor);
+        if (minimap_update(level_editor->minimap, camera->renderer, &data) < 0) {
+            return -1;
+        }
+    }
+
     return fading_wiggly_text_update(&level_editor->notice, delta_time);
 }
 
@@ -7,8 +7,12 @@
 #include "game/level/level_editor/rect_layer.h"
 #include "game/level/level_editor/point_layer.h"
 #include "game/level/level_editor/label_layer.h"
+#include "game/level/level_editor/player_layer.h"
+#include "game/level/level_editor/background_layer.h"
+#include "game/level/level_editor/minimap.h"
 #include "ui/wiggly_text.h"
 #include "ui/cursor.h"
+#include "game/level.h"
 
 typedef struct LevelEditor LevelEditor;
 typedef struct Sound_samples Sound_samples;
@@ -42,6 +46,11 @@ struct LevelEditor
 
     UndoHistory *undo_history;
 
+    // Owned by the game, it outlives the editors
+    Minimap *minimap;
+    bool minimap_enabled;
+    bool minimap_drag;
+
     bool drag;
     int bell;
     int click;
@@ -50,8 +59,12 @@ struct LevelEditor
     char *file_name;
 };
 
-LevelEditor *create_level_editor(Memory *memory, Cursor *cursor);
-LevelEditor *create_level_editor_from_file(Memory *memory, Cursor *cursor, const char *file_name);
+LevelEditor *create_level_editor(Memory *memory, Cursor *cursor, Minimap *minimap);
+LevelEditor *create_level_editor_from_file(Memory *memory, Cursor *cursor, Minimap *minimap, const char *file_name);
+
+// The level sees the layers through a Level_Data that points straight
+// at them, nothing is copied until the level creates its entities.
+Level *create_level_from_level_editor(const LevelEditor *level_editor);
 
 int level_editor_render(const LevelEditor *level_editor,
                         const Camera *camera);
@@ -61,7 +74,7 @@ int level_editor_event(LevelEditor *level_editor,
                        Memory *memory);
 int level_editor_focus_camera(LevelEditor *level_editor,
                               Camera *camera);
-int level_editor_update(LevelEditor *level_editor, float delta_time);
+int level_editor_update(LevelEditor *level_editor, const Camera *camera, float delta_time);
 void level_editor_sound(LevelEditor *level_editor, Sound_samples *sound_samples);
 
 #endif  // LEVEL_EDITOR_H_
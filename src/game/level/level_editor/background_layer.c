@@ -17,12 +17,6 @@ BackgroundLayer create_background_layer(Color color)
     return layer;
 }
 
-BackgroundLayer chop_background_layer(String *input)
-{
-    String line = trim(chop_by_delim(input, '\n'));
-    return create_background_layer(hexs(line));
-}
-
 int background_layer_render(BackgroundLayer *layer,
                             const Camera *camera,
                             int active)
@@ -10,7 +10,6 @@ typedef struct {
 } BackgroundLayer;
 
 BackgroundLayer create_background_layer(Color color);
-BackgroundLayer chop_background_layer(String *input);
 
 static inline
 LayerPtr background_layer_as_layer(BackgroundLayer *layer)
@@ -160,45 +160,16 @@ LabelLayer *create_label_layer(Memory *memory,
     return result;
 }
 
-void label_layer_load(LabelLayer *label_layer,
-                        Memory *memory,
-                        String *input)
+void label_layer_load(LabelLayer *label_layer, const Level_Labels *labels)
 {
     trace_assert(label_layer);
-    trace_assert(memory);
-    trace_assert(input);
+    trace_assert(labels);
 
-    int n = atoi(string_to_cstr(memory, trim(chop_by_delim(input, '\n'))));
-    char id[LABEL_LAYER_ID_MAX_SIZE];
-    char label_text[LABEL_LAYER_TEXT_MAX_SIZE];
-    for (int i = 0; i < n; ++i) {
-        String meta = trim(chop_by_delim(input, '\n'));
-
-        String string_id = trim(chop_word(&meta));
-        Vec2f position;
-        position.x = strtof(string_to_cstr(memory, trim(chop_word(&meta))), NULL);
-        position.y = strtof(string_to_cstr(memory, trim(chop_word(&meta))), NULL);
-        Color color = hexs(trim(chop_word(&meta)));
-
-        memset(id, 0, LABEL_LAYER_ID_MAX_SIZE);
-        memcpy(
-            id,
-            string_id.data,
-            min_size_t(LABEL_LAYER_ID_MAX_SIZE - 1, string_id.count));
-
-        String label_text_string =
-            trim(chop_by_delim(input, '\n'));
-        memset(label_text, 0, LABEL_LAYER_TEXT_MAX_SIZE);
-        memcpy(
-            label_text,
-            label_text_string.data,
-            min_size_t(LABEL_LAYER_TEXT_MAX_SIZE - 1,
-                       label_text_string.count));
-
-        dynarray_push(&label_layer->ids, id);
-        dynarray_push(&label_layer->positions, &position);
-        dynarray_push(&label_layer->colors, &color);
-        dynarray_push(&label_layer->texts, label_text);
+    for (size_t i = 0; i < labels->count; ++i) {
+        dynarray_push(&label_layer->ids, labels->ids + i * LABEL_LAYER_ID_MAX_SIZE);
+        dynarray_push(&label_layer->positions, &labels->positions[i]);
+        dynarray_push(&label_layer->colors, &labels->colors[i]);
+        dynarray_push(&label_layer->texts, labels->texts + i * LABEL_LAYER_TEXT_MAX_SIZE);
     }
 }
 
@@ -244,6 +215,9 @@ int label_layer_render(const LabelLayer *label_layer,
     Color *colors = (Color *)label_layer->colors.data;
     char *texts = (char *)label_layer->texts.data;
 
+    const int text_readable = camera_is_text_readable(camera, LABELS_SIZE);
+    const int id_readable = camera_is_text_readable(camera, vec(1.0f, 1.0f));
+
     /* TODO(#891): LabelLayer doesn't show the final position of Label after the animation */
     for (size_t i = 0; i < n; ++i) {
         const Color color = label_layer->state == LABEL_LAYER_RECOLOR && label_layer->selection == (int) i
@@ -263,6 +237,19 @@ int label_layer_render(const LabelLayer *label_layer,
                     position) < 0) {
                 return -1;
             }
+        } else if (!text_readable) {
+            // Too small to read, so just mark the area the text occupies
+            if (camera_fill_rect(
+                    camera,
+                    sprite_font_boundary_box(
+                        position,
+                        LABELS_SIZE,
+                        texts + i * LABEL_LAYER_TEXT_MAX_SIZE),
+                    color_scale(
+                        color,
+                        rgba(1.0f, 1.0f, 1.0f, active ? 0.5f : 0.25f))) < 0) {
+                return -1;
+            }
         } else {
             if (camera_render_text(
                     camera,
@@ -288,7 +275,7 @@ int label_layer_render(const LabelLayer *label_layer,
                             LABELS_SIZE))) < 0) {
                 return -1;
             }
-        } else {
+        } else if (id_readable) {
             if (camera_render_text(
                     camera,
                     ids + i * LABEL_LAYER_ID_MAX_SIZE,
@@ -7,10 +7,8 @@
 #include "dynarray.h"
 #include "game/level/level_editor/color_picker.h"
 #include "ui/edit_field.h"
-
-#define LABELS_SIZE vec(2.0f, 2.0f)
-#define LABEL_LAYER_ID_MAX_SIZE 36
-#define LABEL_LAYER_TEXT_MAX_SIZE 256
+#include "config.h"
+#include "game/level/labels.h"
 
 typedef enum {
     LABEL_LAYER_IDLE = 0,
@@ -41,9 +39,7 @@ LayerPtr label_layer_as_layer(LabelLayer *label_layer);
 // NOTE: create_label_layer and create_label_layer_from_line_stream do
 // not own id_name_prefix
 LabelLayer *create_label_layer(Memory *memory, const char *id_name_prefix);
-void label_layer_load(LabelLayer *label_layer,
-                        Memory *memory,
-                        String *input);
+void label_layer_load(LabelLayer *label_layer, const Level_Labels *labels);
 
 static inline
 void destroy_label_layer(LabelLayer label_layer)
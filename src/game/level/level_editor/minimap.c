@@ -0,0 +1,283 @@
+#include <SDL.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "./minimap.h"
+#include "color.h"
+#include "game/level/level_raster.h"
+#include "math/rect.h"
+#include "system/log.h"
+#include "system/lt.h"
+#include "system/nth_alloc.h"
+#include "system/stacktrace.h"
+
+#define MINIMAP_MARGIN 20.0f
+#define MINIMAP_FRAME_COLOR rgba(0.0f, 0.0f, 0.0f, 1.0f)
+#define MINIMAP_VIEWPORT_COLOR rgba(1.0f, 1.0f, 1.0f, 1.0f)
+
+struct Minimap
+{
+    Lt *lt;
+
+    Level_Raster raster;
+    SDL_Texture *texture;
+
+    // The level as it is in the raster right now. The rest is
+    // meaningless until valid.
+    bool valid;
+    Color background;
+    Rect bounds;
+    Level_Raster_Rect *rects;
+    size_t rects_count;
+
+    // The level of the update in progress, it becomes the rects above
+    Level_Raster_Rect *next_rects;
+    size_t rects_capacity;
+};
+
+Minimap *create_minimap(void)
+{
+    Lt *lt = create_lt();
+
+    Minimap *minimap = PUSH_LT(lt, nth_calloc(1, sizeof(Minimap)), free);
+    if (minimap == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+    minimap->lt = lt;
+
+    minimap->raster.pixels = PUSH_LT(
+        lt,
+        nth_calloc(MINIMAP_WIDTH * MINIMAP_HEIGHT, sizeof(uint32_t)),
+        free);
+    if (minimap->raster.pixels == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+    minimap->raster.width = MINIMAP_WIDTH;
+    minimap->raster.height = MINIMAP_HEIGHT;
+
+    return minimap;
+}
+
+void destroy_minimap(Minimap *minimap)
+{
+    trace_assert(minimap);
+    if (minimap->texture != NULL) {
+        SDL_DestroyTexture(minimap->texture);
+    }
+    free(minimap->rects);
+    free(minimap->next_rects);
+    RETURN_LT0(minimap->lt);
+}
+
+void minimap_reset(Minimap *minimap)
+{
+    trace_assert(minimap);
+    minimap->valid = false;
+}
+
+static
+Rect minimap_screen_rect(const Camera *camera)
+{
+    const Rect view_port = camera_view_port_screen(camera);
+    return rect(
+        view_port.w - MINIMAP_WIDTH - MINIMAP_MARGIN,
+        view_port.h - MINIMAP_HEIGHT - MINIMAP_MARGIN,
+        MINIMAP_WIDTH,
+        MINIMAP_HEIGHT);
+}
+
+static
+int minimap_reserve(Minimap *minimap, size_t count)
+{
+    if (count <= minimap->rects_capacity) {
+        return 0;
+    }
+
+    size_t capacity = minimap->rects_capacity > 0 ? minimap->rects_capacity : 256;
+    while (capacity < count) {
+        capacity *= 2;
+    }
+
+    Level_Raster_Rect *rects = realloc(minimap->rects, capacity * sizeof(Level_Raster_Rect));
+    if (rects == NULL) {
+        log_fail("Could not allocate the minimap rects\n");
+        return -1;
+    }
+    minimap->rects = rects;
+
+    Level_Raster_Rect *next_rects = realloc(minimap->next_rects, capacity * sizeof(Level_Raster_Rect));
+    if (next_rects == NULL) {
+        log_fail("Could not allocate the minimap rects\n");
+        return -1;
+    }
+    minimap->next_rects = next_rects;
+
+    minimap->rects_capacity = capacity;
+
+    return 0;
+}
+
+int minimap_update(Minimap *minimap,
+                   SDL_Renderer *renderer,
+                   const Level_Data *data)
+{
+    trace_assert(minimap);
+    trace_assert(renderer);
+    trace_assert(data);
+
+    if (minimap->texture == NULL) {
+        minimap->texture = SDL_CreateTexture(
+            renderer,
+            SDL_PIXELFORMAT_ARGB8888,
+            SDL_TEXTUREACCESS_STATIC,
+            MINIMAP_WIDTH,
+            MINIMAP_HEIGHT);
+        if (minimap->texture == NULL) {
+            log_fail("SDL_CreateTexture: %s\n", SDL_GetError());
+            return -1;
+        }
+        minimap->valid = false;
+    }
+
+    // The regions are only visible in the editor, but they are still
+    // a part of the level
+    if (minimap_reserve(minimap, level_raster_rects_count(data, true)) < 0) {
+        return -1;
+    }
+
+    Level_Raster_Rect *next_rects = minimap->next_rects;
+    const size_t next_count = level_raster_push_level(next_rects, data, true);
+
+    // There is always the player
+    const Rect bounds = level_raster_bounds(next_rects, next_count);
+
+    const bool full =
+        !minimap->valid ||
+        memcmp(&bounds, &minimap->bounds, sizeof(bounds)) != 0 ||
+        memcmp(&data->background_color, &minimap->background, sizeof(Color)) != 0;
+
+    // The union of the old and the new places of everything that
+    // changed
+    bool changed = false;
+    Rect dirty = {0};
+    if (!full) {
+        const size_t n = next_count > minimap->rects_count ? next_count : minimap->rects_count;
+        for (size_t i = 0; i < n; ++i) {
+            if (i < next_count && i < minimap->rects_count &&
+                memcmp(&next_rects[i], &minimap->rects[i], sizeof(Level_Raster_Rect)) == 0) {
+                continue;
+            }
+
+            if (i < minimap->rects_count) {
+                dirty = changed ? rect_boundary2(dirty, minimap->rects[i].rect) : minimap->rects[i].rect;
+                changed = true;
+            }
+
+            if (i < next_count) {
+                dirty = changed ? rect_boundary2(dirty, next_rects[i].rect) : next_rects[i].rect;
+                changed = true;
+            }
+        }
+    }
+
+    minimap->next_rects = minimap->rects;
+    minimap->rects = next_rects;
+    minimap->rects_count = next_count;
+
+    SDL_Rect area = {0, 0, MINIMAP_WIDTH, MINIMAP_HEIGHT};
+    if (full) {
+        minimap->valid = true;
+        minimap->background = data->background_color;
+        minimap->bounds = bounds;
+        level_raster_fit(&minimap->raster, bounds);
+    } else if (changed) {
+        // A pixel more, for the rects that were rounded up to a pixel
+        SDL_Rect dirty_area = level_raster_pixel_rect(&minimap->raster, dirty);
+        dirty_area.w += 1;
+        dirty_area.h += 1;
+        area = level_raster_clip(&minimap->raster, dirty_area);
+    } else {
+        return 0;
+    }
+
+    if (area.w <= 0 || area.h <= 0) {
+        return 0;
+    }
+
+    level_raster_draw(
+        &minimap->raster,
+        minimap->background,
+        minimap->rects,
+        minimap->rects_count,
+        &area);
+
+    if (SDL_UpdateTexture(
+            minimap->texture,
+            &area,
+            minimap->raster.pixels + area.y * MINIMAP_WIDTH + area.x,
+            MINIMAP_WIDTH * (int) sizeof(uint32_t)) < 0) {
+        log_fail("SDL_UpdateTexture: %s\n", SDL_GetError());
+        return -1;
+    }
+
+    return 0;
+}
+
+int minimap_render(const Minimap *minimap,
+                   const Camera *camera)
+{
+    trace_assert(minimap);
+    trace_assert(camera);
+
+    if (!minimap->valid) {
+        return 0;
+    }
+
+    const Rect screen_rect = minimap_screen_rect(camera);
+    const SDL_Rect dest = rect_for_sdl(screen_rect);
+    if (SDL_RenderCopy(camera->renderer, minimap->texture, NULL, &dest) < 0) {
+        log_fail("SDL_RenderCopy: %s\n", SDL_GetError());
+        return -1;
+    }
+
+    if (camera_draw_rect_screen(camera, screen_rect, MINIMAP_FRAME_COLOR) < 0) {
+        return -1;
+    }
+
+    const Rect world_view_port = camera_view_port(camera);
+    const Rect view_port = rects_overlap_area(
+        rect(screen_rect.x + world_view_port.x * minimap->raster.scale + minimap->raster.offset.x,
+             screen_rect.y + world_view_port.y * minimap->raster.scale + minimap->raster.offset.y,
+             world_view_port.w * minimap->raster.scale,
+             world_view_port.h * minimap->raster.scale),
+        screen_rect);
+    if (view_port.w > 0.0f && view_port.h > 0.0f) {
+        if (camera_draw_rect_screen(camera, view_port, MINIMAP_VIEWPORT_COLOR) < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+bool minimap_world_position(const Minimap *minimap,
+                            const Camera *camera,
+                            Vec2f screen_position,
+                            Vec2f *world_position)
+{
+    trace_assert(minimap);
+    trace_assert(camera);
+    trace_assert(world_position);
+
+    const Rect screen_rect = minimap_screen_rect(camera);
+    if (!minimap->valid || !rect_contains_point(screen_rect, screen_position)) {
+        return false;
+    }
+
+    *world_position = vec(
+        (screen_position.x - screen_rect.x - minimap->raster.offset.x) / minimap->raster.scale,
+        (screen_position.y - screen_rect.y - minimap->raster.offset.y) / minimap->raster.scale);
+
+    return true;
+}
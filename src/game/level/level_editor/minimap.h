@@ -0,0 +1,43 @@
+#ifndef MINIMAP_H_
+#define MINIMAP_H_
+
+#include <stdbool.h>
+
+#include "game/camera.h"
+#include "game/level/level_data.h"
+
+#define MINIMAP_WIDTH 256
+#define MINIMAP_HEIGHT 144
+
+// The whole level at a glance in the corner of the level editor. The
+// level is rasterized into a small texture, so rendering the minimap
+// is a single textured quad no matter how big the level is.
+//
+// Every update compares the level against the one rasterized last
+// time and only the pixels under the rects that changed are
+// rasterized and uploaded again. Everything is redrawn only when the
+// bounds of the level or the background change.
+typedef struct Minimap Minimap;
+
+Minimap *create_minimap(void);
+void destroy_minimap(Minimap *minimap);
+
+// Forgets the rasterized level, for when a different level is opened
+void minimap_reset(Minimap *minimap);
+
+int minimap_update(Minimap *minimap,
+                   SDL_Renderer *renderer,
+                   const Level_Data *data);
+
+// Outlines the part of the level the camera is looking at
+int minimap_render(const Minimap *minimap,
+                   const Camera *camera);
+
+// Maps a point on the screen to the level. False if the point is not
+// on the minimap.
+bool minimap_world_position(const Minimap *minimap,
+                            const Camera *camera,
+                            Vec2f screen_position,
+                            Vec2f *world_position);
+
+#endif  // MINIMAP_H_
@@ -13,7 +13,6 @@ typedef struct {
 } PlayerLayer;
 
 PlayerLayer create_player_layer(Vec2f position, Color color);
-PlayerLayer chop_player_layer(Memory *memory, String *input);
 
 LayerPtr player_layer_as_layer(PlayerLayer *player_layer);
 int player_layer_render(const PlayerLayer *player_layer,
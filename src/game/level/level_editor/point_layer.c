@@ -18,6 +18,9 @@
 #define POINT_LAYER_ELEMENT_RADIUS 10.0f
 #define POINT_LAYER_ID_TEXT_SIZE vec(2.0f, 2.0f)
 #define POINT_LAYER_ID_TEXT_COLOR COLOR_BLACK
+// Points whose radius on the screen is smaller than that are drawn as
+// a single pixel
+#define POINT_LAYER_LOD_MIN_RADIUS 2.0f
 
 static int point_clipboard = 0;
 static Color point_clipboard_color;
@@ -157,30 +160,15 @@ PointLayer *create_point_layer(Memory *memory,
     return result;
 }
 
-void point_layer_load(PointLayer *point_layer,
-                      Memory *memory,
-                      String *input)
+void point_layer_load(PointLayer *point_layer, const Level_Points *points)
 {
     trace_assert(point_layer);
-    trace_assert(memory);
-    trace_assert(input);
+    trace_assert(points);
 
-    int n = atoi(string_to_cstr(memory, trim(chop_by_delim(input, '\n'))));
-    char id[ENTITY_MAX_ID_SIZE];
-    for (int i = 0; i < n; ++i) {
-        String line = trim(chop_by_delim(input, '\n'));
-        String string_id = trim(chop_word(&line));
-        Vec2f point;
-        point.x = strtof(string_to_cstr(memory, trim(chop_word(&line))), NULL);
-        point.y = strtof(string_to_cstr(memory, trim(chop_word(&line))), NULL);
-        Color color = hexs(trim(chop_word(&line)));
-
-        memset(id, 0, ENTITY_MAX_ID_SIZE);
-        memcpy(id, string_id.data, min_size_t(ENTITY_MAX_ID_SIZE - 1, string_id.count));
-
-        dynarray_push(&point_layer->positions, &point);
-        dynarray_push(&point_layer->colors, &color);
-        dynarray_push(&point_layer->ids, id);
+    for (size_t i = 0; i < points->count; ++i) {
+        dynarray_push(&point_layer->positions, &points->positions[i]);
+        dynarray_push(&point_layer->colors, &points->colors[i]);
+        dynarray_push(&point_layer->ids, points->ids + i * ID_MAX_SIZE);
     }
 }
 
@@ -206,6 +194,11 @@ int point_layer_render(const PointLayer *point_layer,
     Color *colors = (Color *)point_layer->colors.data;
     char *ids = (char *)point_layer->ids.data;
 
+    const int collapsed = camera_screen_size(
+        camera,
+        vec(POINT_LAYER_ELEMENT_RADIUS, POINT_LAYER_ELEMENT_RADIUS)).x < POINT_LAYER_LOD_MIN_RADIUS;
+    const int id_readable = camera_is_text_readable(camera, POINT_LAYER_ID_TEXT_SIZE);
+
     for (int i = 0; i < n; ++i) {
         const Color color = color_scale(
             point_layer->state == POINT_LAYER_RECOLOR && i == point_layer->selection
@@ -218,6 +211,18 @@ int point_layer_render(const PointLayer *point_layer,
             ? point_layer->inter_position
             : positions[i];
 
+        // Collapsed Point
+        if (collapsed && !(active && i == point_layer->selection)) {
+            if (camera_is_point_visible(camera, position) &&
+                camera_draw_point_screen(
+                    camera,
+                    camera_point(camera, position),
+                    color) < 0) {
+                return -1;
+            }
+            continue;
+        }
+
         // Selection Layer
         if (active && i == point_layer->selection) {
             if (camera_fill_triangle(
@@ -230,6 +235,7 @@ int point_layer_render(const PointLayer *point_layer,
             }
 
             if (point_layer->state != POINT_LAYER_EDIT_ID &&
+                id_readable &&
                 camera_render_text(
                     camera,
                     ids + ID_MAX_SIZE * i,
@@ -7,8 +7,8 @@
 #include "dynarray.h"
 #include "game/level/level_editor/color_picker.h"
 #include "ui/edit_field.h"
-
-#define ID_MAX_SIZE 36
+#include "config.h"
+#include "game/level/level_data.h"
 
 typedef enum {
     POINT_LAYER_IDLE = 0,
@@ -38,9 +38,7 @@ LayerPtr point_layer_as_layer(PointLayer *point_layer);
 // NOTE: create_point_layer and create_point_layer_from_line_stream do
 // not own id_name_prefix
 PointLayer *create_point_layer(Memory *memory, const char *id_name_prefix);
-void point_layer_load(PointLayer *point_layer,
-                        Memory *memory,
-                        String *input);
+void point_layer_load(PointLayer *point_layer, const Level_Points *points);
 
 static inline
 void destroy_point_layer(PointLayer point_layer)
@@ -18,6 +18,7 @@
 #define RECT_LAYER_SELECTION_THICCNESS 15.0f
 #define RECT_LAYER_ID_LABEL_SIZE vec(3.0f, 3.0f)
 #define CREATE_AREA_THRESHOLD 10.0
+#define RECT_LAYER_LOD_GRID_SIZE 256
 
 static int rect_clipboard = 0;
 static Rect rect_clipboard_rect;
@@ -1019,61 +1020,16 @@ RectLayer *create_rect_layer(Memory *memory,
     return rect_layer;
 }
 
-void rect_layer_load(RectLayer *layer, Memory *memory, String *input)
+void rect_layer_load(RectLayer *layer, const Level_Rects *rects)
 {
     trace_assert(layer);
-    trace_assert(memory);
-    trace_assert(input);
-
-    int n = atoi(string_to_cstr(memory, trim(chop_by_delim(input, '\n'))));
-    char id[ENTITY_MAX_ID_SIZE];
-    for (int i = 0; i < n; ++i) {
-        Rect rect;
-        String line = trim(chop_by_delim(input, '\n'));
-        String string_id = trim(chop_word(&line));
-        rect.x = strtof(string_to_cstr(memory, trim(chop_word(&line))), NULL);
-        rect.y = strtof(string_to_cstr(memory, trim(chop_word(&line))), NULL);
-        rect.w = strtof(string_to_cstr(memory, trim(chop_word(&line))), NULL);
-        rect.h = strtof(string_to_cstr(memory, trim(chop_word(&line))), NULL);
-        Color color = hexs(trim(chop_word(&line)));
-
-        memset(id, 0, ENTITY_MAX_ID_SIZE);
-        memcpy(
-            id,
-            string_id.data,
-            min_size_t(ENTITY_MAX_ID_SIZE - 1, string_id.count));
-
-        dynarray_push(&layer->rects, &rect);
-        dynarray_push(&layer->colors, &color);
-        dynarray_push(&layer->ids, id);
-
-        Action action = {
-            .type = ACTION_NONE,
-            .entity_id = {0}
-        };
-
-        String action_string = trim(chop_word(&line));
-        if (action_string.count > 0) {
-            action.type = (ActionType)atol(string_to_cstr(memory, action_string));
-            switch (action.type) {
-            case ACTION_NONE: break;
-            case ACTION_TOGGLE_GOAL:
-            case ACTION_HIDE_LABEL: {
-                String label_id = trim(chop_word(&line));
-                trace_assert(label_id.count > 0);
-                memset(action.entity_id, 0, ENTITY_MAX_ID_SIZE);
-                memcpy(action.entity_id,
-                       label_id.data,
-                       min_size_t(
-                           ENTITY_MAX_ID_SIZE - 1,
-                           label_id.count));
-            } break;
-
-            case ACTION_N: break;
-            }
-        }
+    trace_assert(rects);
 
-        dynarray_push(&layer->actions, &action);
+    for (size_t i = 0; i < rects->count; ++i) {
+        dynarray_push(&layer->rects, &rects->rects[i]);
+        dynarray_push(&layer->colors, &rects->colors[i]);
+        dynarray_push(&layer->ids, rects->ids + i * ENTITY_MAX_ID_SIZE);
+        dynarray_push(&layer->actions, &rects->actions[i]);
     }
 }
 
@@ -1101,6 +1057,64 @@ void render_tool_bar_button(const Camera *camera,
 }
 
 
+// Rectangles that are smaller than a cell of the LOD grid laid over
+// the screen are collapsed into that cell. Each cell is filled at most
+// once per frame with the color of the first rectangle that hit it,
+// so far zoomed out levels cost at most one draw call per cell.
+typedef struct {
+    Rect viewport;
+    Vec2f cell_size;
+    uint8_t filled[RECT_LAYER_LOD_GRID_SIZE * RECT_LAYER_LOD_GRID_SIZE / 8];
+} LodGrid;
+
+static
+LodGrid create_lod_grid(Rect viewport)
+{
+    LodGrid lod_grid;
+    lod_grid.viewport = viewport;
+    lod_grid.cell_size = vec(
+        fmaxf(1.0f, viewport.w / RECT_LAYER_LOD_GRID_SIZE),
+        fmaxf(1.0f, viewport.h / RECT_LAYER_LOD_GRID_SIZE));
+    memset(lod_grid.filled, 0, sizeof(lod_grid.filled));
+    return lod_grid;
+}
+
+static
+int lod_grid_fill_rect(LodGrid *lod_grid,
+                       const Camera *camera,
+                       Rect screen_rect,
+                       Color color)
+{
+    trace_assert(lod_grid);
+    trace_assert(camera);
+
+    const Vec2f center = vec_sub(
+        rect_center(screen_rect),
+        rect_position(lod_grid->viewport));
+    const int x = (int) floorf(center.x / lod_grid->cell_size.x);
+    const int y = (int) floorf(center.y / lod_grid->cell_size.y);
+
+    if (x < 0 || x >= RECT_LAYER_LOD_GRID_SIZE ||
+        y < 0 || y >= RECT_LAYER_LOD_GRID_SIZE) {
+        return 0;
+    }
+
+    const size_t cell = (size_t) (y * RECT_LAYER_LOD_GRID_SIZE + x);
+    const uint8_t mask = (uint8_t) (1 << (cell % 8));
+    if (lod_grid->filled[cell / 8] & mask) {
+        return 0;
+    }
+    lod_grid->filled[cell / 8] |= mask;
+
+    return camera_fill_rect_screen(
+        camera,
+        rect(lod_grid->viewport.x + (float) x * lod_grid->cell_size.x,
+             lod_grid->viewport.y + (float) y * lod_grid->cell_size.y,
+             lod_grid->cell_size.x,
+             lod_grid->cell_size.y),
+        color);
+}
+
 int rect_layer_render(const RectLayer *layer, const Camera *camera, int active)
 {
     trace_assert(layer);
@@ -1111,6 +1125,8 @@ int rect_layer_render(const RectLayer *layer, const Camera *camera, int active)
     Color *colors = (Color *)layer->colors.data;
     const char *ids = (const char *)layer->ids.data;
 
+    LodGrid lod_grid = create_lod_grid(camera_view_port_screen(camera));
+
     // The Rectangles
     for (size_t i = 0; i < n; ++i) {
         Rect rect = rects[i];
@@ -1126,13 +1142,26 @@ int rect_layer_render(const RectLayer *layer, const Camera *camera, int active)
             }
         }
 
+        const Rect screen_rect = camera_rect(camera, rect);
+        if (!rects_overlap(screen_rect, lod_grid.viewport)) {
+            continue;
+        }
+
+        color = color_scale(
+            color,
+            rgba(1.0f, 1.0f, 1.0f, active ? 1.0f : 0.5f));
+
+        // Collapsed Rectangle
+        if (screen_rect.w < lod_grid.cell_size.x &&
+            screen_rect.h < lod_grid.cell_size.y) {
+            if (lod_grid_fill_rect(&lod_grid, camera, screen_rect, color) < 0) {
+                return -1;
+            }
+            continue;
+        }
+
         // Main Rectangle
-        if (camera_fill_rect(
-                camera,
-                rect,
-                color_scale(
-                    color,
-                    rgba(1.0f, 1.0f, 1.0f, active ? 1.0f : 0.5f))) < 0) {
+        if (camera_fill_rect_screen(camera, screen_rect, color) < 0) {
             return -1;
         }
     }
@@ -1180,7 +1209,7 @@ int rect_layer_render(const RectLayer *layer, const Camera *camera, int active)
                     rect_id_pos) < 0) {
                 return -1;
             }
-        } else {
+        } else if (camera_is_text_readable(camera, RECT_LAYER_ID_LABEL_SIZE)) {
             // Id text
             if (camera_render_text(
                     camera,
@@ -1343,6 +1372,9 @@ int rect_layer_dump_stream(const RectLayer *layer, FILE *filedump)
             fprintf(filedump, " %d %.*s",
                     (int)actions[i].type,
                     ENTITY_MAX_ID_SIZE, actions[i].entity_id);
+            if (actions[i].boxes) {
+                fprintf(filedump, " boxes");
+            }
         } break;
         case ACTION_N: break;
         }
@@ -3,6 +3,7 @@
 
 #include "layer.h"
 #include "game/level/action.h"
+#include "game/level/level_data.h"
 #include "ui/cursor.h"
 #include "dynarray.h"
 #include "color_picker.h"
@@ -51,7 +52,7 @@ LayerPtr rect_layer_as_layer(RectLayer *layer);
 RectLayer *create_rect_layer(Memory *memory,
                              const char *id_name_prefix,
                              Cursor *cursor);
-void rect_layer_load(RectLayer *rect_layer, Memory *memory, String *input);
+void rect_layer_load(RectLayer *rect_layer, const Level_Rects *rects);
 
 static inline
 void destroy_rect_layer(RectLayer layer)
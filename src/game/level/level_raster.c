@@ -0,0 +1,186 @@
+#include <math.h>
+
+#include "./level_raster.h"
+#include "system/stacktrace.h"
+
+// Empty pixels around the level
+#define LEVEL_RASTER_PADDING 4.0f
+// The player and the goals are points in the level
+#define LEVEL_RASTER_PLAYER_SIZE 25.0f
+#define LEVEL_RASTER_GOAL_SIZE 20.0f
+
+size_t level_raster_rects_count(const Level_Data *data, bool regions)
+{
+    trace_assert(data);
+    return data->back_platforms.count + data->pp.count + 1 + data->boxes.count +
+        data->lava.count + data->platforms.count + data->goals.count +
+        (regions ? data->regions.count : 0);
+}
+
+static
+size_t level_raster_push_rects(Level_Raster_Rect *rects, const Level_Rects *level_rects)
+{
+    for (size_t i = 0; i < level_rects->count; ++i) {
+        rects[i].rect = level_rects->rects[i];
+        rects[i].color = level_rects->colors[i];
+    }
+    return level_rects->count;
+}
+
+static
+size_t level_raster_push_point(Level_Raster_Rect *rects, Vec2f position, float size, Color color)
+{
+    rects[0].rect = rect(
+        position.x - size * 0.5f, position.y - size * 0.5f, size, size);
+    rects[0].color = color;
+    return 1;
+}
+
+size_t level_raster_push_level(Level_Raster_Rect *rects,
+                               const Level_Data *data,
+                               bool regions)
+{
+    trace_assert(rects);
+    trace_assert(data);
+
+    size_t count = 0;
+    count += level_raster_push_rects(rects + count, &data->back_platforms);
+    count += level_raster_push_rects(rects + count, &data->pp);
+    count += level_raster_push_point(
+        rects + count,
+        vec(data->player_position.x + LEVEL_RASTER_PLAYER_SIZE * 0.5f,
+            data->player_position.y + LEVEL_RASTER_PLAYER_SIZE * 0.5f),
+        LEVEL_RASTER_PLAYER_SIZE,
+        data->player_color);
+    count += level_raster_push_rects(rects + count, &data->boxes);
+    count += level_raster_push_rects(rects + count, &data->lava);
+    count += level_raster_push_rects(rects + count, &data->platforms);
+    for (size_t i = 0; i < data->goals.count; ++i) {
+        count += level_raster_push_point(
+            rects + count,
+            data->goals.positions[i],
+            LEVEL_RASTER_GOAL_SIZE,
+            data->goals.colors[i]);
+    }
+    if (regions) {
+        count += level_raster_push_rects(rects + count, &data->regions);
+    }
+
+    trace_assert(count == level_raster_rects_count(data, regions));
+    return count;
+}
+
+Rect level_raster_bounds(const Level_Raster_Rect *rects, size_t count)
+{
+    trace_assert(rects);
+    trace_assert(count > 0);
+
+    Rect bounds = rects[0].rect;
+    for (size_t i = 1; i < count; ++i) {
+        bounds = rect_boundary2(bounds, rects[i].rect);
+    }
+    return bounds;
+}
+
+void level_raster_fit(Level_Raster *raster, Rect bounds)
+{
+    trace_assert(raster);
+
+    const float width = (float) raster->width;
+    const float height = (float) raster->height;
+
+    raster->scale = fminf(
+        (width - 2.0f * LEVEL_RASTER_PADDING) / fmaxf(bounds.w, 1.0f),
+        (height - 2.0f * LEVEL_RASTER_PADDING) / fmaxf(bounds.h, 1.0f));
+    raster->offset = vec(
+        (width - bounds.w * raster->scale) * 0.5f - bounds.x * raster->scale,
+        (height - bounds.h * raster->scale) * 0.5f - bounds.y * raster->scale);
+}
+
+SDL_Rect level_raster_pixel_rect(const Level_Raster *raster, Rect r)
+{
+    trace_assert(raster);
+
+    const int x0 = (int) floorf(r.x * raster->scale + raster->offset.x);
+    const int y0 = (int) floorf(r.y * raster->scale + raster->offset.y);
+    const int x1 = (int) fmaxf(ceilf((r.x + r.w) * raster->scale + raster->offset.x), (float) x0 + 1.0f);
+    const int y1 = (int) fmaxf(ceilf((r.y + r.h) * raster->scale + raster->offset.y), (float) y0 + 1.0f);
+
+    SDL_Rect result = {x0, y0, x1 - x0, y1 - y0};
+    return result;
+}
+
+SDL_Rect level_raster_clip(const Level_Raster *raster, SDL_Rect area)
+{
+    trace_assert(raster);
+
+    const int x0 = area.x > 0 ? area.x : 0;
+    const int y0 = area.y > 0 ? area.y : 0;
+    const int x1 = area.x + area.w < raster->width ? area.x + area.w : raster->width;
+    const int y1 = area.y + area.h < raster->height ? area.y + area.h : raster->height;
+
+    SDL_Rect result = {x0, y0, x1 > x0 ? x1 - x0 : 0, y1 > y0 ? y1 - y0 : 0};
+    return result;
+}
+
+static
+SDL_Rect level_raster_overlap(SDL_Rect a, SDL_Rect b)
+{
+    const int x0 = a.x > b.x ? a.x : b.x;
+    const int y0 = a.y > b.y ? a.y : b.y;
+    const int x1 = a.x + a.w < b.x + b.w ? a.x + a.w : b.x + b.w;
+    const int y1 = a.y + a.h < b.y + b.h ? a.y + a.h : b.y + b.h;
+
+    SDL_Rect result = {x0, y0, x1 > x0 ? x1 - x0 : 0, y1 > y0 ? y1 - y0 : 0};
+    return result;
+}
+
+static
+uint32_t level_raster_pack_pixel(float r, float g, float b)
+{
+    return 0xff000000u
+        | (uint32_t) (fminf(fmaxf(r, 0.0f), 1.0f) * 255.0f) << 16
+        | (uint32_t) (fminf(fmaxf(g, 0.0f), 1.0f) * 255.0f) << 8
+        | (uint32_t) (fminf(fmaxf(b, 0.0f), 1.0f) * 255.0f);
+}
+
+void level_raster_draw(const Level_Raster *raster,
+                       Color background,
+                       const Level_Raster_Rect *rects,
+                       size_t count,
+                       const SDL_Rect *area)
+{
+    trace_assert(raster);
+    trace_assert(count == 0 || rects);
+
+    SDL_Rect whole = {0, 0, raster->width, raster->height};
+    const SDL_Rect clip = area != NULL ? level_raster_clip(raster, *area) : whole;
+
+    const uint32_t background_pixel = level_raster_pack_pixel(
+        background.r, background.g, background.b);
+    for (int y = clip.y; y < clip.y + clip.h; ++y) {
+        for (int x = clip.x; x < clip.x + clip.w; ++x) {
+            raster->pixels[y * raster->width + x] = background_pixel;
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        const Color c = rects[i].color;
+        const SDL_Rect r = level_raster_overlap(
+            level_raster_pixel_rect(raster, rects[i].rect),
+            clip);
+
+        for (int y = r.y; y < r.y + r.h; ++y) {
+            for (int x = r.x; x < r.x + r.w; ++x) {
+                uint32_t *pixel = &raster->pixels[y * raster->width + x];
+                const float dr = (float) ((*pixel >> 16) & 0xff) / 255.0f;
+                const float dg = (float) ((*pixel >> 8) & 0xff) / 255.0f;
+                const float db = (float) (*pixel & 0xff) / 255.0f;
+                *pixel = level_raster_pack_pixel(
+                    c.r * c.a + dr * (1.0f - c.a),
+                    c.g * c.a + dg * (1.0f - c.a),
+                    c.b * c.a + db * (1.0f - c.a));
+            }
+        }
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef LEVEL_RASTER_H_
+#define LEVEL_RASTER_H_
+
+#include <SDL.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "color.h"
+#include "game/level/level_data.h"
+#include "math/rect.h"
+#include "math/vec.h"
+
+// A flat picture of a level on the CPU, for the level thumbnails and
+// the minimap of the level editor. The level is turned into a list of
+// colored rects which are blended on top of the background color.
+
+typedef struct {
+    Rect rect;
+    Color color;
+} Level_Raster_Rect;
+
+typedef struct {
+    // SDL_PIXELFORMAT_ARGB8888, width * height
+    uint32_t *pixels;
+    int width;
+    int height;
+
+    // From the level to the pixels
+    float scale;
+    Vec2f offset;
+} Level_Raster;
+
+// How many rects level_raster_push_level pushes
+size_t level_raster_rects_count(const Level_Data *data, bool regions);
+
+// Same order as level_render. The regions are not visible when the
+// game is played, so they are only pushed (on top of everything) if
+// asked for. Returns the amount of the pushed rects.
+size_t level_raster_push_level(Level_Raster_Rect *rects,
+                               const Level_Data *data,
+                               bool regions);
+
+// count must be positive
+Rect level_raster_bounds(const Level_Raster_Rect *rects, size_t count);
+
+// Sets the scale and the offset, so bounds fill the pixels with a few
+// empty pixels around
+void level_raster_fit(Level_Raster *raster, Rect bounds);
+
+// The pixels the rect covers, could be outside of the raster.
+// Everything is at least a pixel big, otherwise the thin platforms
+// would disappear.
+SDL_Rect level_raster_pixel_rect(const Level_Raster *raster, Rect r);
+
+// The part of area inside of the raster
+SDL_Rect level_raster_clip(const Level_Raster *raster, SDL_Rect area);
+
+// Only touches the pixels inside of area, or all of them if area is
+// NULL
+void level_raster_draw(const Level_Raster *raster,
+                       Color background,
+                       const Level_Raster_Rect *rects,
+                       size_t count,
+                       const SDL_Rect *area);
+
+#endif  // LEVEL_RASTER_H_
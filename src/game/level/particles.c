@@ -0,0 +1,332 @@
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "./particles.h"
+#include "math/pi.h"
+#include "math/rand.h"
+#include "math/triangle.h"
+#include "system/lt.h"
+#include "system/nth_alloc.h"
+#include "system/stacktrace.h"
+
+#define PARTICLES_BURSTS_CAPACITY 128
+#define PARTICLES_SEED 0x6e6f7468696e67ULL
+
+typedef struct {
+    PackedColor color;
+    float duration;
+    float time_passed;
+    // The delta time the rotation steps of the burst were computed for
+    float step_dt;
+    size_t begin;
+    size_t count;
+} Burst;
+
+// The particles of every burst are kept together, the bursts are kept
+// in the order they were emitted and there are no gaps between them.
+struct Particles
+{
+    Lt *lt;
+    size_t capacity;
+    size_t count;
+
+    float *xs;
+    float *ys;
+    float *dxs;
+    float *dys;
+    // The rotation of the particle is kept as its cosine and sine and
+    // is advanced every update by multiplying it by the rotation step.
+    // The steps only change when the delta time does.
+    float *coss;
+    float *sins;
+    float *spins;
+    float *step_coss;
+    float *step_sins;
+    // Relative to the center of the particle
+    Triangle *bodies;
+
+    // Scratch space of particles_render
+    Triangle *triangles;
+
+    size_t bursts_count;
+    Burst bursts[PARTICLES_BURSTS_CAPACITY];
+
+    Rng rng;
+};
+
+static float *particles_alloc_floats(Lt *lt, size_t capacity)
+{
+    return PUSH_LT(lt, nth_calloc(capacity, sizeof(float)), free);
+}
+
+Particles *create_particles(size_t capacity)
+{
+    Lt *lt = create_lt();
+
+    Particles *particles = PUSH_LT(lt, nth_calloc(1, sizeof(Particles)), free);
+    if (particles == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+    particles->lt = lt;
+    particles->capacity = capacity;
+    particles->rng = create_rng(PARTICLES_SEED, 0);
+
+    float **floats[] = {
+        &particles->xs, &particles->ys,
+        &particles->dxs, &particles->dys,
+        &particles->coss, &particles->sins,
+        &particles->spins,
+        &particles->step_coss, &particles->step_sins
+    };
+    for (size_t i = 0; i < sizeof(floats) / sizeof(floats[0]); ++i) {
+        *floats[i] = particles_alloc_floats(lt, capacity);
+        if (*floats[i] == NULL) {
+            RETURN_LT(lt, NULL);
+        }
+    }
+
+    particles->bodies = PUSH_LT(lt, nth_calloc(capacity, sizeof(Triangle)), free);
+    if (particles->bodies == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+
+    particles->triangles = PUSH_LT(lt, nth_calloc(capacity, sizeof(Triangle)), free);
+    if (particles->triangles == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+
+    return particles;
+}
+
+void destroy_particles(Particles *particles)
+{
+    trace_assert(particles);
+    RETURN_LT0(particles->lt);
+}
+
+void particles_emit(Particles *particles,
+                    const Emitter *emitter,
+                    Vec2f position,
+                    size_t count)
+{
+    trace_assert(particles);
+    trace_assert(emitter);
+
+    if (particles->bursts_count >= PARTICLES_BURSTS_CAPACITY) {
+        return;
+    }
+
+    if (count > particles->capacity - particles->count) {
+        count = particles->capacity - particles->count;
+    }
+
+    if (count == 0) {
+        return;
+    }
+
+    Burst *burst = &particles->bursts[particles->bursts_count++];
+    burst->color = emitter->color;
+    burst->duration = emitter->duration;
+    burst->time_passed = 0.0f;
+    burst->step_dt = 0.0f;
+    burst->begin = particles->count;
+    burst->count = count;
+
+    // The random numbers are generated an array at a time straight
+    // into the pool: the angles go into coss, the direction angles into
+    // dxs and the speeds into dys, and they are turned into what the
+    // arrays actually hold right after
+    Rng *rng = &particles->rng;
+    const size_t begin = burst->begin;
+    rng_fill_float_range(rng, particles->coss + begin, count, 0.0f, 2.0f * PI);
+    rng_fill_float_range(rng, particles->dxs + begin, count,
+                         emitter->direction_begin, emitter->direction_end);
+    rng_fill_float_range(rng, particles->dys + begin, count,
+                         emitter->speed_min, emitter->speed_max);
+    rng_fill_float_range(rng, particles->spins + begin, count, 0.0f, emitter->spin);
+
+    for (size_t i = begin; i < begin + count; ++i) {
+        const float angle = particles->coss[i];
+        const Vec2f direction = vec_from_polar(particles->dxs[i], particles->dys[i]);
+
+        particles->xs[i] = position.x;
+        particles->ys[i] = position.y;
+        particles->dxs[i] = direction.x;
+        particles->dys[i] = direction.y;
+        particles->coss[i] = cosf(angle);
+        particles->sins[i] = sinf(angle);
+        particles->bodies[i] = random_triangle(rng, emitter->size);
+    }
+
+    particles->count += count;
+}
+
+static void particles_move(Particles *particles,
+                           size_t dst, size_t src, size_t n)
+{
+    float *floats[] = {
+        particles->xs, particles->ys,
+        particles->dxs, particles->dys,
+        particles->coss, particles->sins,
+        particles->spins,
+        particles->step_coss, particles->step_sins
+    };
+    for (size_t i = 0; i < sizeof(floats) / sizeof(floats[0]); ++i) {
+        memmove(floats[i] + dst, floats[i] + src, n * sizeof(float));
+    }
+    memmove(particles->bodies + dst, particles->bodies + src, n * sizeof(Triangle));
+}
+
+// Zeroing the unused part of the pool keeps the level snapshots
+// compressible
+static void particles_clear(Particles *particles, size_t begin, size_t n)
+{
+    float *floats[] = {
+        particles->xs, particles->ys,
+        particles->dxs, particles->dys,
+        particles->coss, particles->sins,
+        particles->spins,
+        particles->step_coss, particles->step_sins
+    };
+    for (size_t i = 0; i < sizeof(floats) / sizeof(floats[0]); ++i) {
+        memset(floats[i] + begin, 0, n * sizeof(float));
+    }
+    memset(particles->bodies + begin, 0, n * sizeof(Triangle));
+}
+
+static void particles_remove_finished(Particles *particles)
+{
+    size_t bursts_count = 0;
+    size_t count = 0;
+
+    for (size_t i = 0; i < particles->bursts_count; ++i) {
+        Burst burst = particles->bursts[i];
+        if (burst.time_passed >= burst.duration) {
+            continue;
+        }
+
+        if (burst.begin != count) {
+            particles_move(particles, count, burst.begin, burst.count);
+            burst.begin = count;
+        }
+
+        count += burst.count;
+        particles->bursts[bursts_count++] = burst;
+    }
+
+    particles_clear(particles, count, particles->count - count);
+    particles->bursts_count = bursts_count;
+    particles->count = count;
+}
+
+void particles_update(Particles *particles, float delta_time)
+{
+    trace_assert(particles);
+    trace_assert(delta_time > 0.0f);
+
+    bool finished = false;
+    for (size_t i = 0; i < particles->bursts_count; ++i) {
+        Burst *burst = &particles->bursts[i];
+        burst->time_passed += delta_time;
+        finished = finished || burst->time_passed >= burst->duration;
+
+        if (burst->step_dt != delta_time) {
+            for (size_t j = burst->begin; j < burst->begin + burst->count; ++j) {
+                particles->step_coss[j] = cosf(particles->spins[j] * delta_time);
+                particles->step_sins[j] = sinf(particles->spins[j] * delta_time);
+            }
+            burst->step_dt = delta_time;
+        }
+    }
+
+    if (finished) {
+        particles_remove_finished(particles);
+    }
+
+    const size_t n = particles->count;
+    float *const xs = particles->xs;
+    float *const ys = particles->ys;
+    const float *const dxs = particles->dxs;
+    const float *const dys = particles->dys;
+    float *const coss = particles->coss;
+    float *const sins = particles->sins;
+    const float *const step_coss = particles->step_coss;
+    const float *const step_sins = particles->step_sins;
+
+    for (size_t i = 0; i < n; ++i) {
+        xs[i] += dxs[i] * delta_time;
+        ys[i] += dys[i] * delta_time;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        const float c = coss[i] * step_coss[i] - sins[i] * step_sins[i];
+        const float s = sins[i] * step_coss[i] + coss[i] * step_sins[i];
+        coss[i] = c;
+        sins[i] = s;
+    }
+}
+
+int particles_render(Particles *particles, const Camera *camera)
+{
+    trace_assert(particles);
+    trace_assert(camera);
+
+    for (size_t i = 0; i < particles->count; ++i) {
+        const Triangle body = particles->bodies[i];
+        const float c = particles->coss[i];
+        const float s = particles->sins[i];
+        const float x = particles->xs[i];
+        const float y = particles->ys[i];
+
+        particles->triangles[i] = triangle(
+            vec(c * body.p1.x - s * body.p1.y + x, s * body.p1.x + c * body.p1.y + y),
+            vec(c * body.p2.x - s * body.p2.y + x, s * body.p2.x + c * body.p2.y + y),
+            vec(c * body.p3.x - s * body.p3.y + x, s * body.p3.x + c * body.p3.y + y));
+    }
+
+    for (size_t i = 0; i < particles->bursts_count; ++i) {
+        const Burst *burst = &particles->bursts[i];
+
+        const PackedColor color = packed_color_alpha(
+            burst->color,
+            fminf(1.0f, 4.0f - burst->time_passed / burst->duration * 4.0f));
+
+        if (camera_fill_triangles(
+                camera,
+                particles->triangles + burst->begin,
+                burst->count,
+                color) < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+size_t particles_count(const Particles *particles)
+{
+    trace_assert(particles);
+    return particles->count;
+}
+
+void particles_snapshot(Particles *particles, Snapshot *snapshot)
+{
+    trace_assert(particles);
+    trace_assert(snapshot);
+
+    SNAPSHOT_FIELD(snapshot, particles->count);
+    SNAPSHOT_ARRAY(snapshot, particles->xs, particles->capacity);
+    SNAPSHOT_ARRAY(snapshot, particles->ys, particles->capacity);
+    SNAPSHOT_ARRAY(snapshot, particles->dxs, particles->capacity);
+    SNAPSHOT_ARRAY(snapshot, particles->dys, particles->capacity);
+    SNAPSHOT_ARRAY(snapshot, particles->coss, particles->capacity);
+    SNAPSHOT_ARRAY(snapshot, particles->sins, particles->capacity);
+    SNAPSHOT_ARRAY(snapshot, particles->spins, particles->capacity);
+    SNAPSHOT_ARRAY(snapshot, particles->step_coss, particles->capacity);
+    SNAPSHOT_ARRAY(snapshot, particles->step_sins, particles->capacity);
+    SNAPSHOT_ARRAY(snapshot, particles->bodies, particles->capacity);
+    SNAPSHOT_FIELD(snapshot, particles->bursts_count);
+    SNAPSHOT_FIELD(snapshot, particles->bursts);
+    SNAPSHOT_FIELD(snapshot, particles->rng);
+}
@@ -0,0 +1,48 @@
+#ifndef PARTICLES_H_
+#define PARTICLES_H_
+
+#include "color.h"
+#include "game/camera.h"
+#include "game/level/snapshot.h"
+#include "math/vec.h"
+
+// Preallocated pool of flying and spinning triangles shared by the
+// whole level. Every particles_emit call makes a burst of particles
+// that live the same amount of time and are rendered with a single
+// batch of triangles.
+
+typedef struct Particles Particles;
+
+typedef struct {
+    PackedColor color;
+    // For how long the particles live, in seconds
+    float duration;
+    // Radius of the random triangles
+    float size;
+    // The particles fly in a random direction between these two
+    // angles with a random speed between speed_min and speed_max
+    float direction_begin;
+    float direction_end;
+    float speed_min;
+    float speed_max;
+    // Maximal angular velocity in radians per second
+    float spin;
+} Emitter;
+
+Particles *create_particles(size_t capacity);
+void destroy_particles(Particles *particles);
+
+// Emits as many of count particles as there is space left in the pool
+void particles_emit(Particles *particles,
+                    const Emitter *emitter,
+                    Vec2f position,
+                    size_t count);
+
+void particles_update(Particles *particles, float delta_time);
+int particles_render(Particles *particles, const Camera *camera);
+
+size_t particles_count(const Particles *particles);
+
+void particles_snapshot(Particles *particles, Snapshot *snapshot);
+
+#endif  // PARTICLES_H_
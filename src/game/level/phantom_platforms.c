@@ -1,18 +1,29 @@
 #include "phantom_platforms.h"
+#include "system/log.h"
 
-Phantom_Platforms create_phantom_platforms(RectLayer *rect_layer)
+#define PHANTOM_PLATFORMS_GRID_CELL_SIZE 200.0f
+
+Phantom_Platforms create_phantom_platforms(const Level_Rects *layer)
 {
     Phantom_Platforms pp;
 
-    pp.size = rect_layer->rects.count;
+    pp.size = layer->count;
     pp.rects = malloc(sizeof(pp.rects[0]) * pp.size);
-    memcpy(pp.rects, rect_layer->rects.data, sizeof(pp.rects[0]) * pp.size);
+    memcpy(pp.rects, layer->rects, sizeof(pp.rects[0]) * pp.size);
 
     pp.colors = malloc(sizeof(pp.colors[0]) * pp.size);
-    memcpy(pp.colors, rect_layer->colors.data, sizeof(pp.colors[0]) * pp.size);
+    memcpy(pp.colors, layer->colors, sizeof(pp.colors[0]) * pp.size);
 
     pp.hiding = calloc(1, sizeof(pp.hiding[0]) * pp.size);
 
+    pp.fading = malloc(sizeof(pp.fading[0]) * pp.size);
+    pp.fading_count = 0;
+
+    // Without the grid the platforms just never hide
+    if (create_rect_grid(&pp.grid, pp.rects, pp.size, PHANTOM_PLATFORMS_GRID_CELL_SIZE) < 0) {
+        log_warn("Could not index the phantom platforms\n");
+    }
+
     return pp;
 }
 
@@ -21,6 +32,8 @@ void destroy_phantom_platforms(Phantom_Platforms pp)
     free(pp.rects);
     free(pp.colors);
     free(pp.hiding);
+    free(pp.fading);
+    destroy_rect_grid(pp.grid);
 }
 
 void phantom_platforms_render(const Phantom_Platforms *pp, const Camera *camera)
@@ -35,31 +48,45 @@ void phantom_platforms_render(const Phantom_Platforms *pp, const Camera *camera)
 
 #define HIDING_SPEED 4.0f
 
-// TODO(#1247): phantom_platforms_update is O(N) even when nothing is animated
 void phantom_platforms_update(Phantom_Platforms *pp, float dt)
 {
     trace_assert(pp);
 
-    for (size_t i = 0; i < pp->size; ++i) {
-        if (pp->hiding[i]) {
-            if (pp->colors[i].a > 0.0f) {
-                pp->colors[i].a =
-                    fmaxf(0.0f, pp->colors[i].a - HIDING_SPEED * dt);
-            } else {
-                pp->hiding[i] = 0;
-            }
+    for (size_t j = 0; j < pp->fading_count;) {
+        const size_t i = pp->fading[j];
+        if (pp->colors[i].a > 0.0f) {
+            pp->colors[i].a =
+                fmaxf(0.0f, pp->colors[i].a - HIDING_SPEED * dt);
+            ++j;
+        } else {
+            pp->hiding[i] = 0;
+            pp->fading[j] = pp->fading[--pp->fading_count];
         }
     }
 }
 
-// TODO(#1248): phantom_platforms_hide_at is O(N)
 void phantom_platforms_hide_at(Phantom_Platforms *pp, Vec2f position)
 {
     trace_assert(pp);
 
-    for (size_t i = 0; i < pp->size; ++i) {
-        if (rect_contains_point(pp->rects[i], position)) {
+    const size_t *items = NULL;
+    const size_t n = rect_grid_at(&pp->grid, position, &items);
+    for (size_t j = 0; j < n; ++j) {
+        const size_t i = items[j];
+        if (!pp->hiding[i] && rect_contains_point(pp->rects[i], position)) {
             pp->hiding[i] = 1;
+            pp->fading[pp->fading_count++] = i;
         }
     }
 }
+
+void phantom_platforms_snapshot(Phantom_Platforms *pp, Snapshot *snapshot)
+{
+    trace_assert(pp);
+    trace_assert(snapshot);
+
+    SNAPSHOT_ARRAY(snapshot, pp->colors, pp->size);
+    SNAPSHOT_ARRAY(snapshot, pp->hiding, pp->size);
+    SNAPSHOT_ARRAY(snapshot, pp->fading, pp->size);
+    SNAPSHOT_FIELD(snapshot, pp->fading_count);
+}
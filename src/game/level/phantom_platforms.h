@@ -3,21 +3,32 @@
 
 #include <stdlib.h>
 #include "math/rect.h"
+#include "math/rect_grid.h"
 #include "color.h"
-#include "game/level/level_editor/rect_layer.h"
+#include "game/camera.h"
+#include "game/level/snapshot.h"
+#include "game/level/level_data.h"
 
 typedef struct {
     size_t size;
     Rect *rects;
     Color *colors;
     int *hiding;
+
+    // Dense list of the hiding platforms
+    size_t *fading;
+    size_t fading_count;
+
+    RectGrid grid;
 } Phantom_Platforms;
 
-Phantom_Platforms create_phantom_platforms(RectLayer *rect_layer);
+Phantom_Platforms create_phantom_platforms(const Level_Rects *layer);
 void destroy_phantom_platforms(Phantom_Platforms pp);
 
 void phantom_platforms_render(const Phantom_Platforms *pp, const Camera *camera);
 void phantom_platforms_update(Phantom_Platforms *pp, float dt);
 void phantom_platforms_hide_at(Phantom_Platforms *pp, Vec2f position);
 
+void phantom_platforms_snapshot(Phantom_Platforms *pp, Snapshot *snapshot);
+
 #endif  // PHANTOM_PLATFORMS_H_
@@ -9,18 +9,17 @@
 #include "system/lt.h"
 #include "system/nth_alloc.h"
 #include "system/log.h"
-#include "game/level/level_editor/rect_layer.h"
 #include "math/extrema.h"
 
 struct Platforms {
     Lt *lt;
 
     Rect *rects;
-    Color *colors;
+    PackedColor *colors;
     size_t rects_size;
 };
 
-Platforms *create_platforms_from_rect_layer(const RectLayer *layer)
+Platforms *create_platforms(const Level_Rects *layer)
 {
     trace_assert(layer);
 
@@ -35,20 +34,23 @@ Platforms *create_platforms_from_rect_layer(const RectLayer *layer)
     }
     platforms->lt = lt;
 
-    platforms->rects_size = rect_layer_count(layer);
+    platforms->rects_size = layer->count;
 
     platforms->rects = PUSH_LT(lt, nth_calloc(1, sizeof(Rect) * platforms->rects_size), free);
     if (platforms->rects == NULL) {
         RETURN_LT(lt, NULL);
     }
-    memcpy(platforms->rects, rect_layer_rects(layer), sizeof(Rect) * platforms->rects_size);
+    memcpy(platforms->rects, layer->rects, sizeof(Rect) * platforms->rects_size);
 
 
-    platforms->colors = PUSH_LT(lt, nth_calloc(1, sizeof(Color) * platforms->rects_size), free);
+    platforms->colors = PUSH_LT(lt, nth_calloc(1, sizeof(PackedColor) * platforms->rects_size), free);
     if (platforms->colors == NULL) {
         RETURN_LT(lt, NULL);
     }
-    memcpy(platforms->colors, rect_layer_colors(layer), sizeof(Color) * platforms->rects_size);
+    const Color *colors = layer->colors;
+    for (size_t i = 0; i < platforms->rects_size; ++i) {
+        platforms->colors[i] = color_pack(colors[i]);
+    }
 
     return platforms;
 }
@@ -64,7 +66,7 @@ int platforms_render(const Platforms *platforms,
 {
     for (size_t i = 0; i < platforms->rects_size; ++i) {
         Rect platform_rect = platforms->rects[i];
-        if (camera_fill_rect(
+        if (camera_fill_rect_packed(
                 camera,
                 platform_rect,
                 platforms->colors[i]) < 0) {
@@ -5,11 +5,11 @@
 
 #include "game/camera.h"
 #include "math/rect.h"
+#include "game/level/level_data.h"
 
 typedef struct Platforms Platforms;
-typedef struct RectLayer RectLayer;
 
-Platforms *create_platforms_from_rect_layer(const RectLayer *layer);
+Platforms *create_platforms(const Level_Rects *layer);
 void destroy_platforms(Platforms *platforms);
 
 int platforms_render(const Platforms *platforms,
@@ -3,9 +3,10 @@
 
 #include <SDL.h>
 
-#include "game/level/explosion.h"
+#include "game/level/particles.h"
 #include "game/level/rigid_bodies.h"
 #include "goals.h"
+#include "math/pi.h"
 #include "math/vec.h"
 #include "platforms.h"
 #include "player.h"
@@ -21,6 +22,8 @@
 #define PLAYER_JUMP 32000.0f
 #define PLAYER_DEATH_DURATION 0.75f
 #define PLAYER_MAX_JUMP_THRESHOLD 2
+#define PLAYER_DEATH_PARTICLES_COUNT 20
+#define PLAYER_DEATH_PARTICLE_SIZE 20.0f
 
 typedef enum Player_state {
     PLAYER_STATE_ALIVE = 0,
@@ -34,21 +37,23 @@ struct Player {
     RigidBodies *rigid_bodies;
 
     RigidBodyId alive_body_id;
-    Explosion *dying_body;
+    Particles *particles;
+    float dying_time;
 
     int jump_threshold;
-    Color color;
+    PackedColor color;
 
     Vec2f checkpoint;
 
     int play_die_cue;
 };
 
-Player *create_player_from_player_layer(const PlayerLayer *player_layer,
-                                        RigidBodies *rigid_bodies)
+Player *create_player(Vec2f position, Color color,
+                      RigidBodies *rigid_bodies,
+                      Particles *particles)
 {
-    trace_assert(player_layer);
     trace_assert(rigid_bodies);
+    trace_assert(particles);
 
     Lt *lt = create_lt();
 
@@ -63,24 +68,16 @@ Player *create_player_from_player_layer(const PlayerLayer *player_layer,
     player->alive_body_id = rigid_bodies_add(
         rigid_bodies,
         rect(
-            player_layer->position.x,
-            player_layer->position.y,
+            position.x,
+            position.y,
             PLAYER_WIDTH,
             PLAYER_HEIGHT));
 
-    player->dying_body = PUSH_LT(
-        lt,
-        create_explosion(
-            color_picker_rgba(&player_layer->color_picker),
-            PLAYER_DEATH_DURATION),
-        destroy_explosion);
-    if (player->dying_body == NULL) {
-        RETURN_LT(lt, NULL);
-    }
+    player->particles = particles;
 
     player->jump_threshold = 0;
-    player->color = color_picker_rgba(&player_layer->color_picker);
-    player->checkpoint = player_layer->position;
+    player->color = color_pack(color);
+    player->checkpoint = position;
     player->play_die_cue = 0;
     player->state = PLAYER_STATE_ALIVE;
 
@@ -118,7 +115,8 @@ int player_render(const Player * player,
     }
 
     case PLAYER_STATE_DYING:
-        return explosion_render(player->dying_body, camera);
+        // The dying body is made of the level particles
+        break;
 
     default: {}
     }
@@ -144,9 +142,9 @@ void player_update(Player *player,
     } break;
 
     case PLAYER_STATE_DYING: {
-        explosion_update(player->dying_body, delta_time);
+        player->dying_time += delta_time;
 
-        if (explosion_is_done(player->dying_body)) {
+        if (player->dying_time >= PLAYER_DEATH_DURATION) {
             rigid_bodies_disable(player->rigid_bodies, player->alive_body_id, false);
             rigid_bodies_transform_velocity(
                 player->rigid_bodies,
@@ -221,7 +219,22 @@ void player_die(Player *player)
 
         player->play_die_cue = 1;
         player->jump_threshold = 0;
-        explosion_start(player->dying_body, vec(hitbox.x, hitbox.y));
+        const Emitter emitter = {
+            .color = player->color,
+            .duration = PLAYER_DEATH_DURATION,
+            .size = PLAYER_DEATH_PARTICLE_SIZE,
+            .direction_begin = -PI,
+            .direction_end = 0.0f,
+            .speed_min = 100.0f,
+            .speed_max = 300.0f,
+            .spin = 8.0f
+        };
+        particles_emit(
+            player->particles,
+            &emitter,
+            vec(hitbox.x, hitbox.y),
+            PLAYER_DEATH_PARTICLES_COUNT);
+        player->dying_time = 0.0f;
         player->state = PLAYER_STATE_DYING;
         rigid_bodies_disable(player->rigid_bodies, player->alive_body_id, true);
     }
@@ -293,3 +306,21 @@ Rect player_hitbox(const Player *player)
         player->rigid_bodies,
         player->alive_body_id);
 }
+
+bool player_alive(const Player *player)
+{
+    trace_assert(player);
+    return player->state == PLAYER_STATE_ALIVE;
+}
+
+void player_snapshot(Player *player, Snapshot *snapshot)
+{
+    trace_assert(player);
+    trace_assert(snapshot);
+
+    SNAPSHOT_FIELD(snapshot, player->state);
+    SNAPSHOT_FIELD(snapshot, player->jump_threshold);
+    SNAPSHOT_FIELD(snapshot, player->checkpoint);
+    SNAPSHOT_FIELD(snapshot, player->play_die_cue);
+    SNAPSHOT_FIELD(snapshot, player->dying_time);
+}
@@ -8,14 +8,16 @@
 #include "lava.h"
 #include "platforms.h"
 #include "boxes.h"
-#include "game/level/level_editor/player_layer.h"
+#include "game/level/snapshot.h"
 
 typedef struct Player Player;
 typedef struct Goals Goals;
 typedef struct RigidBodies RigidBodies;
+typedef struct Particles Particles;
 
-Player *create_player_from_player_layer(const PlayerLayer *player_layer,
-                                        RigidBodies *rigid_bodies);
+Player *create_player(Vec2f position, Color color,
+                      RigidBodies *rigid_bodies,
+                      Particles *particles);
 void destroy_player(Player * player);
 
 int player_render(const Player * player,
@@ -46,5 +48,8 @@ bool player_overlaps_rect(const Player *player,
                           Rect rect);
 
 Rect player_hitbox(const Player *player);
+bool player_alive(const Player *player);
+
+void player_snapshot(Player *player, Snapshot *snapshot);
 
 #endif  // PLAYER_H_
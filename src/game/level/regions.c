@@ -7,34 +7,205 @@
 #include "system/log.h"
 #include "system/lt.h"
 #include "system/nth_alloc.h"
-#include "game/level/level_editor/rect_layer.h"
 #include "game/level/labels.h"
 #include "game/level/goals.h"
+#include "game/level/boxes.h"
+#include "math/rect_grid.h"
+#include "system/id_table.h"
+
+#define REGIONS_GRID_CELL_SIZE 500.0f
 
 enum RegionState {
-    RS_PLAYER_OUTSIDE = 0,
-    RS_PLAYER_INSIDE
+    RS_EMPTY = 0,
+    RS_OCCUPIED
 };
 
+// Action with its target already resolved to the index of the label
+// or the goal
+typedef struct {
+    ActionType type;
+    uint32_t target;
+    bool boxes;
+} RegionAction;
+
+// Open addressing map from entity ids to their indices. Only lives
+// while the regions are created.
+typedef struct {
+    size_t capacity;
+    // ID_NONE is an empty slot
+    Id *keys;
+    uint32_t *values;
+} IdIndex;
+
 struct Regions {
     Lt *lt;
     size_t count;
-    char *ids;
+    Id *ids;
     Rect *rects;
     Color *colors;
     enum RegionState *states;
-    Action *actions;
+    RegionAction *actions;
+
+    RectGrid grid;
+    // Amount of regions that are activated by the boxes
+    size_t boxes_count;
+    // Dense list of the RS_OCCUPIED regions
+    size_t *occupied;
+    size_t occupied_count;
+    // Regions that changed their state during regions_update
+    size_t *changed;
+    size_t changed_count;
+    // The last frame the region was found occupied at
+    uint32_t *visits;
+    uint32_t frame;
 
     Labels *labels;
     Goals *goals;
 };
 
-Regions *create_regions_from_rect_layer(const RectLayer *rect_layer,
-                                        Labels *labels,
-                                        Goals *goals)
+static
+int create_id_index(IdIndex *index, size_t count)
+{
+    index->capacity = 16;
+    while (index->capacity < count * 2) {
+        index->capacity *= 2;
+    }
+
+    index->keys = nth_calloc(index->capacity, sizeof(Id));
+    index->values = nth_calloc(index->capacity, sizeof(uint32_t));
+    if (index->keys == NULL || index->values == NULL) {
+        free(index->keys);
+        free(index->values);
+        return -1;
+    }
+
+    return 0;
+}
+
+static
+void destroy_id_index(IdIndex index)
+{
+    free(index.keys);
+    free(index.values);
+}
+
+// Returns the slot of the id: either the one that holds it or the
+// empty one where it should go
+static
+size_t id_index_slot(const IdIndex *index, Id id)
+{
+    size_t slot = (id * 2654435761u) & (index->capacity - 1);
+    while (index->keys[slot] != ID_NONE && index->keys[slot] != id) {
+        slot = (slot + 1) & (index->capacity - 1);
+    }
+    return slot;
+}
+
+// Returns false if the id is already in the index
+static
+bool id_index_insert(IdIndex *index, Id id, size_t entity_index)
+{
+    const size_t slot = id_index_slot(index, id);
+    if (index->keys[slot] != ID_NONE) {
+        return false;
+    }
+
+    index->keys[slot] = id;
+    index->values[slot] = (uint32_t) entity_index;
+    return true;
+}
+
+static
+bool id_index_find(const IdIndex *index, Id id, uint32_t *entity_index)
+{
+    if (id == ID_NONE) {
+        return false;
+    }
+
+    const size_t slot = id_index_slot(index, id);
+    if (index->keys[slot] == ID_NONE) {
+        return false;
+    }
+
+    *entity_index = index->values[slot];
+    return true;
+}
+
+static
+int regions_resolve_actions(Regions *regions,
+                            const Action *actions,
+                            const Labels *labels,
+                            const Goals *goals)
+{
+    IdIndex label_index, goal_index;
+
+    if (create_id_index(&label_index, labels_count(labels)) < 0) {
+        return -1;
+    }
+
+    if (create_id_index(&goal_index, goals_count(goals)) < 0) {
+        destroy_id_index(label_index);
+        return -1;
+    }
+
+    for (size_t i = 0; i < labels_count(labels); ++i) {
+        if (!id_index_insert(&label_index, labels_id(labels, i), i)) {
+            log_warn("Duplicate label id `%s'. Regions only see the first one.\n",
+                     id_table_cstr(labels_id(labels, i)));
+        }
+    }
+
+    for (size_t i = 0; i < goals_count(goals); ++i) {
+        if (!id_index_insert(&goal_index, goals_id(goals, i), i)) {
+            log_warn("Duplicate goal id `%s'. Regions only see the first one.\n",
+                     id_table_cstr(goals_id(goals, i)));
+        }
+    }
+
+    for (size_t i = 0; i < regions->count; ++i) {
+        const char *region_id = id_table_cstr(regions->ids[i]);
+        // Ids that were never interned don't belong to any label or goal
+        const Id target = id_table_find(actions[i].entity_id);
+
+        regions->actions[i].type = actions[i].type;
+        regions->actions[i].boxes = actions[i].boxes;
+
+        switch (actions[i].type) {
+        case ACTION_HIDE_LABEL: {
+            if (!id_index_find(&label_index, target, &regions->actions[i].target)) {
+                log_warn("Region `%s' refers to label `%.*s' that does not exist\n",
+                         region_id,
+                         ENTITY_MAX_ID_SIZE, actions[i].entity_id);
+                regions->actions[i].type = ACTION_NONE;
+            }
+        } break;
+
+        case ACTION_TOGGLE_GOAL: {
+            if (!id_index_find(&goal_index, target, &regions->actions[i].target)) {
+                log_warn("Region `%s' refers to goal `%.*s' that does not exist\n",
+                         region_id,
+                         ENTITY_MAX_ID_SIZE, actions[i].entity_id);
+                regions->actions[i].type = ACTION_NONE;
+            }
+        } break;
+
+        default: {}
+        }
+    }
+
+    destroy_id_index(label_index);
+    destroy_id_index(goal_index);
+
+    return 0;
+}
+
+Regions *create_regions(const Level_Rects *layer,
+                        Labels *labels,
+                        Goals *goals)
 {
-    trace_assert(rect_layer);
+    trace_assert(layer);
     trace_assert(labels);
+    trace_assert(goals);
 
     Lt *lt = create_lt();
 
@@ -47,18 +218,19 @@ Regions *create_regions_from_rect_layer(const RectLayer *rect_layer,
     }
     regions->lt = lt;
 
-    regions->count = rect_layer_count(rect_layer);
+    regions->count = layer->count;
 
     regions->ids = PUSH_LT(
         lt,
-        nth_calloc(regions->count * ENTITY_MAX_ID_SIZE, sizeof(char)),
+        nth_calloc(regions->count, sizeof(Id)),
         free);
     if (regions->ids == NULL) {
         RETURN_LT(lt, NULL);
     }
-    memcpy(regions->ids,
-           rect_layer_ids(rect_layer),
-           regions->count * ENTITY_MAX_ID_SIZE * sizeof(char));
+    const char *ids = layer->ids;
+    for (size_t i = 0; i < regions->count; ++i) {
+        regions->ids[i] = id_table_intern(ids + i * ENTITY_MAX_ID_SIZE);
+    }
 
 
     regions->rects = PUSH_LT(
@@ -69,7 +241,7 @@ Regions *create_regions_from_rect_layer(const RectLayer *rect_layer,
         RETURN_LT(lt, NULL);
     }
     memcpy(regions->rects,
-           rect_layer_rects(rect_layer),
+           layer->rects,
            regions->count * sizeof(Rect));
 
 
@@ -81,7 +253,7 @@ Regions *create_regions_from_rect_layer(const RectLayer *rect_layer,
         RETURN_LT(lt, NULL);
     }
     memcpy(regions->colors,
-           rect_layer_colors(rect_layer),
+           layer->colors,
            regions->count * sizeof(Color));
 
     regions->states = PUSH_LT(
@@ -94,17 +266,54 @@ Regions *create_regions_from_rect_layer(const RectLayer *rect_layer,
 
     regions->actions = PUSH_LT(
         lt,
-        nth_calloc(1, sizeof(Action) * regions->count),
+        nth_calloc(1, sizeof(RegionAction) * regions->count),
         free);
     if (regions->actions == NULL) {
         RETURN_LT(lt, NULL);
     }
-    memcpy(regions->actions,
-           rect_layer_actions(rect_layer),
-           regions->count * sizeof(Action));
+    if (regions_resolve_actions(regions, layer->actions, labels, goals) < 0) {
+        RETURN_LT(lt, NULL);
+    }
 
     // TODO(#1108): impossible to change the region action from the Level Editor
 
+    for (size_t i = 0; i < regions->count; ++i) {
+        if (regions->actions[i].boxes) {
+            regions->boxes_count++;
+        }
+    }
+
+    regions->occupied = PUSH_LT(
+        lt,
+        nth_calloc(regions->count + 1, sizeof(size_t)),
+        free);
+    if (regions->occupied == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+
+    regions->changed = PUSH_LT(
+        lt,
+        nth_calloc(regions->count + 1, sizeof(size_t)),
+        free);
+    if (regions->changed == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+
+    regions->visits = PUSH_LT(
+        lt,
+        nth_calloc(regions->count + 1, sizeof(uint32_t)),
+        free);
+    if (regions->visits == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+
+    if (create_rect_grid(
+            &regions->grid,
+            regions->rects,
+            regions->count,
+            REGIONS_GRID_CELL_SIZE) < 0) {
+        RETURN_LT(lt, NULL);
+    }
 
     regions->labels = labels;
     regions->goals = goals;
@@ -115,51 +324,123 @@ Regions *create_regions_from_rect_layer(const RectLayer *rect_layer,
 void destroy_regions(Regions *regions)
 {
     trace_assert(regions);
+    destroy_rect_grid(regions->grid);
     RETURN_LT0(regions->lt);
 }
 
-void regions_player_enter(Regions *regions, Player *player)
+// Marks the regions overlapped by the hitbox as visited during the
+// current frame. Only the regions from the cells around the hitbox are
+// checked. player is NULL when the hitbox belongs to a box.
+static
+void regions_visit(Regions *regions, Rect hitbox, const Player *player)
+{
+    const RectGridSpan span = rect_grid_span(&regions->grid, hitbox);
+    for (size_t row = span.row_begin; row < span.row_end; ++row) {
+        for (size_t col = span.col_begin; col < span.col_end; ++col) {
+            const size_t *items = NULL;
+            const size_t n = rect_grid_cell(&regions->grid, col, row, &items);
+            for (size_t j = 0; j < n; ++j) {
+                const size_t i = items[j];
+
+                if (regions->visits[i] == regions->frame) {
+                    continue;
+                }
+
+                if (player != NULL
+                    ? !player_overlaps_rect(player, regions->rects[i])
+                    : !regions->actions[i].boxes || !rects_overlap(regions->rects[i], hitbox)) {
+                    continue;
+                }
+
+                regions->visits[i] = regions->frame;
+                if (regions->states[i] == RS_EMPTY) {
+                    regions->changed[regions->changed_count++] = i;
+                }
+            }
+        }
+    }
+}
+
+// The actions are fired in the order of the regions, not in the order
+// they were found in
+static
+void regions_sort_changed(Regions *regions)
+{
+    for (size_t i = 1; i < regions->changed_count; ++i) {
+        const size_t x = regions->changed[i];
+        size_t j = i;
+        for (; j > 0 && regions->changed[j - 1] > x; --j) {
+            regions->changed[j] = regions->changed[j - 1];
+        }
+        regions->changed[j] = x;
+    }
+}
+
+void regions_update(Regions *regions, const Player *player, const Boxes *boxes)
 {
     trace_assert(regions);
     trace_assert(player);
+    trace_assert(boxes);
 
-    for (size_t i = 0; i < regions->count; ++i) {
-        if (regions->states[i] == RS_PLAYER_OUTSIDE &&
-            player_overlaps_rect(player, regions->rects[i])) {
-            regions->states[i] = RS_PLAYER_INSIDE;
+    regions->frame++;
 
-            switch (regions->actions[i].type) {
-            case ACTION_HIDE_LABEL: {
-                labels_hide(regions->labels, regions->actions[i].entity_id);
-            } break;
+    // Enter
+    regions->changed_count = 0;
 
-            case ACTION_TOGGLE_GOAL: {
-                goals_hide(regions->goals, regions->actions[i].entity_id);
-            } break;
+    regions_visit(regions, player_hitbox(player), player);
 
-            default: {}
-            }
+    if (regions->boxes_count > 0) {
+        const size_t n = boxes_count(boxes);
+        for (size_t i = 0; i < n; ++i) {
+            regions_visit(regions, boxes_hitbox(boxes, i), NULL);
         }
     }
-}
 
-void regions_player_leave(Regions *regions, Player *player)
-{
-    trace_assert(regions);
-    trace_assert(player);
+    regions_sort_changed(regions);
 
-    for (size_t i = 0; i < regions->count; ++i) {
-        if (regions->states[i] == RS_PLAYER_INSIDE &&
-            !player_overlaps_rect(player, regions->rects[i])) {
-            regions->states[i] = RS_PLAYER_OUTSIDE;
+    for (size_t j = 0; j < regions->changed_count; ++j) {
+        const size_t i = regions->changed[j];
+        regions->states[i] = RS_OCCUPIED;
+        regions->occupied[regions->occupied_count++] = i;
 
-            switch (regions->actions[i].type) {
-            case ACTION_TOGGLE_GOAL: {
-                goals_show(regions->goals, regions->actions[i].entity_id);
-            } break;
+        switch (regions->actions[i].type) {
+        case ACTION_HIDE_LABEL: {
+            labels_hide(regions->labels, regions->actions[i].target);
+        } break;
 
-            default: {}
-            }
+        case ACTION_TOGGLE_GOAL: {
+            goals_hide(regions->goals, regions->actions[i].target);
+        } break;
+
+        default: {}
+        }
+    }
+
+    // Leave. Only the occupied regions can be left.
+    regions->changed_count = 0;
+
+    for (size_t j = 0; j < regions->occupied_count;) {
+        const size_t i = regions->occupied[j];
+        if (regions->visits[i] != regions->frame) {
+            regions->changed[regions->changed_count++] = i;
+            regions->occupied[j] = regions->occupied[--regions->occupied_count];
+        } else {
+            ++j;
+        }
+    }
+
+    regions_sort_changed(regions);
+
+    for (size_t j = 0; j < regions->changed_count; ++j) {
+        const size_t i = regions->changed[j];
+        regions->states[i] = RS_EMPTY;
+
+        switch (regions->actions[i].type) {
+        case ACTION_TOGGLE_GOAL: {
+            goals_show(regions->goals, regions->actions[i].target);
+        } break;
+
+        default: {}
         }
     }
 }
@@ -180,3 +461,15 @@ int regions_render(Regions *regions, const Camera *camera)
 
     return 0;
 }
+
+void regions_snapshot(Regions *regions, Snapshot *snapshot)
+{
+    trace_assert(regions);
+    trace_assert(snapshot);
+
+    SNAPSHOT_ARRAY(snapshot, regions->states, regions->count);
+    SNAPSHOT_ARRAY(snapshot, regions->occupied, regions->count);
+    SNAPSHOT_FIELD(snapshot, regions->occupied_count);
+    SNAPSHOT_ARRAY(snapshot, regions->visits, regions->count);
+    SNAPSHOT_FIELD(snapshot, regions->frame);
+}
@@ -3,20 +3,25 @@
 
 #include "math/rect.h"
 #include "action.h"
+#include "game/level/snapshot.h"
+#include "game/level/level_data.h"
 
 typedef struct Regions Regions;
 typedef struct Player Player;
 typedef struct Level Level;
-typedef struct RectLayer RectLayer;
 typedef struct Labels Labels;
 typedef struct Goals Goals;
+typedef struct Boxes Boxes;
 
-Regions *create_regions_from_rect_layer(const RectLayer *rect_layer, Labels *labels, Goals *goals);
+Regions *create_regions(const Level_Rects *layer, Labels *labels, Goals *goals);
 void destroy_regions(Regions *regions);
 
 int regions_render(Regions *regions, const Camera *camera);
 
-void regions_player_enter(Regions *regions, Player *player);
-void regions_player_leave(Regions *regions, Player *player);
+// Fires the actions of the regions the player (or the boxes, if the
+// region allows that) entered or left since the previous call
+void regions_update(Regions *regions, const Player *player, const Boxes *boxes);
+
+void regions_snapshot(Regions *regions, Snapshot *snapshot);
 
 #endif  // REGIONS_H_
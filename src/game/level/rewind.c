@@ -0,0 +1,340 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "./rewind.h"
+#include "system/log.h"
+#include "system/lt.h"
+#include "system/nth_alloc.h"
+#include "system/stacktrace.h"
+
+typedef struct {
+    size_t offset;
+    size_t size;
+    bool keyframe;
+} RewindFrame;
+
+struct Rewind
+{
+    Lt *lt;
+    size_t snapshot_size;
+    size_t keyframe_interval;
+
+    // Ring of the encoded frames, oldest first. The oldest one is
+    // always a keyframe.
+    RewindFrame *frames;
+    size_t frames_capacity;
+    size_t frames_begin;
+    size_t frames_count;
+    // How many deltas follow the newest keyframe
+    size_t deltas_count;
+
+    // The frames are laid out in data in the same order as in the
+    // ring, each one contiguous. A frame that does not fit at the end
+    // starts over from the beginning.
+    uint8_t *data;
+    size_t data_capacity;
+
+    // The decoded newest frame
+    uint8_t *last;
+    // Space for a frame that is being encoded
+    uint8_t *scratch;
+    size_t scratch_capacity;
+};
+
+// Every run of the changed bytes costs two varints. In the worst case
+// (every other byte changed) that's three bytes for every two.
+static
+size_t rewind_encoded_size_bound(size_t snapshot_size)
+{
+    return 2 * snapshot_size + 32;
+}
+
+static
+size_t varint_write(uint8_t *out, size_t x)
+{
+    size_t n = 0;
+    while (x >= 0x80) {
+        out[n++] = (uint8_t) (x | 0x80);
+        x >>= 7;
+    }
+    out[n++] = (uint8_t) x;
+    return n;
+}
+
+static
+size_t varint_read(const uint8_t *in, size_t *x)
+{
+    size_t n = 0;
+    size_t shift = 0;
+    *x = 0;
+    do {
+        *x |= (size_t) (in[n] & 0x7f) << shift;
+        shift += 7;
+    } while (in[n++] & 0x80);
+    return n;
+}
+
+// Encodes a XOR b as a sequence of (zeros, literals, <literal bytes>)
+// runs. b == NULL encodes a itself.
+static
+size_t rewind_encode(const uint8_t *a, const uint8_t *b, size_t n, uint8_t *out)
+{
+    size_t size = 0;
+    size_t i = 0;
+
+    while (i < n) {
+        size_t zeros = 0;
+        while (i + zeros < n && (a[i + zeros] ^ (b ? b[i + zeros] : 0)) == 0) {
+            zeros++;
+        }
+        i += zeros;
+
+        size_t literals = 0;
+        while (i + literals < n && (a[i + literals] ^ (b ? b[i + literals] : 0)) != 0) {
+            literals++;
+        }
+
+        size += varint_write(out + size, zeros);
+        size += varint_write(out + size, literals);
+        for (size_t j = 0; j < literals; ++j) {
+            out[size++] = (uint8_t) (a[i + j] ^ (b ? b[i + j] : 0));
+        }
+        i += literals;
+    }
+
+    return size;
+}
+
+// XORs the encoded frame into state
+static
+void rewind_apply(const uint8_t *in, size_t size, uint8_t *state, size_t n)
+{
+    size_t i = 0;
+    size_t j = 0;
+
+    while (j < size) {
+        size_t zeros = 0;
+        size_t literals = 0;
+        j += varint_read(in + j, &zeros);
+        j += varint_read(in + j, &literals);
+        i += zeros;
+        trace_assert(i + literals <= n);
+        for (size_t k = 0; k < literals; ++k) {
+            state[i++] ^= in[j++];
+        }
+    }
+}
+
+static
+RewindFrame *rewind_frame(const Rewind *rewind, size_t index)
+{
+    trace_assert(index < rewind->frames_count);
+    return &rewind->frames[(rewind->frames_begin + index) % rewind->frames_capacity];
+}
+
+static
+void rewind_decode(const Rewind *rewind, const RewindFrame *frame, uint8_t *state)
+{
+    if (frame->keyframe) {
+        memset(state, 0, rewind->snapshot_size);
+    }
+    rewind_apply(rewind->data + frame->offset, frame->size,
+                 state, rewind->snapshot_size);
+}
+
+static
+void rewind_drop_oldest_keyframe(Rewind *rewind)
+{
+    trace_assert(rewind->frames_count > 0);
+
+    do {
+        rewind->frames_begin = (rewind->frames_begin + 1) % rewind->frames_capacity;
+        rewind->frames_count--;
+    } while (rewind->frames_count > 0 && !rewind_frame(rewind, 0)->keyframe);
+
+    if (rewind->frames_count == 0) {
+        rewind->deltas_count = 0;
+    }
+}
+
+// Finds a place for size bytes after the newest frame without
+// touching the older frames. Returns -1 if there is none.
+static
+int rewind_find_space(const Rewind *rewind, size_t size, size_t *offset)
+{
+    if (rewind->frames_count == 0) {
+        *offset = 0;
+        return size <= rewind->data_capacity ? 0 : -1;
+    }
+
+    const RewindFrame *oldest = rewind_frame(rewind, 0);
+    const RewindFrame *newest = rewind_frame(rewind, rewind->frames_count - 1);
+    const size_t head = newest->offset + newest->size;
+    const size_t tail = oldest->offset;
+
+    if (newest->offset >= tail) {
+        if (rewind->data_capacity - head >= size) {
+            *offset = head;
+            return 0;
+        }
+
+        if (size <= tail) {
+            *offset = 0;
+            return 0;
+        }
+    } else if (tail - head >= size) {
+        *offset = head;
+        return 0;
+    }
+
+    return -1;
+}
+
+Rewind *create_rewind(size_t snapshot_size,
+                      size_t frames_capacity,
+                      size_t keyframe_interval,
+                      size_t data_capacity)
+{
+    trace_assert(snapshot_size > 0);
+    trace_assert(frames_capacity > 0);
+    trace_assert(keyframe_interval > 0);
+
+    Lt *lt = create_lt();
+
+    Rewind *rewind = PUSH_LT(lt, nth_calloc(1, sizeof(Rewind)), free);
+    if (rewind == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+    rewind->lt = lt;
+
+    rewind->snapshot_size = snapshot_size;
+    rewind->keyframe_interval = keyframe_interval;
+    rewind->frames_capacity = frames_capacity;
+    rewind->scratch_capacity = rewind_encoded_size_bound(snapshot_size);
+
+    if (data_capacity < rewind->scratch_capacity) {
+        log_warn("Rewind buffer of %lu bytes can't fit a single frame of %lu bytes. Growing it.\n",
+                 (unsigned long) data_capacity,
+                 (unsigned long) snapshot_size);
+        data_capacity = rewind->scratch_capacity;
+    }
+    rewind->data_capacity = data_capacity;
+
+    rewind->frames = PUSH_LT(lt, nth_calloc(frames_capacity, sizeof(RewindFrame)), free);
+    if (rewind->frames == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+
+    rewind->data = PUSH_LT(lt, nth_calloc(1, data_capacity), free);
+    if (rewind->data == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+
+    rewind->last = PUSH_LT(lt, nth_calloc(1, snapshot_size), free);
+    if (rewind->last == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+
+    rewind->scratch = PUSH_LT(lt, nth_calloc(1, rewind->scratch_capacity), free);
+    if (rewind->scratch == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+
+    return rewind;
+}
+
+void destroy_rewind(Rewind *rewind)
+{
+    trace_assert(rewind);
+    RETURN_LT0(rewind->lt);
+}
+
+void rewind_push(Rewind *rewind, const void *snapshot)
+{
+    trace_assert(rewind);
+    trace_assert(snapshot);
+
+    if (rewind->frames_count == rewind->frames_capacity) {
+        rewind_drop_oldest_keyframe(rewind);
+    }
+
+    bool keyframe = rewind->frames_count == 0
+        || rewind->deltas_count + 1 >= rewind->keyframe_interval;
+    size_t size = rewind_encode(snapshot, keyframe ? NULL : rewind->last,
+                                rewind->snapshot_size, rewind->scratch);
+
+    size_t offset = 0;
+    while (rewind_find_space(rewind, size, &offset) < 0) {
+        rewind_drop_oldest_keyframe(rewind);
+
+        if (rewind->frames_count == 0 && !keyframe) {
+            // The delta lost the frames it is based on
+            keyframe = true;
+            size = rewind_encode(snapshot, NULL, rewind->snapshot_size, rewind->scratch);
+        }
+    }
+
+    memcpy(rewind->data + offset, rewind->scratch, size);
+
+    RewindFrame *frame = &rewind->frames[
+        (rewind->frames_begin + rewind->frames_count) % rewind->frames_capacity];
+    frame->offset = offset;
+    frame->size = size;
+    frame->keyframe = keyframe;
+    rewind->frames_count++;
+    rewind->deltas_count = keyframe ? 0 : rewind->deltas_count + 1;
+
+    memcpy(rewind->last, snapshot, rewind->snapshot_size);
+}
+
+int rewind_step_back(Rewind *rewind, void *snapshot)
+{
+    trace_assert(rewind);
+    trace_assert(snapshot);
+
+    if (rewind->frames_count < 2) {
+        return 0;
+    }
+
+    const RewindFrame *newest = rewind_frame(rewind, rewind->frames_count - 1);
+
+    if (!newest->keyframe) {
+        rewind_apply(rewind->data + newest->offset, newest->size,
+                     rewind->last, rewind->snapshot_size);
+        rewind->frames_count--;
+        rewind->deltas_count--;
+    } else {
+        // The previous frame is only reachable from its own keyframe.
+        // That happens once per keyframe_interval steps.
+        rewind->frames_count--;
+
+        size_t keyframe = rewind->frames_count - 1;
+        while (!rewind_frame(rewind, keyframe)->keyframe) {
+            keyframe--;
+        }
+
+        for (size_t i = keyframe; i < rewind->frames_count; ++i) {
+            rewind_decode(rewind, rewind_frame(rewind, i), rewind->last);
+        }
+        rewind->deltas_count = rewind->frames_count - 1 - keyframe;
+    }
+
+    memcpy(snapshot, rewind->last, rewind->snapshot_size);
+
+    return 1;
+}
+
+size_t rewind_count(const Rewind *rewind)
+{
+    trace_assert(rewind);
+    return rewind->frames_count;
+}
+
+void rewind_clean(Rewind *rewind)
+{
+    trace_assert(rewind);
+    rewind->frames_begin = 0;
+    rewind->frames_count = 0;
+    rewind->deltas_count = 0;
+}
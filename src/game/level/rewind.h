@@ -0,0 +1,37 @@
+#ifndef REWIND_H_
+#define REWIND_H_
+
+#include <stddef.h>
+
+// History of the level snapshots (see level_snapshot) for rewinding
+// the simulation back.
+//
+// Every keyframe_interval-th frame is stored as a keyframe, the rest
+// are stored as the XOR with the previous frame. Both are run-length
+// encoded with varints, so the bytes that did not change cost almost
+// nothing. Since XOR goes both ways stepping back over a delta is a
+// single pass over it.
+//
+// When either frames_capacity or data_capacity is exhausted the
+// oldest keyframe is dropped together with the deltas that depend on
+// it.
+
+typedef struct Rewind Rewind;
+
+Rewind *create_rewind(size_t snapshot_size,
+                      size_t frames_capacity,
+                      size_t keyframe_interval,
+                      size_t data_capacity);
+void destroy_rewind(Rewind *rewind);
+
+void rewind_push(Rewind *rewind, const void *snapshot);
+
+// Drops the newest frame and puts the one before it into snapshot.
+// Returns 0 and leaves snapshot untouched if there is nothing to go
+// back to.
+int rewind_step_back(Rewind *rewind, void *snapshot);
+
+size_t rewind_count(const Rewind *rewind);
+void rewind_clean(Rewind *rewind);
+
+#endif  // REWIND_H_
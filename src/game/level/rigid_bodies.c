@@ -8,9 +8,22 @@
 #include "system/stacktrace.h"
 #include "system/str.h"
 #include "system/log.h"
+#include "cvars.h"
 
 #include "./rigid_bodies.h"
 
+// Bodies closer than that to each other end up in the same contact
+// island. The relaxation pushes bodies around, so the margin has to
+// cover how far a body can travel within a single rigid_bodies_collide.
+#define RIGID_BODIES_ISLAND_MARGIN 50.0f
+// Islands are packed into jobs of at least that many bodies
+#define RIGID_BODIES_ISLAND_BATCH_SIZE 32
+
+typedef struct {
+    float x;
+    RigidBodyId id;
+} SweepEntry;
+
 struct RigidBodies
 {
     Lt *lt;
@@ -24,6 +37,14 @@ struct RigidBodies
     Vec2f *forces;
     bool *deleted;
     bool *disabled;
+
+    // Scratch space of rigid_bodies_collide
+    RigidBodyId *parents;
+    SweepEntry *sweep;
+    RigidBodyId *island_bodies;
+    size_t *island_of_root;
+    size_t *island_begins;
+    size_t *batch_begins;
 };
 
 RigidBodies *create_rigid_bodies(size_t capacity)
@@ -77,6 +98,36 @@ RigidBodies *create_rigid_bodies(size_t capacity)
         RETURN_LT(lt, NULL);
     }
 
+    rigid_bodies->parents = PUSH_LT(lt, nth_calloc(capacity, sizeof(RigidBodyId)), free);
+    if (rigid_bodies->parents == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+
+    rigid_bodies->sweep = PUSH_LT(lt, nth_calloc(capacity, sizeof(SweepEntry)), free);
+    if (rigid_bodies->sweep == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+
+    rigid_bodies->island_bodies = PUSH_LT(lt, nth_calloc(capacity, sizeof(RigidBodyId)), free);
+    if (rigid_bodies->island_bodies == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+
+    rigid_bodies->island_of_root = PUSH_LT(lt, nth_calloc(capacity, sizeof(size_t)), free);
+    if (rigid_bodies->island_of_root == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+
+    rigid_bodies->island_begins = PUSH_LT(lt, nth_calloc(capacity + 1, sizeof(size_t)), free);
+    if (rigid_bodies->island_begins == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+
+    rigid_bodies->batch_begins = PUSH_LT(lt, nth_calloc(capacity + 1, sizeof(size_t)), free);
+    if (rigid_bodies->batch_begins == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+
     return rigid_bodies;
 }
 
@@ -86,27 +137,30 @@ void destroy_rigid_bodies(RigidBodies *rigid_bodies)
     RETURN_LT0(rigid_bodies->lt);
 }
 
-int rigid_bodies_collide(RigidBodies *rigid_bodies,
-                         const Platforms *platforms)
+static
+bool rigid_bodies_active(const RigidBodies *rigid_bodies, RigidBodyId id)
 {
-    memset(rigid_bodies->grounded, 0, sizeof(bool) * rigid_bodies->count);
-
-    if (rigid_bodies->count == 0) {
-        return 0;
-    }
+    return !rigid_bodies->deleted[id] && !rigid_bodies->disabled[id];
+}
 
+// Relaxation of a single contact island. ids are sorted, so the bodies
+// are visited in the same order as if the whole world was relaxed at
+// once.
+static
+void rigid_bodies_relax_island(RigidBodies *rigid_bodies,
+                               const Platforms *platforms,
+                               const RigidBodyId *ids,
+                               size_t ids_count)
+{
     int sides[RECT_SIDE_N] = { 0, 0, 0, 0 };
 
-
-    int t = 100;
+    int t = cvar_relaxation_steps.int_value;
     int the_variable_that_gets_set_when_a_collision_happens_xd = 1;
     while (t-- > 0 && the_variable_that_gets_set_when_a_collision_happens_xd) {
         the_variable_that_gets_set_when_a_collision_happens_xd = 0;
 
-        for (size_t i1 = 0; i1 < rigid_bodies->count; ++i1) {
-            if (rigid_bodies->deleted[i1] || rigid_bodies->disabled[i1]) {
-                continue;
-            }
+        for (size_t j1 = 0; j1 < ids_count; ++j1) {
+            const RigidBodyId i1 = ids[j1];
 
             // Platforms
             memset(sides, 0, sizeof(int) * RECT_SIDE_N);
@@ -128,15 +182,9 @@ int rigid_bodies_collide(RigidBodies *rigid_bodies,
             rigid_bodies->movements[i1] = vec_entry_mult(rigid_bodies->movements[i1], v);
             rigid_bodies_damper(rigid_bodies, i1, vec_entry_mult(v, vec(-16.0f, 0.0f)));
 
-            if (i1 >= rigid_bodies->count - 1) {
-                continue;
-            }
-
             // Self-collision
-            for (size_t i2 = i1 + 1; i2 < rigid_bodies->count; ++i2) {
-                if (rigid_bodies->deleted[i2] || rigid_bodies->disabled[i1]) {
-                    continue;
-                }
+            for (size_t j2 = j1 + 1; j2 < ids_count; ++j2) {
+                const RigidBodyId i2 = ids[j2];
 
                 if (!rects_overlap(rigid_bodies->bodies[i1], rigid_bodies->bodies[i2])) {
                     continue;
@@ -161,6 +209,194 @@ int rigid_bodies_collide(RigidBodies *rigid_bodies,
             }
         }
     }
+}
+
+static
+RigidBodyId rigid_bodies_find_root(RigidBodies *rigid_bodies, RigidBodyId id)
+{
+    while (rigid_bodies->parents[id] != id) {
+        rigid_bodies->parents[id] = rigid_bodies->parents[rigid_bodies->parents[id]];
+        id = rigid_bodies->parents[id];
+    }
+    return id;
+}
+
+// The smallest id always becomes the root, so the islands don't depend
+// on the order the pairs are found in
+static
+void rigid_bodies_union(RigidBodies *rigid_bodies, RigidBodyId a, RigidBodyId b)
+{
+    a = rigid_bodies_find_root(rigid_bodies, a);
+    b = rigid_bodies_find_root(rigid_bodies, b);
+    if (a < b) {
+        rigid_bodies->parents[b] = a;
+    } else if (b < a) {
+        rigid_bodies->parents[a] = b;
+    }
+}
+
+static
+int compare_sweep_entries(const void *a, const void *b)
+{
+    const SweepEntry *entry_a = a;
+    const SweepEntry *entry_b = b;
+
+    if (entry_a->x < entry_b->x) return -1;
+    if (entry_a->x > entry_b->x) return 1;
+    if (entry_a->id < entry_b->id) return -1;
+    if (entry_a->id > entry_b->id) return 1;
+    return 0;
+}
+
+// Broad phase: sweep along the x axis and join every pair of bodies
+// that are within RIGID_BODIES_ISLAND_MARGIN of each other.
+//
+// Returns the amount of islands. The bodies of the island i are
+// island_bodies[island_begins[i] .. island_begins[i + 1]]
+static
+size_t rigid_bodies_build_islands(RigidBodies *rigid_bodies)
+{
+    size_t active_count = 0;
+    for (RigidBodyId id = 0; id < rigid_bodies->count; ++id) {
+        rigid_bodies->parents[id] = id;
+        if (rigid_bodies_active(rigid_bodies, id)) {
+            rigid_bodies->sweep[active_count].x = rigid_bodies->bodies[id].x;
+            rigid_bodies->sweep[active_count].id = id;
+            active_count++;
+        }
+    }
+
+    qsort(rigid_bodies->sweep, active_count, sizeof(SweepEntry),
+          compare_sweep_entries);
+
+    const float margin = RIGID_BODIES_ISLAND_MARGIN;
+    for (size_t j1 = 0; j1 < active_count; ++j1) {
+        const Rect r1 = rigid_bodies->bodies[rigid_bodies->sweep[j1].id];
+        for (size_t j2 = j1 + 1; j2 < active_count; ++j2) {
+            const Rect r2 = rigid_bodies->bodies[rigid_bodies->sweep[j2].id];
+            if (r2.x > r1.x + r1.w + margin) {
+                break;
+            }
+
+            if (r2.y <= r1.y + r1.h + margin && r1.y <= r2.y + r2.h + margin) {
+                rigid_bodies_union(
+                    rigid_bodies,
+                    rigid_bodies->sweep[j1].id,
+                    rigid_bodies->sweep[j2].id);
+            }
+        }
+    }
+
+    // Counting sort of the bodies by island. Islands are numbered in
+    // the order of their smallest id and keep their bodies sorted.
+    size_t islands_count = 0;
+    for (RigidBodyId id = 0; id < rigid_bodies->count; ++id) {
+        if (!rigid_bodies_active(rigid_bodies, id)) {
+            continue;
+        }
+
+        const RigidBodyId root = rigid_bodies_find_root(rigid_bodies, id);
+        rigid_bodies->parents[id] = root;
+        if (root == id) {
+            rigid_bodies->island_of_root[root] = islands_count;
+            rigid_bodies->island_begins[islands_count++] = 0;
+        }
+        rigid_bodies->island_begins[rigid_bodies->island_of_root[root]]++;
+    }
+
+    size_t begin = 0;
+    for (size_t i = 0; i < islands_count; ++i) {
+        const size_t size = rigid_bodies->island_begins[i];
+        rigid_bodies->island_begins[i] = begin;
+        begin += size;
+    }
+    rigid_bodies->island_begins[islands_count] = begin;
+
+    for (RigidBodyId id = 0; id < rigid_bodies->count; ++id) {
+        if (!rigid_bodies_active(rigid_bodies, id)) {
+            continue;
+        }
+
+        // Every body points straight to its root after the loop above
+        const size_t island = rigid_bodies->island_of_root[rigid_bodies->parents[id]];
+        rigid_bodies->island_bodies[rigid_bodies->island_begins[island]++] = id;
+    }
+
+    // The loop above shifted every begin to the next island
+    for (size_t i = islands_count; i > 0; --i) {
+        rigid_bodies->island_begins[i] = rigid_bodies->island_begins[i - 1];
+    }
+    rigid_bodies->island_begins[0] = 0;
+
+    return islands_count;
+}
+
+typedef struct {
+    RigidBodies *rigid_bodies;
+    const Platforms *platforms;
+} RigidBodiesCollideJob;
+
+static
+void rigid_bodies_collide_job(void *data, size_t begin, size_t end)
+{
+    RigidBodiesCollideJob *collide_job = data;
+    trace_assert(collide_job);
+    RigidBodies *rigid_bodies = collide_job->rigid_bodies;
+
+    for (size_t batch = begin; batch < end; ++batch) {
+        for (size_t island = rigid_bodies->batch_begins[batch];
+             island < rigid_bodies->batch_begins[batch + 1];
+             ++island) {
+            const size_t island_begin = rigid_bodies->island_begins[island];
+            const size_t island_end = rigid_bodies->island_begins[island + 1];
+            rigid_bodies_relax_island(
+                rigid_bodies,
+                collide_job->platforms,
+                rigid_bodies->island_bodies + island_begin,
+                island_end - island_begin);
+        }
+    }
+}
+
+int rigid_bodies_collide(RigidBodies *rigid_bodies,
+                         const Platforms *platforms,
+                         Jobs *jobs)
+{
+    trace_assert(rigid_bodies);
+    trace_assert(platforms);
+
+    memset(rigid_bodies->grounded, 0, sizeof(bool) * rigid_bodies->count);
+
+    if (rigid_bodies->count == 0) {
+        return 0;
+    }
+
+    // Bodies that can't reach each other can't affect each other
+    // either, so every island is relaxed on its own. The islands do
+    // not depend on the amount of workers and they are relaxed the
+    // same way with no pool at all, which keeps the result the same no
+    // matter how many threads there are (see tools/check_physics.c).
+    const size_t islands_count = rigid_bodies_build_islands(rigid_bodies);
+
+    size_t batches_count = 0;
+    size_t batch_size = 0;
+    for (size_t island = 0; island < islands_count; ++island) {
+        if (batch_size == 0) {
+            rigid_bodies->batch_begins[batches_count++] = island;
+        }
+
+        batch_size += rigid_bodies->island_begins[island + 1] - rigid_bodies->island_begins[island];
+        if (batch_size >= RIGID_BODIES_ISLAND_BATCH_SIZE) {
+            batch_size = 0;
+        }
+    }
+    rigid_bodies->batch_begins[batches_count] = islands_count;
+
+    RigidBodiesCollideJob collide_job = {
+        .rigid_bodies = rigid_bodies,
+        .platforms = platforms
+    };
+    jobs_parallel_for(jobs, rigid_bodies_collide_job, &collide_job, batches_count, 1);
 
     return 0;
 }
@@ -202,7 +438,7 @@ int rigid_bodies_update(RigidBodies *rigid_bodies,
 
 int rigid_bodies_render(RigidBodies *rigid_bodies,
                         RigidBodyId id,
-                        Color color,
+                        PackedColor color,
                         const Camera *camera)
 {
     trace_assert(rigid_bodies);
@@ -214,7 +450,7 @@ int rigid_bodies_render(RigidBodies *rigid_bodies,
 
     char text_buffer[256];
 
-    if (camera_fill_rect(
+    if (camera_fill_rect_packed(
             camera,
             rigid_bodies->bodies[id],
             color) < 0) {
@@ -253,6 +489,12 @@ RigidBodyId rigid_bodies_add(RigidBodies *rigid_bodies,
     return id;
 }
 
+size_t rigid_bodies_capacity_left(const RigidBodies *rigid_bodies)
+{
+    trace_assert(rigid_bodies);
+    return rigid_bodies->capacity - rigid_bodies->count;
+}
+
 void rigid_bodies_remove(RigidBodies *rigid_bodies,
                          RigidBodyId id)
 {
@@ -374,3 +616,20 @@ void rigid_bodies_disable(RigidBodies *rigid_bodies,
 
     rigid_bodies->disabled[id] = disabled;
 }
+
+void rigid_bodies_snapshot(RigidBodies *rigid_bodies, Snapshot *snapshot)
+{
+    trace_assert(rigid_bodies);
+    trace_assert(snapshot);
+
+    // Bodies can be added at runtime, so the arrays are captured up to
+    // the capacity, which keeps the size of the snapshot fixed
+    SNAPSHOT_FIELD(snapshot, rigid_bodies->count);
+    SNAPSHOT_ARRAY(snapshot, rigid_bodies->bodies, rigid_bodies->capacity);
+    SNAPSHOT_ARRAY(snapshot, rigid_bodies->velocities, rigid_bodies->capacity);
+    SNAPSHOT_ARRAY(snapshot, rigid_bodies->movements, rigid_bodies->capacity);
+    SNAPSHOT_ARRAY(snapshot, rigid_bodies->grounded, rigid_bodies->capacity);
+    SNAPSHOT_ARRAY(snapshot, rigid_bodies->forces, rigid_bodies->capacity);
+    SNAPSHOT_ARRAY(snapshot, rigid_bodies->deleted, rigid_bodies->capacity);
+    SNAPSHOT_ARRAY(snapshot, rigid_bodies->disabled, rigid_bodies->capacity);
+}
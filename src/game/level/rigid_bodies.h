@@ -2,6 +2,8 @@
 #define RIGID_BODIES_H_
 
 #include "math/mat3x3.h"
+#include "system/jobs.h"
+#include "game/level/snapshot.h"
 
 typedef struct RigidBodies RigidBodies;
 typedef struct Platforms Platforms;
@@ -12,7 +14,8 @@ RigidBodies *create_rigid_bodies(size_t capacity);
 void destroy_rigid_bodies(RigidBodies *rigid_bodies);
 
 int rigid_bodies_collide(RigidBodies *rigid_bodies,
-                         const Platforms *platforms);
+                         const Platforms *platforms,
+                         Jobs *jobs);
 
 int rigid_bodies_update(RigidBodies *rigid_bodies,
                         RigidBodyId id,
@@ -20,10 +23,13 @@ int rigid_bodies_update(RigidBodies *rigid_bodies,
 
 int rigid_bodies_render(RigidBodies *rigid_bodies,
                         RigidBodyId id,
-                        Color color,
+                        PackedColor color,
                         const Camera *camera);
 RigidBodyId rigid_bodies_add(RigidBodies *rigid_bodies,
                              Rect rect);
+// How many more bodies can be added. The ids of the removed bodies
+// are not reused.
+size_t rigid_bodies_capacity_left(const RigidBodies *rigid_bodies);
 void rigid_bodies_remove(RigidBodies *rigid_bodies,
                          RigidBodyId id);
 
@@ -60,4 +66,6 @@ void rigid_bodies_disable(RigidBodies *rigid_bodies,
                           RigidBodyId id,
                           bool disabled);
 
+void rigid_bodies_snapshot(RigidBodies *rigid_bodies, Snapshot *snapshot);
+
 #endif  // RIGID_BODIES_H_
@@ -0,0 +1,89 @@
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include "system/stacktrace.h"
+
+// Contiguous copy of the mutable runtime state of a Level.
+//
+// Every subsystem has a single <entity>_snapshot(entity, snapshot)
+// function that passes all of its mutable fields to snapshot_bytes.
+// Depending on the mode the same function measures, saves or
+// restores the state, so the layout can't get out of sync.
+typedef enum {
+    SNAPSHOT_MEASURE = 0,
+    SNAPSHOT_SAVE,
+    SNAPSHOT_RESTORE
+} SnapshotMode;
+
+typedef struct {
+    SnapshotMode mode;
+    uint8_t *output;
+    const uint8_t *input;
+    size_t capacity;
+    size_t size;
+} Snapshot;
+
+static inline
+Snapshot snapshot_measure(void)
+{
+    Snapshot result = {
+        .mode = SNAPSHOT_MEASURE
+    };
+    return result;
+}
+
+static inline
+Snapshot snapshot_save(void *buffer, size_t capacity)
+{
+    Snapshot result = {
+        .mode = SNAPSHOT_SAVE,
+        .output = buffer,
+        .capacity = capacity
+    };
+    return result;
+}
+
+static inline
+Snapshot snapshot_restore(const void *buffer, size_t capacity)
+{
+    Snapshot result = {
+        .mode = SNAPSHOT_RESTORE,
+        .input = buffer,
+        .capacity = capacity
+    };
+    return result;
+}
+
+static inline
+void snapshot_bytes(Snapshot *snapshot, void *field, size_t size)
+{
+    trace_assert(snapshot);
+    trace_assert(field || size == 0);
+
+    switch (snapshot->mode) {
+    case SNAPSHOT_MEASURE: break;
+
+    case SNAPSHOT_SAVE: {
+        trace_assert(snapshot->size + size <= snapshot->capacity);
+        memcpy(snapshot->output + snapshot->size, field, size);
+    } break;
+
+    case SNAPSHOT_RESTORE: {
+        trace_assert(snapshot->size + size <= snapshot->capacity);
+        memcpy(field, snapshot->input + snapshot->size, size);
+    } break;
+    }
+
+    snapshot->size += size;
+}
+
+#define SNAPSHOT_FIELD(snapshot, field) \
+    snapshot_bytes(snapshot, &(field), sizeof(field))
+
+#define SNAPSHOT_ARRAY(snapshot, array, count) \
+    snapshot_bytes(snapshot, array, sizeof((array)[0]) * (count))
+
+#endif  // SNAPSHOT_H_
@@ -1,4 +1,7 @@
+#include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "./level_picker.h"
 
@@ -16,11 +19,88 @@
 #define LEVEL_PICKER_LIST_FONT_SCALE vec(5.0f, 5.0f)
 #define LEVEL_PICKER_LIST_PADDING_BOTTOM 50.0f
 
+#define LEVEL_PICKER_SEARCH_FONT_SCALE vec(3.0f, 3.0f)
+#define LEVEL_PICKER_SEARCH_MARGIN_BOTTOM 20.0f
+
 #define ITEM_HEIGHT (FONT_CHAR_HEIGHT * LEVEL_PICKER_LIST_FONT_SCALE.y + LEVEL_PICKER_LIST_PADDING_BOTTOM)
 
 #define SCROLLBAR_WIDTH 20
+#define THUMBNAIL_MARGIN_RIGHT 30.0f
 #define SCROLLING_SPEED_FRACTION 0.25f
 
+// No screen fits more rows than that
+#define LEVEL_PICKER_VISIBLE_ROWS_CAPACITY 64
+#define LEVEL_PICKER_INITIAL_CAPACITY 256
+
+static
+void level_picker_push_item(LevelPicker *level_picker, const char *path)
+{
+    const size_t n = strlen(path) + 1;
+
+    if (level_picker->paths_size + n > level_picker->paths_capacity) {
+        size_t capacity = level_picker->paths_capacity > 0
+            ? level_picker->paths_capacity
+            : LEVEL_PICKER_INITIAL_CAPACITY * METADATA_FILEPATH_MAX_SIZE;
+        while (level_picker->paths_size + n > capacity) {
+            capacity *= 2;
+        }
+        level_picker->paths = realloc(level_picker->paths, capacity);
+        trace_assert(level_picker->paths);
+        level_picker->paths_capacity = capacity;
+    }
+
+    if (level_picker->items_count >= level_picker->items_capacity) {
+        level_picker->items_capacity = level_picker->items_capacity > 0
+            ? level_picker->items_capacity * 2
+            : LEVEL_PICKER_INITIAL_CAPACITY;
+        level_picker->items = realloc(
+            level_picker->items,
+            level_picker->items_capacity * sizeof(size_t));
+        trace_assert(level_picker->items);
+    }
+
+    memcpy(level_picker->paths + level_picker->paths_size, path, n);
+    level_picker->items[level_picker->items_count++] = level_picker->paths_size;
+    level_picker->paths_size += n;
+}
+
+static inline
+size_t level_picker_rows_count(const LevelPicker *level_picker)
+{
+    return level_picker->search.matches_count;
+}
+
+// The item shown in the row of the list
+static inline
+size_t level_picker_row_item(const LevelPicker *level_picker, size_t row)
+{
+    trace_assert(row < level_picker->search.matches_count);
+    return level_picker->search.matches[row].index;
+}
+
+static inline
+const char *level_picker_item_path(const LevelPicker *level_picker, size_t item)
+{
+    trace_assert(item < level_picker->items_count);
+    return level_picker->paths + level_picker->items[item];
+}
+
+// The first row that is at least partially scrolled into the view
+static
+size_t level_picker_first_visible_row(const LevelPicker *level_picker)
+{
+    const float row = floorf(-level_picker->items_scroll.y / ITEM_HEIGHT);
+    return row > 0.0f ? (size_t) row : 0;
+}
+
+static
+float level_picker_scrolling_area_height(const LevelPicker *level_picker,
+                                         const Camera *camera)
+{
+    const Rect viewport = camera_view_port_screen(camera);
+    return viewport.h - ITEM_HEIGHT - level_picker->items_position.y;
+}
+
 void level_picker_populate(LevelPicker *level_picker,
                            const char *dirpath)
 {
@@ -31,8 +111,13 @@ void level_picker_populate(LevelPicker *level_picker,
     level_picker->camera_position = vec(0.0f, 0.0f);
 
     {
-        dynarray_clear(&level_picker->items);
-        level_picker->items = create_dynarray_malloc(METADATA_FILEPATH_MAX_SIZE);
+        if (level_picker->thumbnails != NULL) {
+            destroy_level_thumbnails(level_picker->thumbnails);
+            level_picker->thumbnails = NULL;
+        }
+        destroy_fuzzy_search(&level_picker->search);
+        level_picker->paths_size = 0;
+        level_picker->items_count = 0;
 
         DIR *level_dir = opendir(dirpath);
         if (level_dir == NULL) {
@@ -48,10 +133,41 @@ void level_picker_populate(LevelPicker *level_picker,
 
             snprintf(filepath, METADATA_FILEPATH_MAX_SIZE,
                      "%s/%s", dirpath, d->d_name);
-            dynarray_push(&level_picker->items, filepath);
+            level_picker_push_item(level_picker, filepath);
         }
         closedir(level_dir);
+
+        if (create_fuzzy_search(
+                &level_picker->search,
+                level_picker->paths,
+                level_picker->items,
+                level_picker->items_count) < 0) {
+            abort();
+        }
+        edit_field_clean(&level_picker->search_field);
+        edit_field_restyle(&level_picker->search_field,
+                           LEVEL_PICKER_SEARCH_FONT_SCALE,
+                           COLOR_WHITE);
+        level_picker->searching = false;
+
+        // Starts with a dot, so it is not listed above
+        snprintf(filepath, METADATA_FILEPATH_MAX_SIZE, "%s/.thumbnails", dirpath);
+        level_picker->thumbnails = create_level_thumbnails(
+            level_picker->paths,
+            level_picker->items,
+            level_picker->items_count,
+            filepath);
+    }
+
+    // The list is as wide as the longest path, so it does not jump
+    // around while searching
+    size_t longest = 0;
+    for (size_t i = 0; i < level_picker->items_count; ++i) {
+        const size_t n = strlen(level_picker_item_path(level_picker, i));
+        longest = n > longest ? n : longest;
     }
+    level_picker->items_size.x = (float) longest * FONT_CHAR_WIDTH * LEVEL_PICKER_LIST_FONT_SCALE.x;
+    level_picker->items_size.y = (float) level_picker->items_count * ITEM_HEIGHT;
 
     level_picker->wiggly_text = (WigglyText) {
         .text = "Select Level",
@@ -72,18 +188,58 @@ int level_picker_render(const LevelPicker *level_picker,
     }
 
     const Vec2f title_size = wiggly_text_size(&level_picker->wiggly_text);
-    const float scrolling_area_height = viewport.h - ITEM_HEIGHT - level_picker->items_position.y;
+    const float scrolling_area_height = level_picker_scrolling_area_height(level_picker, camera);
+    const size_t rows_count = level_picker_rows_count(level_picker);
 
     wiggly_text_render(
         &level_picker->wiggly_text,
         camera,
         vec(viewport.w * 0.5f - title_size.x * 0.5f, TITLE_MARGIN_TOP));
 
-    const float proportional_scroll = level_picker->items_scroll.y * scrolling_area_height / level_picker->items_size.y;
+    if (level_picker->searching || level_picker->search.query_size > 0) {
+        /* CSS */
+        const char *label = "Search: ";
+        const Vec2f position = vec(
+            level_picker->items_position.x,
+            level_picker->items_position.y
+            - FONT_CHAR_HEIGHT * LEVEL_PICKER_SEARCH_FONT_SCALE.y
+            - LEVEL_PICKER_SEARCH_MARGIN_BOTTOM);
+        const float label_width =
+            (float) strlen(label) * FONT_CHAR_WIDTH * LEVEL_PICKER_SEARCH_FONT_SCALE.x;
+
+        /* HTML */
+        camera_render_text_screen(
+            camera,
+            label,
+            LEVEL_PICKER_SEARCH_FONT_SCALE,
+            COLOR_WHITE,
+            position);
+
+        if (level_picker->searching) {
+            if (edit_field_render_screen(
+                    &level_picker->search_field,
+                    camera,
+                    vec(position.x + label_width, position.y)) < 0) {
+                return -1;
+            }
+        } else {
+            camera_render_text_screen(
+                camera,
+                edit_field_as_text(&level_picker->search_field),
+                LEVEL_PICKER_SEARCH_FONT_SCALE,
+                COLOR_WHITE,
+                vec(position.x + label_width, position.y));
+        }
+    }
+
+    const float items_height = (float) rows_count * ITEM_HEIGHT;
+    const float proportional_scroll = items_height > 0.0f
+        ? level_picker->items_scroll.y * scrolling_area_height / items_height
+        : 0.0f;
     const float number_of_items_in_scrolling_area = scrolling_area_height / ITEM_HEIGHT;
-    const float percent_of_visible_items = number_of_items_in_scrolling_area / ((float) level_picker->items.count - 1);
+    const float percent_of_visible_items = number_of_items_in_scrolling_area / ((float) rows_count - 1);
 
-    if(level_picker->items.count > 0 && percent_of_visible_items < 1) {
+    if(rows_count > 1 && percent_of_visible_items < 1) {
         SDL_Rect scrollbar = rect_for_sdl(
             rect_from_vecs(
                 vec(level_picker->items_position.x + level_picker->items_size.x, level_picker->items_position.y),
@@ -107,17 +263,38 @@ int level_picker_render(const LevelPicker *level_picker,
         }
     }
 
-    for (size_t i = 0; i < level_picker->items.count; ++i) {
+    for (size_t row = level_picker_first_visible_row(level_picker); row < rows_count; ++row) {
         const Vec2f current_position = vec_sum(
             level_picker->items_position,
-            vec(0.0f, (float) i * ITEM_HEIGHT + level_picker->items_scroll.y));
+            vec(0.0f, (float) row * ITEM_HEIGHT + level_picker->items_scroll.y));
 
-        if(current_position.y > level_picker->items_position.y + scrolling_area_height ||
-            current_position.y < level_picker->items_position.y) {
+        if (current_position.y > level_picker->items_position.y + scrolling_area_height) {
+            break;
+        }
+
+        if (current_position.y < level_picker->items_position.y) {
             continue;
         }
 
-        const char *item_text = dynarray_pointer_at(&level_picker->items, i);
+        const size_t item = level_picker_row_item(level_picker, row);
+        const char *item_text = level_picker_item_path(level_picker, item);
+
+        SDL_Texture *thumbnail = level_picker->thumbnails != NULL
+            ? level_thumbnails_texture(level_picker->thumbnails, item)
+            : NULL;
+        if (thumbnail != NULL) {
+            // Vertically centered on the text
+            const SDL_Rect dest = rect_for_sdl(
+                rect(
+                    current_position.x - LEVEL_THUMBNAIL_WIDTH - THUMBNAIL_MARGIN_RIGHT,
+                    current_position.y
+                    + (FONT_CHAR_HEIGHT * LEVEL_PICKER_LIST_FONT_SCALE.y - LEVEL_THUMBNAIL_HEIGHT) * 0.5f,
+                    LEVEL_THUMBNAIL_WIDTH,
+                    LEVEL_THUMBNAIL_HEIGHT));
+            if (SDL_RenderCopy(camera->renderer, thumbnail, NULL, &dest) < 0) {
+                return -1;
+            }
+        }
 
         sprite_font_render_text(
             &camera->font,
@@ -127,7 +304,7 @@ int level_picker_render(const LevelPicker *level_picker,
             rgba(1.0f, 1.0f, 1.0f, 1.0f),
             item_text);
 
-        if (i == level_picker->items_cursor) {
+        if (row == level_picker->items_cursor) {
             SDL_Rect boundary_box = rect_for_sdl(
                 sprite_font_boundary_box(
                     current_position,
@@ -152,7 +329,7 @@ int level_picker_render(const LevelPicker *level_picker,
         /* HTML */
         camera_render_text_screen(
             camera,
-            "Press 'N' to create new level",
+            "Press 'N' to create new level, '/' to search",
             size,
             COLOR_WHITE,
             vec(position.x + padding,
@@ -164,12 +341,12 @@ int level_picker_render(const LevelPicker *level_picker,
 
 int level_picker_update(LevelPicker *level_picker,
                         Camera *camera,
+                        Jobs *jobs,
                         float delta_time)
 {
     trace_assert(level_picker);
 
-    const Rect viewport = camera_view_port_screen(camera);
-    const float scrolling_area_height = viewport.h - ITEM_HEIGHT - level_picker->items_position.y;
+    const float scrolling_area_height = level_picker_scrolling_area_height(level_picker, camera);
 
     if ((float) level_picker->items_cursor * ITEM_HEIGHT + level_picker->items_scroll.y > scrolling_area_height) {
         level_picker->items_scroll.y -= ITEM_HEIGHT * SCROLLING_SPEED_FRACTION;
@@ -178,6 +355,28 @@ int level_picker_update(LevelPicker *level_picker,
         level_picker->items_scroll.y += ITEM_HEIGHT * SCROLLING_SPEED_FRACTION;
     }
 
+    if (level_picker->thumbnails != NULL) {
+        // The visible rows get their thumbnails first
+        size_t visible[LEVEL_PICKER_VISIBLE_ROWS_CAPACITY];
+        size_t visible_count = 0;
+        const size_t rows_count = level_picker_rows_count(level_picker);
+        for (size_t row = level_picker_first_visible_row(level_picker);
+             row < rows_count && visible_count < LEVEL_PICKER_VISIBLE_ROWS_CAPACITY;
+             ++row) {
+            if ((float) row * ITEM_HEIGHT + level_picker->items_scroll.y > scrolling_area_height) {
+                break;
+            }
+            visible[visible_count++] = level_picker_row_item(level_picker, row);
+        }
+
+        level_thumbnails_update(
+            level_picker->thumbnails,
+            jobs,
+            camera->renderer,
+            visible,
+            visible_count);
+    }
+
     vec_add(&level_picker->camera_position,
             vec(50.0f * delta_time, 0.0f));
 
@@ -189,29 +388,68 @@ int level_picker_update(LevelPicker *level_picker,
 }
 
 static
-Vec2f level_picker_list_size(const LevelPicker *level_picker)
+void level_picker_search(LevelPicker *level_picker)
 {
-    trace_assert(level_picker);
+    const size_t matches_count = level_picker->search.matches_count;
+    const size_t query_size = level_picker->search.query_size;
+
+    fuzzy_search_update(
+        &level_picker->search,
+        edit_field_as_text(&level_picker->search_field));
+
+    if (matches_count != level_picker->search.matches_count ||
+        query_size != level_picker->search.query_size) {
+        // The best match is on the top
+        level_picker->items_cursor = 0;
+        level_picker->items_scroll.y = 0.0f;
+    }
+}
 
-    Vec2f result = vec(0.0f, 0.0f);
+static
+int level_picker_search_event(LevelPicker *level_picker,
+                              const SDL_Event *event)
+{
+    switch (event->type) {
+    case SDL_KEYDOWN: {
+        switch (event->key.keysym.sym) {
+        case SDLK_ESCAPE: {
+            SDL_StopTextInput();
+            level_picker->searching = false;
+            edit_field_clean(&level_picker->search_field);
+            level_picker_search(level_picker);
+            return 0;
+        }
 
-    for (size_t i = 0; i < level_picker->items.count; ++i) {
-        const char *item_text = dynarray_pointer_at(
-            &level_picker->items,
-            i);
+        case SDLK_RETURN: {
+            SDL_StopTextInput();
+            level_picker->searching = false;
+            if (level_picker->items_cursor < level_picker_rows_count(level_picker)) {
+                level_picker->selected_item =
+                    (int) level_picker_row_item(level_picker, level_picker->items_cursor);
+            }
+            return 0;
+        }
 
-        Rect boundary_box = sprite_font_boundary_box(
-            vec(0.0f, 0.0f),
-            LEVEL_PICKER_LIST_FONT_SCALE,
-            item_text);
+        case SDLK_UP: {
+            level_picker_cursor_up(level_picker);
+            return 0;
+        }
 
-        result.x = fmaxf(result.x, boundary_box.w);
-        result.y += boundary_box.h + LEVEL_PICKER_LIST_PADDING_BOTTOM;
+        case SDLK_DOWN: {
+            level_picker_cursor_down(level_picker);
+            return 0;
+        }
+        }
+    } break;
     }
 
-    return result;
-}
+    if (edit_field_event(&level_picker->search_field, event) < 0) {
+        return -1;
+    }
+    level_picker_search(level_picker);
 
+    return 0;
+}
 
 int level_picker_event(LevelPicker *level_picker,
                        const SDL_Event *event)
@@ -219,6 +457,15 @@ int level_picker_event(LevelPicker *level_picker,
     trace_assert(level_picker);
     trace_assert(event);
 
+    if (level_picker->searching) {
+        switch (event->type) {
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+        case SDL_TEXTINPUT:
+            return level_picker_search_event(level_picker, event);
+        }
+    }
+
     switch (event->type) {
     case SDL_WINDOWEVENT: {
         switch (event->window.event) {
@@ -227,7 +474,6 @@ int level_picker_event(LevelPicker *level_picker,
             int width;
             SDL_GetRendererOutputSize(SDL_GetRenderer(SDL_GetWindowFromID(event->window.windowID)), &width, NULL);
             const Vec2f title_size = wiggly_text_size(&level_picker->wiggly_text);
-            level_picker->items_size = level_picker_list_size(level_picker);
 
             level_picker->items_position =
                 vec((float)width * 0.5f - level_picker->items_size.x * 0.5f,
@@ -239,13 +485,25 @@ int level_picker_event(LevelPicker *level_picker,
     case SDL_KEYDOWN: {
         switch (event->key.keysym.sym) {
         case SDLK_RETURN: {
-            if (level_picker->items_cursor < level_picker->items.count) {
-                level_picker->selected_item = (int) level_picker->items_cursor;
+            if (level_picker->items_cursor < level_picker_rows_count(level_picker)) {
+                level_picker->selected_item =
+                    (int) level_picker_row_item(level_picker, level_picker->items_cursor);
             }
         } break;
         }
     } break;
 
+    case SDL_KEYUP: {
+        // On the key up, so the slash itself does not end up in the
+        // query
+        switch (event->key.keysym.sym) {
+        case SDLK_SLASH: {
+            SDL_StartTextInput();
+            level_picker->searching = true;
+        } break;
+        }
+    } break;
+
     case SDL_MOUSEWHEEL: {
         if (event->wheel.y < 0) {
             level_picker_cursor_down(level_picker);
@@ -257,26 +515,28 @@ int level_picker_event(LevelPicker *level_picker,
     case SDL_MOUSEBUTTONDOWN: {
         switch (event->button.button) {
         case SDL_BUTTON_LEFT: {
+            // All the rows are ITEM_HEIGHT high, so the row under the
+            // mouse is found right away
             const Vec2f mouse_pos = vec((float) event->button.x, (float) event->button.y);
-            Vec2f position = vec_sum(
-                level_picker->items_position,
-                level_picker->items_scroll);
-
-            for (size_t i = 0; i < level_picker->items.count; ++i) {
-                const char *item_text = dynarray_pointer_at(
-                    &level_picker->items,
-                    i);
-
-                Rect boundary_box = sprite_font_boundary_box(
-                    position,
-                    LEVEL_PICKER_LIST_FONT_SCALE,
-                    item_text);
+            const float row = floorf(
+                (mouse_pos.y - level_picker->items_position.y - level_picker->items_scroll.y)
+                / ITEM_HEIGHT);
+            if (row < 0.0f || (size_t) row >= level_picker_rows_count(level_picker)) {
+                break;
+            }
 
-                if (rect_contains_point(boundary_box, mouse_pos)) {
-                    level_picker->items_cursor = i;
-                }
+            const Vec2f position = vec_sum(
+                level_picker->items_position,
+                vec(0.0f, row * ITEM_HEIGHT + level_picker->items_scroll.y));
+            Rect boundary_box = sprite_font_boundary_box(
+                position,
+                LEVEL_PICKER_LIST_FONT_SCALE,
+                level_picker_item_path(
+                    level_picker,
+                    level_picker_row_item(level_picker, (size_t) row)));
 
-                position.y += boundary_box.h + LEVEL_PICKER_LIST_PADDING_BOTTOM;
+            if (rect_contains_point(boundary_box, mouse_pos)) {
+                level_picker->items_cursor = (size_t) row;
             }
         } break;
         }
@@ -288,32 +548,24 @@ int level_picker_event(LevelPicker *level_picker,
             // check if the click position was actually inside...
             // note: make sure there's actually stuff in the list! tsoding likes
             // to remove all levels and change title to "SMOL BREAK"...
-            if (level_picker->items.count == 0)
+            if (level_picker->items_cursor >= level_picker_rows_count(level_picker))
                 break;
 
-            // note: this assumes that all list items are the same height!
-            // this is probably a valid assumption as long as we use a sprite font.
-            float single_item_height =
-                FONT_CHAR_HEIGHT * LEVEL_PICKER_LIST_FONT_SCALE.y + LEVEL_PICKER_LIST_PADDING_BOTTOM;
-
             Vec2f position = vec_sum(
                 level_picker->items_position,
                 level_picker->items_scroll);
-            vec_add(&position, vec(0.0f, (float) level_picker->items_cursor * single_item_height));
+            vec_add(&position, vec(0.0f, (float) level_picker->items_cursor * ITEM_HEIGHT));
 
-            const char *item_text =
-                dynarray_pointer_at(
-                    &level_picker->items,
-                    level_picker->items_cursor);
+            const size_t item = level_picker_row_item(level_picker, level_picker->items_cursor);
 
             Rect boundary_box = sprite_font_boundary_box(
                 position,
                 LEVEL_PICKER_LIST_FONT_SCALE,
-                item_text);
+                level_picker_item_path(level_picker, item));
 
             const Vec2f mouse_pos = vec((float) event->motion.x, (float) event->motion.y);
             if (rect_contains_point(boundary_box, mouse_pos)) {
-                level_picker->selected_item = (int) level_picker->items_cursor;
+                level_picker->selected_item = (int) item;
             }
         } break;
         }
@@ -341,9 +593,7 @@ const char *level_picker_selected_level(const LevelPicker *level_picker)
         return NULL;
     }
 
-    return dynarray_pointer_at(
-        &level_picker->items,
-        (size_t)level_picker->selected_item);
+    return level_picker_item_path(level_picker, (size_t)level_picker->selected_item);
 }
 
 void level_picker_clean_selection(LevelPicker *level_picker)
@@ -370,7 +620,7 @@ void level_picker_cursor_up(LevelPicker *level_picker)
 void level_picker_cursor_down(LevelPicker *level_picker)
 {
     trace_assert(level_picker);
-    if (level_picker->items_cursor + 1 < level_picker->items.count) {
+    if (level_picker->items_cursor + 1 < level_picker_rows_count(level_picker)) {
         level_picker->items_cursor++;
     }
 }
@@ -2,22 +2,44 @@
 #define LEVEL_PICKER_H_
 
 #include <SDL.h>
+#include <stdbool.h>
 
 #include "game/camera.h"
 #include "game/level/background.h"
+#include "game/level_thumbnails.h"
+#include "ui/edit_field.h"
+#include "ui/fuzzy_search.h"
 #include "ui/wiggly_text.h"
-#include "dynarray.h"
 
 typedef struct {
     Background background;
     Vec2f camera_position;
     WigglyText wiggly_text;
-    Dynarray items;
+
+    // The paths of the level files, NUL terminated one after another
+    char *paths;
+    size_t paths_size;
+    size_t paths_capacity;
+    // Offsets of the paths
+    size_t *items;
+    size_t items_count;
+    size_t items_capacity;
+
+    // The list shows the matches of the search, which are all the
+    // items while the query is empty. Only the visible rows of it are
+    // ever touched, so the size of the list doesn't matter.
+    Fuzzy_Search search;
+    Edit_field search_field;
+    bool searching;
+
+    // A row of the list
     size_t items_cursor;
+    // An index of the items
     int selected_item;
     Vec2f items_scroll;
     Vec2f items_position;
     Vec2f items_size;
+    Level_Thumbnails *thumbnails;
 } LevelPicker;
 
 // TODO(#1221): Level Picker scroll does not support mouse wheel
@@ -29,13 +51,19 @@ void level_picker_populate(LevelPicker *level_picker,
 static inline
 void destroy_level_picker(LevelPicker level_picker)
 {
-    free(level_picker.items.data);
+    if (level_picker.thumbnails != NULL) {
+        destroy_level_thumbnails(level_picker.thumbnails);
+    }
+    destroy_fuzzy_search(&level_picker.search);
+    free(level_picker.items);
+    free(level_picker.paths);
 }
 
 int level_picker_render(const LevelPicker *level_picker,
                         const Camera *camera);
 int level_picker_update(LevelPicker *level,
                         Camera *camera,
+                        Jobs *jobs,
                         float delta_time);
 int level_picker_event(LevelPicker *level_picker,
                        const SDL_Event *event);
@@ -0,0 +1,452 @@
+#include <SDL.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "./level_thumbnails.h"
+#include "color.h"
+#include "config.h"
+#include "game/level/level_data.h"
+#include "game/level/level_raster.h"
+#include "math/rect.h"
+#include "system/file.h"
+#include "system/log.h"
+#include "system/lt.h"
+#include "system/nth_alloc.h"
+#include "system/s.h"
+#include "system/stacktrace.h"
+
+// Increment it whenever the layout of the cache entries changes
+#define LEVEL_THUMBNAIL_CACHE_VERSION 1u
+#define LEVEL_THUMBNAIL_CACHE_MAGIC 0x4d48544eu  // "NTHM"
+// The cache folder and the name of the entry
+#define LEVEL_THUMBNAIL_CACHE_PATH_MAX_SIZE (METADATA_FILEPATH_MAX_SIZE + 32)
+// Anything bigger is a broken cache entry
+#define LEVEL_THUMBNAIL_CACHE_MAX_RECTS (1u << 16)
+#define LEVEL_THUMBNAIL_UPLOADS_PER_FRAME 4
+
+typedef enum {
+    LEVEL_THUMBNAIL_NOT_STARTED = 0,
+    LEVEL_THUMBNAIL_RENDERING,
+    LEVEL_THUMBNAIL_RENDERED,
+    LEVEL_THUMBNAIL_UPLOADED,
+    LEVEL_THUMBNAIL_FAILED
+} Level_Thumbnail_State;
+
+typedef struct {
+    // Level_Thumbnail_State. The job owns the thumbnail while it is
+    // LEVEL_THUMBNAIL_RENDERING, the render thread the rest of the time.
+    SDL_atomic_t state;
+    uint32_t *pixels;
+    SDL_Texture *texture;
+} Level_Thumbnail;
+
+struct Level_Thumbnails
+{
+    Lt *lt;
+
+    size_t count;
+    const char *paths;
+    const size_t *offsets;
+    char cache_folder[METADATA_FILEPATH_MAX_SIZE];
+    Level_Thumbnail *thumbnails;
+
+    // Its pending is the amount of the thumbnails in flight
+    Job_Counter counter;
+    SDL_atomic_t cancelled;
+    // Every thumbnail before it was started
+    size_t next;
+
+    // The finished thumbnails in the order they finished, as index + 1
+    // (zero is a slot that is reserved but not written yet), so the
+    // uploads don't have to look through all of them
+    SDL_atomic_t *finished;
+    SDL_atomic_t finished_count;
+    size_t uploaded_count;
+};
+
+// Everything the thumbnail is drawn from. This is what gets cached.
+typedef struct {
+    Color background;
+    uint32_t count;
+    Level_Raster_Rect *rects;
+} Thumbnail_Geometry;
+
+static
+void cache_entry_path(char *path, const char *cache_folder, uint64_t hash)
+{
+    snprintf(path, LEVEL_THUMBNAIL_CACHE_PATH_MAX_SIZE, "%s/%08lx%08lx.bin",
+             cache_folder,
+             (unsigned long) (hash >> 32),
+             (unsigned long) (hash & 0xffffffffu));
+}
+
+static
+int thumbnail_geometry_load(Thumbnail_Geometry *geometry,
+                            const char *cache_folder,
+                            uint64_t hash)
+{
+    char path[LEVEL_THUMBNAIL_CACHE_PATH_MAX_SIZE];
+    cache_entry_path(path, cache_folder, hash);
+
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return -1;
+    }
+
+    int result = -1;
+    uint32_t magic = 0, version = 0;
+    uint64_t entry_hash = 0;
+    geometry->rects = NULL;
+
+    if (fread(&magic, sizeof(magic), 1, f) != 1 ||
+        fread(&version, sizeof(version), 1, f) != 1 ||
+        fread(&entry_hash, sizeof(entry_hash), 1, f) != 1 ||
+        magic != LEVEL_THUMBNAIL_CACHE_MAGIC ||
+        version != LEVEL_THUMBNAIL_CACHE_VERSION ||
+        entry_hash != hash) {
+        goto end;
+    }
+
+    if (fread(&geometry->background, sizeof(geometry->background), 1, f) != 1 ||
+        fread(&geometry->count, sizeof(geometry->count), 1, f) != 1 ||
+        geometry->count > LEVEL_THUMBNAIL_CACHE_MAX_RECTS) {
+        goto end;
+    }
+
+    geometry->rects = nth_calloc(geometry->count + 1, sizeof(Level_Raster_Rect));
+    if (geometry->rects == NULL) {
+        goto end;
+    }
+
+    if (fread(geometry->rects, sizeof(Level_Raster_Rect), geometry->count, f) != geometry->count) {
+        free(geometry->rects);
+        geometry->rects = NULL;
+        goto end;
+    }
+
+    result = 0;
+
+end:
+    fclose(f);
+    return result;
+}
+
+// The cache is only an optimization, the thumbnail is fine without it
+static
+void thumbnail_geometry_save(const Thumbnail_Geometry *geometry,
+                             const char *cache_folder,
+                             uint64_t hash)
+{
+    char path[LEVEL_THUMBNAIL_CACHE_PATH_MAX_SIZE];
+    cache_entry_path(path, cache_folder, hash);
+
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        log_warn("Could not write the thumbnail cache %s\n", path);
+        return;
+    }
+
+    // A torn entry, say when two levels with the same contents are
+    // written at the same time, just fails to load next time
+    const uint32_t magic = LEVEL_THUMBNAIL_CACHE_MAGIC;
+    const uint32_t version = LEVEL_THUMBNAIL_CACHE_VERSION;
+    fwrite(&magic, sizeof(magic), 1, f);
+    fwrite(&version, sizeof(version), 1, f);
+    fwrite(&hash, sizeof(hash), 1, f);
+    fwrite(&geometry->background, sizeof(geometry->background), 1, f);
+    fwrite(&geometry->count, sizeof(geometry->count), 1, f);
+    fwrite(geometry->rects, sizeof(Level_Raster_Rect), geometry->count, f);
+
+    fclose(f);
+}
+
+// The regions and the labels are not visible when the game is played,
+// so they are not in the thumbnail either
+static
+int thumbnail_geometry_from_level(Thumbnail_Geometry *geometry, Memory *memory, String input)
+{
+    Level_Data data;
+    if (level_data_load(&data, memory, input) < 0) {
+        return -1;
+    }
+
+    const size_t count = level_raster_rects_count(&data, false);
+    if (count > LEVEL_THUMBNAIL_CACHE_MAX_RECTS) {
+        return -1;
+    }
+
+    geometry->background = data.background_color;
+    geometry->rects = nth_calloc(count + 1, sizeof(Level_Raster_Rect));
+    if (geometry->rects == NULL) {
+        return -1;
+    }
+    geometry->count = (uint32_t) level_raster_push_level(geometry->rects, &data, false);
+
+    return 0;
+}
+
+// Fits the whole level into the thumbnail. The pixels are
+// SDL_PIXELFORMAT_ARGB8888.
+static
+void thumbnail_geometry_rasterize(const Thumbnail_Geometry *geometry, uint32_t *pixels)
+{
+    Level_Raster raster = {
+        .pixels = pixels,
+        .width = LEVEL_THUMBNAIL_WIDTH,
+        .height = LEVEL_THUMBNAIL_HEIGHT,
+        .scale = 1.0f
+    };
+
+    if (geometry->count > 0) {
+        level_raster_fit(&raster, level_raster_bounds(geometry->rects, geometry->count));
+    }
+
+    level_raster_draw(&raster, geometry->background, geometry->rects, geometry->count, NULL);
+}
+
+static
+uint32_t *level_thumbnail_render(const char *file_path, const char *cache_folder)
+{
+    Memory memory = {
+        .capacity = LEVEL_EDITOR_MEMORY_CAPACITY,
+        .buffer = malloc(LEVEL_EDITOR_MEMORY_CAPACITY)
+    };
+    if (memory.buffer == NULL) {
+        return NULL;
+    }
+
+    uint32_t *pixels = NULL;
+    Thumbnail_Geometry geometry = {0};
+
+    String input = read_whole_file(&memory, file_path);
+    if (input.data == NULL) {
+        goto end;
+    }
+
+    const uint64_t hash = string_hash64(input);
+    if (thumbnail_geometry_load(&geometry, cache_folder, hash) < 0) {
+        if (thumbnail_geometry_from_level(&geometry, &memory, input) < 0) {
+            goto end;
+        }
+        thumbnail_geometry_save(&geometry, cache_folder, hash);
+    }
+
+    pixels = nth_calloc(LEVEL_THUMBNAIL_WIDTH * LEVEL_THUMBNAIL_HEIGHT, sizeof(uint32_t));
+    if (pixels == NULL) {
+        goto end;
+    }
+    thumbnail_geometry_rasterize(&geometry, pixels);
+
+end:
+    free(geometry.rects);
+    free(memory.buffer);
+    return pixels;
+}
+
+static
+void level_thumbnail_job(void *data, size_t begin, size_t end)
+{
+    Level_Thumbnails *thumbnails = data;
+    trace_assert(thumbnails);
+
+    for (size_t i = begin; i < end; ++i) {
+        Level_Thumbnail *thumbnail = &thumbnails->thumbnails[i];
+
+        if (!SDL_AtomicGet(&thumbnails->cancelled)) {
+            thumbnail->pixels = level_thumbnail_render(
+                thumbnails->paths + thumbnails->offsets[i],
+                thumbnails->cache_folder);
+        }
+
+        SDL_AtomicSet(
+            &thumbnail->state,
+            thumbnail->pixels != NULL ? LEVEL_THUMBNAIL_RENDERED : LEVEL_THUMBNAIL_FAILED);
+
+        const int slot = SDL_AtomicAdd(&thumbnails->finished_count, 1);
+        SDL_AtomicSet(&thumbnails->finished[slot], (int) i + 1);
+    }
+}
+
+Level_Thumbnails *create_level_thumbnails(const char *paths,
+                                          const size_t *offsets,
+                                          size_t count,
+                                          const char *cache_folder)
+{
+    trace_assert(count == 0 || (paths && offsets));
+    trace_assert(count < INT_MAX);
+    trace_assert(cache_folder);
+
+    Lt *lt = create_lt();
+
+    Level_Thumbnails *thumbnails = PUSH_LT(lt, nth_calloc(1, sizeof(Level_Thumbnails)), free);
+    if (thumbnails == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+    thumbnails->lt = lt;
+
+    thumbnails->count = count;
+    thumbnails->paths = paths;
+    thumbnails->offsets = offsets;
+
+    thumbnails->thumbnails = PUSH_LT(
+        lt,
+        nth_calloc(thumbnails->count + 1, sizeof(Level_Thumbnail)),
+        free);
+    if (thumbnails->thumbnails == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+
+    thumbnails->finished = PUSH_LT(
+        lt,
+        nth_calloc(thumbnails->count + 1, sizeof(SDL_atomic_t)),
+        free);
+    if (thumbnails->finished == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+
+    snprintf(thumbnails->cache_folder, METADATA_FILEPATH_MAX_SIZE, "%s", cache_folder);
+    if (make_directory(thumbnails->cache_folder) < 0) {
+        log_warn("Could not create the thumbnail cache folder %s\n",
+                 thumbnails->cache_folder);
+    }
+
+    return thumbnails;
+}
+
+void destroy_level_thumbnails(Level_Thumbnails *thumbnails)
+{
+    trace_assert(thumbnails);
+
+    // The submitted jobs notice the flag and finish right away. Nobody
+    // else runs them here, the workers are still there.
+    SDL_AtomicSet(&thumbnails->cancelled, 1);
+    while (SDL_AtomicGet(&thumbnails->counter.pending) > 0) {
+        SDL_Delay(1);
+    }
+
+    for (size_t i = 0; i < thumbnails->count; ++i) {
+        free(thumbnails->thumbnails[i].pixels);
+        if (thumbnails->thumbnails[i].texture != NULL) {
+            SDL_DestroyTexture(thumbnails->thumbnails[i].texture);
+        }
+    }
+
+    RETURN_LT0(thumbnails->lt);
+}
+
+static
+void level_thumbnails_upload(Level_Thumbnails *thumbnails,
+                             SDL_Renderer *renderer)
+{
+    for (size_t uploads = 0;
+         uploads < LEVEL_THUMBNAIL_UPLOADS_PER_FRAME && thumbnails->uploaded_count < thumbnails->count;
+         ++uploads) {
+        const int finished = SDL_AtomicGet(&thumbnails->finished[thumbnails->uploaded_count]);
+        if (finished == 0) {
+            break;
+        }
+        thumbnails->uploaded_count += 1;
+
+        const size_t i = (size_t) finished - 1;
+        Level_Thumbnail *thumbnail = &thumbnails->thumbnails[i];
+        if (SDL_AtomicGet(&thumbnail->state) != LEVEL_THUMBNAIL_RENDERED) {
+            continue;
+        }
+
+        thumbnail->texture = SDL_CreateTexture(
+            renderer,
+            SDL_PIXELFORMAT_ARGB8888,
+            SDL_TEXTUREACCESS_STATIC,
+            LEVEL_THUMBNAIL_WIDTH,
+            LEVEL_THUMBNAIL_HEIGHT);
+        if (thumbnail->texture != NULL &&
+            SDL_UpdateTexture(
+                thumbnail->texture, NULL, thumbnail->pixels,
+                LEVEL_THUMBNAIL_WIDTH * (int) sizeof(uint32_t)) < 0) {
+            SDL_DestroyTexture(thumbnail->texture);
+            thumbnail->texture = NULL;
+        }
+        if (thumbnail->texture == NULL) {
+            log_warn("Could not upload the thumbnail of %s: %s\n",
+                     thumbnails->paths + thumbnails->offsets[i],
+                     SDL_GetError());
+        }
+
+        free(thumbnail->pixels);
+        thumbnail->pixels = NULL;
+        SDL_AtomicSet(
+            &thumbnail->state,
+            thumbnail->texture != NULL ? LEVEL_THUMBNAIL_UPLOADED : LEVEL_THUMBNAIL_FAILED);
+    }
+}
+
+// Returns false once there are enough thumbnails in flight
+static
+bool level_thumbnails_start(Level_Thumbnails *thumbnails,
+                            Jobs *jobs,
+                            size_t index)
+{
+    // Without the workers the jobs are only run by jobs_wait, which
+    // would stall whatever is waiting, so one thumbnail per frame is
+    // rendered right here instead
+    const size_t workers_count = jobs_workers_count(jobs);
+    if ((size_t) SDL_AtomicGet(&thumbnails->counter.pending) >= (workers_count > 0 ? workers_count : 1)) {
+        return false;
+    }
+
+    Level_Thumbnail *thumbnail = &thumbnails->thumbnails[index];
+    if (SDL_AtomicGet(&thumbnail->state) != LEVEL_THUMBNAIL_NOT_STARTED) {
+        return true;
+    }
+
+    SDL_AtomicSet(&thumbnail->state, LEVEL_THUMBNAIL_RENDERING);
+    jobs_submit(
+        workers_count > 0 ? jobs : NULL,
+        job(level_thumbnail_job, thumbnails, index, index + 1),
+        &thumbnails->counter);
+
+    return workers_count > 0;
+}
+
+void level_thumbnails_update(Level_Thumbnails *thumbnails,
+                             Jobs *jobs,
+                             SDL_Renderer *renderer,
+                             const size_t *wanted,
+                             size_t wanted_count)
+{
+    trace_assert(thumbnails);
+    trace_assert(renderer);
+    trace_assert(wanted_count == 0 || wanted);
+
+    level_thumbnails_upload(thumbnails, renderer);
+
+    // Only a few are in flight at a time, so the wanted ones go next
+    // even after the list was scrolled
+    for (size_t k = 0; k < wanted_count; ++k) {
+        trace_assert(wanted[k] < thumbnails->count);
+        if (!level_thumbnails_start(thumbnails, jobs, wanted[k])) {
+            return;
+        }
+    }
+
+    while (thumbnails->next < thumbnails->count &&
+           level_thumbnails_start(thumbnails, jobs, thumbnails->next)) {
+        thumbnails->next += 1;
+    }
+}
+
+SDL_Texture *level_thumbnails_texture(const Level_Thumbnails *thumbnails,
+                                      size_t index)
+{
+    trace_assert(thumbnails);
+
+    if (index >= thumbnails->count) {
+        return NULL;
+    }
+
+    return thumbnails->thumbnails[index].texture;
+}
@@ -0,0 +1,46 @@
+#ifndef LEVEL_THUMBNAILS_H_
+#define LEVEL_THUMBNAILS_H_
+
+#include <SDL.h>
+
+#include "system/jobs.h"
+
+#define LEVEL_THUMBNAIL_WIDTH 128
+#define LEVEL_THUMBNAIL_HEIGHT 72
+
+// Small previews of the level files. Every thumbnail is rendered on
+// the job workers into a pixel buffer and only uploaded into a texture
+// on the render thread, a few per frame, so the thumbnails show up one
+// by one without stalling the frames.
+//
+// Parsing a level takes most of the time, so the geometry the
+// thumbnail is drawn from is cached in cache_folder in a binary form.
+// A cache entry is named after the hash of the contents of the level
+// file, so editing a level simply makes a new entry.
+typedef struct Level_Thumbnails Level_Thumbnails;
+
+// The level file paths are NUL terminated strings at offsets. They are
+// not copied and must outlive the thumbnails.
+Level_Thumbnails *create_level_thumbnails(const char *paths,
+                                          const size_t *offsets,
+                                          size_t count,
+                                          const char *cache_folder);
+// Waits for the jobs that already started, the rest are cancelled
+void destroy_level_thumbnails(Level_Thumbnails *thumbnails);
+
+// Uploads a few finished thumbnails and keeps about one thumbnail per
+// worker in flight: the wanted ones (usually the visible ones) first,
+// then the rest in order. Without the workers renders one thumbnail
+// per call right here.
+void level_thumbnails_update(Level_Thumbnails *thumbnails,
+                             Jobs *jobs,
+                             SDL_Renderer *renderer,
+                             const size_t *wanted,
+                             size_t wanted_count);
+
+// NULL until the thumbnail is ready or if the level could not be
+// rendered
+SDL_Texture *level_thumbnails_texture(const Level_Thumbnails *thumbnails,
+                                      size_t index);
+
+#endif  // LEVEL_THUMBNAILS_H_
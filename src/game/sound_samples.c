@@ -5,6 +5,8 @@
 
 #include "math/pi.h"
 #include "sound_samples.h"
+#include "system/assets.h"
+#include "system/jobs.h"
 #include "system/log.h"
 #include "system/lt.h"
 #include "system/nth_alloc.h"
@@ -26,9 +28,65 @@ struct Sound_samples
     int failed;                 // This is hackish
 };
 
+typedef struct {
+    Sound_samples *sound_samples;
+    const char **sample_files;
+    const SDL_AudioSpec *destination_spec;
+} Sound_samples_Load;
+
+// Decodes and converts the samples [begin, end). Runs on the job
+// workers, so it only touches its own slots of the buffer arrays and
+// leaves a NULL buffer behind when something goes wrong.
+static
+void load_samples_job(void *data, size_t begin, size_t end)
+{
+    Sound_samples_Load *load = data;
+    trace_assert(load);
+
+    Sound_samples *sound_samples = load->sound_samples;
+    const SDL_AudioSpec *destination_spec = load->destination_spec;
+
+    for (size_t i = begin; i < end; ++i) {
+        Asset asset;
+
+        log_info("Loading audio file %s...\n", load->sample_files[i]);
+        if (assets_open(load->sample_files[i], &asset) < 0) {
+            continue;
+        }
+        SDL_AudioCVT cvt;
+        int result = SDL_BuildAudioCVT(&cvt, asset.spec.format, (uint8_t)asset.spec.channels, (int)asset.spec.freq,
+                          destination_spec->format, (uint8_t)destination_spec->channels, (int)destination_spec->freq);
+        if (result < 0) {
+            log_fail("SDL_BuildAudioCVT failed: %s\n", SDL_GetError());
+            assets_close(&asset);
+            continue;
+        }
+
+        // The samples are copied even when no conversion is needed,
+        // since the packed ones belong to the assets pack
+        cvt.len = (int)asset.size;
+        cvt.buf = malloc((size_t)(cvt.len * cvt.len_mult));
+        if (cvt.buf == NULL) {
+            log_fail("Allocating buffer for conversion failed\n");
+            assets_close(&asset);
+            continue;
+        }
+        memcpy(cvt.buf, asset.data, (size_t)cvt.len);
+        assets_close(&asset);
+        if (SDL_ConvertAudio(&cvt) < 0) {
+            log_fail("SDL_ConvertAudio failed: %s\n", SDL_GetError());
+            free(cvt.buf);
+            continue;
+        }
+        sound_samples->audio_buf_array[i] = cvt.buf;
+        sound_samples->audio_buf_size_array[i] = (uint32_t)cvt.len_cvt;
+    }
+}
+
 static
 int init_buffer_and_device(Sound_samples *sound_samples,
-                           const char *sample_files[])
+                           const char *sample_files[],
+                           Jobs *jobs)
 {
     // TODO(#1023): init_buffer_and_device uses hard-coded audio specification
     SDL_AudioSpec destination_spec = { // stereo float32 44100Hz
@@ -52,41 +110,24 @@ int init_buffer_and_device(Sound_samples *sound_samples,
         log_fail("Failed to allocate memory for audio buffer size array\n");
         return -1;
     }
-    for (size_t i = 0; i < sound_samples->samples_count; ++i) {
-        uint8_t *wav_buf; uint32_t wav_buf_len; SDL_AudioSpec wav_spec;
+    Sound_samples_Load load = {
+        .sound_samples = sound_samples,
+        .sample_files = sample_files,
+        .destination_spec = &destination_spec
+    };
+    jobs_parallel_for(jobs, load_samples_job, &load, sound_samples->samples_count, 1);
 
-        log_info("Loading audio file %s...\n", sample_files[i]);
-        if (SDL_LoadWAV(sample_files[i], &wav_spec, &wav_buf, &wav_buf_len) == NULL) {
-            log_fail("Load WAV file failed: %s\n", SDL_GetError());
-            return -1;
-        }
-        PUSH_LT(sound_samples->lt, wav_buf, SDL_FreeWAV);
-        SDL_AudioCVT cvt;
-        int result = SDL_BuildAudioCVT(&cvt, wav_spec.format, (uint8_t)wav_spec.channels, (int)wav_spec.freq,
-                          destination_spec.format, (uint8_t)destination_spec.channels, (int)destination_spec.freq);
-        if (result < 0) {
-            log_fail("SDL_BuildAudioCVT failed: %s\n", SDL_GetError());
-            return -1;
-        } else if (result == 0) { // no need to do conversion
-            sound_samples->audio_buf_array[i] = wav_buf;
-            sound_samples->audio_buf_size_array[i] = wav_buf_len;
+    int failed = 0;
+    for (size_t i = 0; i < sound_samples->samples_count; ++i) {
+        if (sound_samples->audio_buf_array[i] == NULL) {
+            failed = 1;
         } else {
-            cvt.len = (int)wav_buf_len;
-            cvt.buf = PUSH_LT(sound_samples->lt, malloc((size_t)(cvt.len * cvt.len_mult)), free);
-            if (cvt.buf == NULL) {
-                log_fail("Allocating buffer for conversion failed\n");
-                return -1;
-            }
-            memcpy(cvt.buf, wav_buf, (size_t)cvt.len);
-            SDL_FreeWAV(RELEASE_LT(sound_samples->lt, wav_buf));
-            if (SDL_ConvertAudio(&cvt) < 0) {
-                log_fail("SDL_ConvertAudio failed: %s\n", SDL_GetError());
-                return -1;
-            }
-            sound_samples->audio_buf_array[i] = cvt.buf;
-            sound_samples->audio_buf_size_array[i] = (uint32_t)cvt.len_cvt;
+            PUSH_LT(sound_samples->lt, sound_samples->audio_buf_array[i], free);
         }
     }
+    if (failed) {
+        return -1;
+    }
 
     /* Allocating active audio buffer location*/
     //TODO(#1072): Allocate one huge active audio buffer with length of the maximum of all audio buffer, instead of one active buffer for each audio
@@ -116,7 +157,8 @@ int init_buffer_and_device(Sound_samples *sound_samples,
 }
 
 Sound_samples *create_sound_samples(const char *sample_files[],
-                                    size_t sample_files_count)
+                                    size_t sample_files_count,
+                                    Jobs *jobs)
 {
     trace_assert(sample_files);
     trace_assert(sample_files_count > 0);
@@ -131,7 +173,7 @@ Sound_samples *create_sound_samples(const char *sample_files[],
     sound_samples->volume = SOUND_SAMPLES_DEFAULT_VOLUME;
 
     sound_samples->samples_count = sample_files_count;
-    if (init_buffer_and_device(sound_samples, sample_files) < 0) {
+    if (init_buffer_and_device(sound_samples, sample_files, jobs) < 0) {
         log_fail("init_buffer_and_device failed\n");
         sound_samples->failed = 1;
     }
@@ -2,11 +2,15 @@
 #define SOUND_SAMPLES_H_
 
 #include "math/vec.h"
+#include "system/jobs.h"
 
 typedef struct Sound_samples Sound_samples;
 
+// The samples are decoded and converted on the jobs (which may be
+// NULL)
 Sound_samples *create_sound_samples(const char *sample_files[],
-                                      size_t sample_files_count);
+                                    size_t sample_files_count,
+                                    Jobs *jobs);
 void destroy_sound_samples(Sound_samples *sound_samples);
 
 int sound_samples_play_sound(Sound_samples *sound_samples,
@@ -39,35 +39,14 @@ int scc(int code)
     return code;
 }
 
-SDL_Texture *load_bmp_font_texture(SDL_Renderer *renderer,
-                                   const char *bmp_file_path)
-{
-    trace_assert(renderer);
-    trace_assert(bmp_file_path);
-
-    SDL_Surface *surface = scp(SDL_LoadBMP(bmp_file_path));
-    scc(SDL_SetColorKey(
-            surface,
-            SDL_TRUE,
-            SDL_MapRGB(surface->format,
-                       0, 0, 0)));
-
-    SDL_Texture *result =
-        scp(SDL_CreateTextureFromSurface(renderer, surface));
-
-    SDL_FreeSurface(surface);
-
-    return result;
-}
-
 static SDL_Rect sprite_font_char_rect(const Sprite_font *sprite_font, char x)
 {
     trace_assert(sprite_font);
 
     if (32 <= x && x <= 126) {
         const SDL_Rect rect = {
-            .x = ((x - 32) % FONT_ROW_SIZE) * FONT_CHAR_WIDTH,
-            .y = ((x - 32) / FONT_ROW_SIZE) * FONT_CHAR_HEIGHT,
+            .x = sprite_font->rect.x + ((x - 32) % FONT_ROW_SIZE) * FONT_CHAR_WIDTH,
+            .y = sprite_font->rect.y + ((x - 32) / FONT_ROW_SIZE) * FONT_CHAR_HEIGHT,
             .w = FONT_CHAR_WIDTH,
             .h = FONT_CHAR_HEIGHT
         };
@@ -10,11 +10,11 @@
 
 typedef struct {
     SDL_Texture *texture;
+    // Where the glyphs are in the texture, it is usually a part of an
+    // atlas (see sdl/atlas.h)
+    SDL_Rect rect;
 } Sprite_font;
 
-SDL_Texture *load_bmp_font_texture(SDL_Renderer *renderer,
-                                   const char *bmp_file_path);
-
 void sprite_font_render_text(const Sprite_font *sprite_font,
                              SDL_Renderer *renderer,
                              Vec2f position,
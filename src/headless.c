@@ -0,0 +1,160 @@
+#include "game/camera.h"
+#include "game/sound_samples.h"
+
+// The simulation (nothing_sim) renders and plays sounds through the
+// Camera and the Sound_samples without knowing what is behind them.
+// The game links the SDL implementations (game/camera.c and
+// game/sound_samples.c), the tools that never draw or play anything
+// link these instead and don't need the renderer or the audio.
+
+int camera_clear_background(const Camera *camera,
+                            Color color)
+{
+    (void) camera;
+    (void) color;
+    return 0;
+}
+
+int camera_fill_rect(const Camera *camera,
+                     Rect rect,
+                     Color color)
+{
+    (void) camera;
+    (void) rect;
+    (void) color;
+    return 0;
+}
+
+int camera_fill_rect_packed(const Camera *camera,
+                            Rect rect,
+                            PackedColor color)
+{
+    (void) camera;
+    (void) rect;
+    (void) color;
+    return 0;
+}
+
+int camera_fill_triangle(const Camera *camera,
+                         Triangle t,
+                         Color color)
+{
+    (void) camera;
+    (void) t;
+    (void) color;
+    return 0;
+}
+
+int camera_fill_triangles(const Camera *camera,
+                          Triangle *ts,
+                          size_t count,
+                          PackedColor color)
+{
+    (void) camera;
+    (void) ts;
+    (void) count;
+    (void) color;
+    return 0;
+}
+
+int camera_render_text(const Camera *camera,
+                       const char *text,
+                       Vec2f size,
+                       Color color,
+                       Vec2f position)
+{
+    (void) camera;
+    (void) text;
+    (void) size;
+    (void) color;
+    (void) position;
+    return 0;
+}
+
+int camera_render_debug_text(const Camera *camera,
+                             const char *text,
+                             Vec2f position)
+{
+    (void) camera;
+    (void) text;
+    (void) position;
+    return 0;
+}
+
+int camera_render_debug_rect(const Camera *camera,
+                             Rect rect,
+                             Color color)
+{
+    (void) camera;
+    (void) rect;
+    (void) color;
+    return 0;
+}
+
+void camera_center_at(Camera *camera, Vec2f position)
+{
+    (void) camera;
+    (void) position;
+}
+
+void camera_scale(Camera *camera, float scale)
+{
+    (void) camera;
+    (void) scale;
+}
+
+void camera_toggle_debug_mode(Camera *camera)
+{
+    (void) camera;
+}
+
+int camera_is_point_visible(const Camera *camera, Vec2f p)
+{
+    (void) camera;
+    (void) p;
+    return 0;
+}
+
+int camera_is_text_visible(const Camera *camera,
+                           Vec2f size,
+                           Vec2f position,
+                           const char *text)
+{
+    (void) camera;
+    (void) size;
+    (void) position;
+    (void) text;
+    return 0;
+}
+
+Rect camera_view_port(const Camera *camera)
+{
+    (void) camera;
+    return rect(0.0f, 0.0f, 0.0f, 0.0f);
+}
+
+Rect camera_view_port_screen(const Camera *camera)
+{
+    (void) camera;
+    return rect(0.0f, 0.0f, 0.0f, 0.0f);
+}
+
+Rect camera_rect(const Camera *camera, const Rect r)
+{
+    (void) camera;
+    return r;
+}
+
+int sound_samples_play_sound(Sound_samples *sound_samples,
+                             size_t sound_index)
+{
+    (void) sound_samples;
+    (void) sound_index;
+    return 0;
+}
+
+int sound_samples_toggle_pause(Sound_samples *sound_samples)
+{
+    (void) sound_samples;
+    return 0;
+}
@@ -4,8 +4,9 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
 
+#include "cvars.h"
+#include "config.h"
 #include "game.h"
 #include "game/level/platforms.h"
 #include "game/level/player.h"
@@ -14,19 +15,28 @@
 #include "math/extrema.h"
 #include "math/vec.h"
 #include "sdl/renderer.h"
+#include "system/assets.h"
 #include "system/log.h"
 #include "system/lt.h"
+#include "system/id_table.h"
 
 #define SCREEN_WIDTH 800
 #define SCREEN_HEIGHT 600
 
 static void print_usage(FILE *stream)
 {
-    fprintf(stream, "Usage: nothing [--fps <fps>]\n");
+    fprintf(stream, "Usage: nothing [--fps <fps>] [--loose-assets]\n");
 }
 
 static float current_display_scale = 1.0f;
 
+static
+float milliseconds_since(Uint64 begin)
+{
+    return (float) (SDL_GetPerformanceCounter() - begin) * 1000.0f
+        / (float) SDL_GetPerformanceFrequency();
+}
+
 
 // export this for other parts of the code to use.
 float get_display_scale(void)
@@ -79,17 +89,23 @@ void maybe_fixup_input_for_display_scale(SDL_Window* win, SDL_Renderer* rend, SD
 
 int main(int argc, char *argv[])
 {
-    srand((unsigned int) time(NULL));
+    const Uint64 launch_time = SDL_GetPerformanceCounter();
 
     Lt *lt = create_lt();
+    // Destroyed last, so everything logged during the shutdown gets out
+    if (log_start() == 0) {
+        PUSH_LT(lt, 42, log_stop);
+    }
+    PUSH_LT(lt, 42, id_table_free);
 
-    int fps = 60;
+    // The flags below take precedence over the saved variables
+    cvars_load(CVARS_FILE_PATH);
 
     for (int i = 1; i < argc;) {
         if (strcmp(argv[i], "--fps") == 0) {
             if (i + 1 < argc) {
-                if (sscanf(argv[i + 1], "%d", &fps) == 0) {
-                    log_fail("Cannot parse FPS: %s is not a number\n", argv[i + 1]);
+                if (cvar_set(&cvar_fps, string_nt(argv[i + 1])) < 0) {
+                    log_fail("Cannot parse FPS: %s is not a valid number\n", argv[i + 1]);
                     print_usage(stderr);
                     RETURN_LT(lt, -1);
                 }
@@ -99,6 +115,10 @@ int main(int argc, char *argv[])
                 print_usage(stderr);
                 RETURN_LT(lt, -1);
             }
+        } else if (strcmp(argv[i], "--loose-assets") == 0) {
+            // The files in ./assets/ take precedence over the pack
+            assets_set_loose_override(1);
+            i += 1;
         } else {
             log_fail("Unknown flag %s\n", argv[i]);
             print_usage(stderr);
@@ -112,6 +132,10 @@ int main(int argc, char *argv[])
     }
     PUSH_LT(lt, 42, SDL_Quit);
 
+    if (assets_load_pack("./assets.pack") == 0) {
+        PUSH_LT(lt, 42, assets_unload_pack);
+    }
+
     setlocale(LC_NUMERIC, "C");
 
     SDL_ShowCursor(SDL_DISABLE);
@@ -172,14 +196,15 @@ int main(int argc, char *argv[])
     // ------------------------------
 
     const char * sound_sample_files[] = {
-        "./assets/sounds/nothing.wav",
-        "./assets/sounds/something.wav",
-        "./assets/sounds/dev/ding.wav",
-        "./assets/sounds/dev/click.wav",
-        "./assets/sounds/dev/save.wav"
+        "sounds/nothing.wav",
+        "sounds/something.wav",
+        "sounds/dev/ding.wav",
+        "sounds/dev/click.wav",
+        "sounds/dev/save.wav"
     };
     const size_t sound_sample_files_count = sizeof(sound_sample_files) / sizeof(char*);
 
+    const Uint64 create_game_time = SDL_GetPerformanceCounter();
     Game *const game = PUSH_LT(
         lt,
         create_game(
@@ -191,6 +216,7 @@ int main(int argc, char *argv[])
     if (game == NULL) {
         RETURN_LT(lt, -1);
     }
+    log_info("Created the game in %.2f ms\n", milliseconds_since(create_game_time));
 
     // calculate the display scale for the first time.
     recalculate_display_scale(window, renderer);
@@ -200,7 +226,8 @@ int main(int argc, char *argv[])
     SDL_StopTextInput();
     SDL_Event e;
     const int64_t delta_time = (int64_t) roundf(1000.0f / 60.0f);
-    int64_t render_timer = (int64_t) roundf(1000.0f / (float) fps);
+    int64_t render_timer = (int64_t) roundf(1000.0f / (float) cvar_fps.int_value);
+    int first_frame = 1;
     while (!game_over_check(game)) {
         const int64_t begin_frame_time = (int64_t) SDL_GetTicks();
 
@@ -220,6 +247,8 @@ int main(int argc, char *argv[])
             RETURN_LT(lt, -1);
         }
 
+        const Uint64 update_begin = SDL_GetPerformanceCounter();
+
         if (game_update(game, (float) delta_time * 0.001f) < 0) {
             RETURN_LT(lt, -1);
         }
@@ -228,15 +257,29 @@ int main(int argc, char *argv[])
             RETURN_LT(lt, -1);
         }
 
+        const float update_time = milliseconds_since(update_begin);
+        float render_time = 0.0f;
+
         render_timer -= delta_time;
         if (render_timer <= 0) {
+            const Uint64 render_begin = SDL_GetPerformanceCounter();
             if (game_render(game) < 0) {
                 RETURN_LT(lt, -1);
             }
+            // Only the CPU side of the rendering. The present mostly
+            // waits for the vsync, so it is not counted.
+            render_time = milliseconds_since(render_begin);
             SDL_RenderPresent(renderer);
-            render_timer = (int64_t) roundf(1000.0f / (float) fps);
+            if (first_frame) {
+                log_info("First frame after %.2f ms since the launch\n",
+                         milliseconds_since(launch_time));
+                first_frame = 0;
+            }
+            render_timer = (int64_t) roundf(1000.0f / (float) cvar_fps.int_value);
         }
 
+        game_record_frame(game, update_time, render_time);
+
         const int64_t end_frame_time = (int64_t) SDL_GetTicks();
         SDL_Delay((unsigned int) MAX(int64_t, 10, delta_time - (end_frame_time - begin_frame_time)));
     }
@@ -1,13 +1,73 @@
-#include <stdlib.h>
-
 #include "math/rand.h"
 
-float rand_float(float max_value)
+#define PCG32_MULTIPLIER 6364136223846793005ULL
+
+// 24 bits is all the precision a float has
+static float u32_to_unit_float(uint32_t x)
+{
+    return (float) (x >> 8) * (1.0f / 16777216.0f);
+}
+
+Rng create_rng(uint64_t seed, uint64_t stream)
+{
+    Rng rng = {
+        .state = 0,
+        .inc = (stream << 1) | 1
+    };
+    rng_u32(&rng);
+    rng.state += seed;
+    rng_u32(&rng);
+    return rng;
+}
+
+uint32_t rng_u32(Rng *rng)
+{
+    const uint64_t old = rng->state;
+    rng->state = old * PCG32_MULTIPLIER + rng->inc;
+
+    const uint32_t xorshifted = (uint32_t) (((old >> 18) ^ old) >> 27);
+    const uint32_t rot = (uint32_t) (old >> 59);
+    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+float rng_float(Rng *rng, float max_value)
+{
+    return u32_to_unit_float(rng_u32(rng)) * max_value;
+}
+
+float rng_float_range(Rng *rng, float lower, float upper)
+{
+    return rng_float(rng, upper - lower) + lower;
+}
+
+void rng_fill_u32(Rng *rng, uint32_t *xs, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        xs[i] = rng_u32(rng);
+    }
+}
+
+void rng_fill_float_range(Rng *rng, float *xs, size_t count,
+                          float lower, float upper)
+{
+    const float scale = upper - lower;
+    for (size_t i = 0; i < count; ++i) {
+        xs[i] = u32_to_unit_float(rng_u32(rng)) * scale + lower;
+    }
+}
+
+// https://nullprogram.com/blog/2018/07/31/
+uint32_t hash_u32(uint32_t x)
 {
-    return (float) rand() / ((float) RAND_MAX / max_value);
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
 }
 
-float rand_float_range(float lower, float upper)
+uint32_t hash_2d(int32_t x, int32_t y, uint32_t seed)
 {
-    return rand_float(upper - lower) + lower;
+    return hash_u32((uint32_t) x ^ hash_u32((uint32_t) y ^ hash_u32(seed)));
 }
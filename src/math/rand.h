@@ -1,7 +1,37 @@
 #ifndef RAND_H_
 #define RAND_H_
 
-float rand_float(float max_value);
-float rand_float_range(float lower, float upper);
+#include <stddef.h>
+#include <stdint.h>
+
+// PCG32 random number generator (XSH RR). It only uses integer
+// arithmetic, so the same seed gives the same sequence on every
+// platform. Every subsystem that needs random numbers owns its Rng,
+// which also makes it safe to use from different threads.
+typedef struct {
+    uint64_t state;
+    uint64_t inc;
+} Rng;
+
+// Generators with different streams never produce the same sequence
+// even if their seeds are the same
+Rng create_rng(uint64_t seed, uint64_t stream);
+
+uint32_t rng_u32(Rng *rng);
+// [0, max_value)
+float rng_float(Rng *rng, float max_value);
+// [lower, upper)
+float rng_float_range(Rng *rng, float lower, float upper);
+
+// Same numbers as calling rng_u32 and rng_float_range count times
+void rng_fill_u32(Rng *rng, uint32_t *xs, size_t count);
+void rng_fill_float_range(Rng *rng, float *xs, size_t count,
+                          float lower, float upper);
+
+// Stateless hashes for the things that have to look random, but must
+// not change between frames, like the decorations of a particular
+// spot of the level.
+uint32_t hash_u32(uint32_t x);
+uint32_t hash_2d(int32_t x, int32_t y, uint32_t seed);
 
 #endif  // RAND_H_
@@ -0,0 +1,169 @@
+#include <string.h>
+
+#include "math/rect_grid.h"
+#include "system/nth_alloc.h"
+#include "system/stacktrace.h"
+
+// Upper limit for the amount of cells. Bigger levels get bigger cells.
+#define RECT_GRID_MAX_CELLS 4096
+
+static
+size_t rect_grid_col(const RectGrid *grid, float x)
+{
+    const float col = floorf((x - grid->bounds.x) / grid->cell_size);
+    if (col <= 0.0f) return 0;
+    if (col >= (float) grid->cols) return grid->cols - 1;
+    return (size_t) col;
+}
+
+static
+size_t rect_grid_row(const RectGrid *grid, float y)
+{
+    const float row = floorf((y - grid->bounds.y) / grid->cell_size);
+    if (row <= 0.0f) return 0;
+    if (row >= (float) grid->rows) return grid->rows - 1;
+    return (size_t) row;
+}
+
+int create_rect_grid(RectGrid *result, const Rect *rects, size_t count, float cell_size)
+{
+    trace_assert(result);
+    trace_assert(count == 0 || rects);
+    trace_assert(cell_size > 0.0f);
+
+    memset(result, 0, sizeof(*result));
+
+    RectGrid grid;
+    memset(&grid, 0, sizeof(grid));
+
+    if (count == 0) {
+        grid.cell_size = cell_size;
+        grid.cells = nth_calloc(1, sizeof(grid.cells[0]));
+        if (grid.cells == NULL) {
+            return -1;
+        }
+        *result = grid;
+        return 0;
+    }
+
+    grid.bounds = rects[0];
+    for (size_t i = 1; i < count; ++i) {
+        grid.bounds = rect_boundary2(grid.bounds, rects[i]);
+    }
+
+    for (;;) {
+        grid.cols = (size_t) ceilf(grid.bounds.w / cell_size);
+        grid.rows = (size_t) ceilf(grid.bounds.h / cell_size);
+        if (grid.cols == 0) grid.cols = 1;
+        if (grid.rows == 0) grid.rows = 1;
+        if (grid.cols * grid.rows <= RECT_GRID_MAX_CELLS) break;
+        cell_size *= 2.0f;
+    }
+    grid.cell_size = cell_size;
+
+    const size_t cells_count = grid.cols * grid.rows;
+    grid.cells = nth_calloc(cells_count + 1, sizeof(grid.cells[0]));
+    if (grid.cells == NULL) {
+        return -1;
+    }
+
+    // Counting sort: first the amount of rects per cell, then their
+    // offsets, then the indices themselves
+    size_t items_count = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const RectGridSpan span = rect_grid_span(&grid, rects[i]);
+        for (size_t row = span.row_begin; row < span.row_end; ++row) {
+            for (size_t col = span.col_begin; col < span.col_end; ++col) {
+                grid.cells[row * grid.cols + col + 1]++;
+                items_count++;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < cells_count; ++i) {
+        grid.cells[i + 1] += grid.cells[i];
+    }
+
+    grid.items = nth_calloc(items_count > 0 ? items_count : 1, sizeof(grid.items[0]));
+    size_t *cursors = nth_calloc(cells_count, sizeof(cursors[0]));
+    if (grid.items == NULL || cursors == NULL) {
+        free(cursors);
+        destroy_rect_grid(grid);
+        return -1;
+    }
+    memcpy(cursors, grid.cells, sizeof(cursors[0]) * cells_count);
+
+    for (size_t i = 0; i < count; ++i) {
+        const RectGridSpan span = rect_grid_span(&grid, rects[i]);
+        for (size_t row = span.row_begin; row < span.row_end; ++row) {
+            for (size_t col = span.col_begin; col < span.col_end; ++col) {
+                grid.items[cursors[row * grid.cols + col]++] = i;
+            }
+        }
+    }
+
+    free(cursors);
+
+    *result = grid;
+    return 0;
+}
+
+void destroy_rect_grid(RectGrid grid)
+{
+    free(grid.cells);
+    free(grid.items);
+}
+
+RectGridSpan rect_grid_span(const RectGrid *grid, Rect area)
+{
+    trace_assert(grid);
+
+    RectGridSpan span;
+    memset(&span, 0, sizeof(span));
+
+    if (grid->cols == 0 || grid->rows == 0) {
+        return span;
+    }
+
+    if (area.x > grid->bounds.x + grid->bounds.w
+        || area.x + area.w < grid->bounds.x
+        || area.y > grid->bounds.y + grid->bounds.h
+        || area.y + area.h < grid->bounds.y) {
+        return span;
+    }
+
+    span.col_begin = rect_grid_col(grid, area.x);
+    span.col_end = rect_grid_col(grid, area.x + area.w) + 1;
+    span.row_begin = rect_grid_row(grid, area.y);
+    span.row_end = rect_grid_row(grid, area.y + area.h) + 1;
+
+    return span;
+}
+
+size_t rect_grid_cell(const RectGrid *grid,
+                      size_t col, size_t row,
+                      const size_t **items)
+{
+    trace_assert(grid);
+    trace_assert(items);
+    trace_assert(col < grid->cols);
+    trace_assert(row < grid->rows);
+
+    const size_t cell = row * grid->cols + col;
+    *items = grid->items + grid->cells[cell];
+    return grid->cells[cell + 1] - grid->cells[cell];
+}
+
+size_t rect_grid_at(const RectGrid *grid, Vec2f p, const size_t **items)
+{
+    trace_assert(grid);
+    trace_assert(items);
+
+    const RectGridSpan span = rect_grid_span(grid, rect(p.x, p.y, 0.0f, 0.0f));
+    if (span.col_begin == span.col_end) {
+        *items = NULL;
+        return 0;
+    }
+
+    return rect_grid_cell(grid, span.col_begin, span.row_begin, items);
+}
@@ -0,0 +1,46 @@
+#ifndef RECT_GRID_H_
+#define RECT_GRID_H_
+
+#include <stdlib.h>
+
+#include "math/rect.h"
+
+// Static spatial index of rects. Every rect is put into all of the
+// uniform grid cells it covers, so a query only has to look at the
+// rects of a few cells instead of all of them.
+typedef struct {
+    Rect bounds;
+    float cell_size;
+    size_t cols;
+    size_t rows;
+    // Indices of the rects in the cell (col, row) are
+    // items[cells[row * cols + col] .. cells[row * cols + col + 1]]
+    size_t *cells;
+    size_t *items;
+} RectGrid;
+
+// The cells covered by an area: [col_begin, col_end) x [row_begin, row_end)
+typedef struct {
+    size_t col_begin;
+    size_t col_end;
+    size_t row_begin;
+    size_t row_end;
+} RectGridSpan;
+
+// Returns -1 if the memory ran out. The grid is empty then, but it
+// can still be queried and destroyed.
+int create_rect_grid(RectGrid *grid, const Rect *rects, size_t count, float cell_size);
+void destroy_rect_grid(RectGrid grid);
+
+RectGridSpan rect_grid_span(const RectGrid *grid, Rect area);
+
+// Returns the amount of rects in the cell and points items to their indices
+size_t rect_grid_cell(const RectGrid *grid,
+                      size_t col, size_t row,
+                      const size_t **items);
+
+// Same as rect_grid_cell for the cell that contains the point. The
+// rects still have to be checked against the point itself.
+size_t rect_grid_at(const RectGrid *grid, Vec2f p, const size_t **items);
+
+#endif  // RECT_GRID_H_
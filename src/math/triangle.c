@@ -3,6 +3,7 @@
 
 #include "math/pi.h"
 #include "math/rand.h"
+#include "system/stacktrace.h"
 #include "triangle.h"
 
 Triangle triangle(Vec2f p1, Vec2f p2, Vec2f p3)
@@ -29,12 +30,22 @@ Triangle equilateral_triangle(void)
     return result;
 }
 
-Triangle random_triangle(float radius)
+Triangle random_triangle(Rng *rng, float radius)
 {
+    trace_assert(rng);
+
+    // The arguments are evaluated in an unspecified order, so the
+    // numbers are generated up front to keep the triangle the same
+    // with every compiler
+    float angles[3];
+    float radii[3];
+    rng_fill_float_range(rng, angles, 3, 0.0f, 2 * PI);
+    rng_fill_float_range(rng, radii, 3, 0.0f, radius);
+
     return triangle(
-        vec_from_polar(rand_float(2 * PI), rand_float(radius)),
-        vec_from_polar(rand_float(2 * PI), rand_float(radius)),
-        vec_from_polar(rand_float(2 * PI), rand_float(radius)));
+        vec_from_polar(angles[0], radii[0]),
+        vec_from_polar(angles[1], radii[1]),
+        vec_from_polar(angles[2], radii[2]));
 }
 
 static void swap_points(Vec2f *p1, Vec2f *p2)
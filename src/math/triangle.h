@@ -3,6 +3,7 @@
 
 #include "math/vec.h"
 #include "math/rect.h"
+#include "math/rand.h"
 
 typedef struct Triangle {
     Vec2f p1, p2, p3;
@@ -10,7 +11,7 @@ typedef struct Triangle {
 
 Triangle triangle(Vec2f p1, Vec2f p2, Vec2f p3);
 Triangle equilateral_triangle(void);
-Triangle random_triangle(float radius);
+Triangle random_triangle(Rng *rng, float radius);
 Triangle triangle_sorted_by_y(Triangle t);
 void rect_as_triangles(Rect rect, Triangle triangles[2]);
 
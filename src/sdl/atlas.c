@@ -0,0 +1,120 @@
+#include <SDL.h>
+
+#include "sdl/atlas.h"
+#include "system/log.h"
+#include "system/stacktrace.h"
+
+static
+int atlas_place(Atlas *atlas, const Texture_Image images[], size_t count)
+{
+    size_t order[ATLAS_CAPACITY];
+    for (size_t i = 0; i < count; ++i) {
+        order[i] = i;
+    }
+
+    // Insertion sort by height, there are only a handful of images
+    for (size_t i = 1; i < count; ++i) {
+        for (size_t j = i;
+             j > 0 && images[order[j - 1]].surface->h < images[order[j]].surface->h;
+             --j) {
+            const size_t t = order[j];
+            order[j] = order[j - 1];
+            order[j - 1] = t;
+        }
+    }
+
+    int x = ATLAS_PADDING;
+    int y = ATLAS_PADDING;
+    int shelf_height = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        const SDL_Surface *surface = images[order[i]].surface;
+
+        if (surface->w + 2 * ATLAS_PADDING > ATLAS_WIDTH) {
+            log_fail("Image %dx%d does not fit into the atlas\n",
+                     surface->w, surface->h);
+            return -1;
+        }
+
+        if (x + surface->w + ATLAS_PADDING > ATLAS_WIDTH) {
+            x = ATLAS_PADDING;
+            y += shelf_height + ATLAS_PADDING;
+            shelf_height = 0;
+        }
+
+        atlas->rects[order[i]] = (SDL_Rect) {x, y, surface->w, surface->h};
+        x += surface->w + ATLAS_PADDING;
+        if (surface->h > shelf_height) {
+            shelf_height = surface->h;
+        }
+    }
+
+    return y + shelf_height + ATLAS_PADDING;
+}
+
+int atlas_pack(Atlas *atlas,
+               Texture_Image images[],
+               size_t count,
+               SDL_Renderer *renderer)
+{
+    trace_assert(atlas);
+    trace_assert(images);
+    trace_assert(count <= ATLAS_CAPACITY);
+    trace_assert(renderer);
+
+    int result = -1;
+    SDL_Surface *surface = NULL;
+
+    for (size_t i = 0; i < count; ++i) {
+        if (images[i].surface == NULL) {
+            goto end;
+        }
+    }
+
+    const int height = atlas_place(atlas, images, count);
+    if (height < 0) {
+        goto end;
+    }
+
+    surface = SDL_CreateRGBSurfaceWithFormat(
+        0, ATLAS_WIDTH, height, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (surface == NULL) {
+        log_fail("SDL_CreateRGBSurfaceWithFormat: %s\n", SDL_GetError());
+        goto end;
+    }
+
+    // Fully transparent, so are the color keyed pixels of the images
+    // since the blits skip them
+    if (SDL_FillRect(surface, NULL, 0) < 0) {
+        log_fail("SDL_FillRect: %s\n", SDL_GetError());
+        goto end;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        SDL_SetSurfaceBlendMode(images[i].surface, SDL_BLENDMODE_NONE);
+        if (SDL_BlitSurface(images[i].surface, NULL, surface, &atlas->rects[i]) < 0) {
+            log_fail("SDL_BlitSurface: %s\n", SDL_GetError());
+            goto end;
+        }
+    }
+
+    atlas->texture = SDL_CreateTextureFromSurface(renderer, surface);
+    if (atlas->texture == NULL) {
+        log_fail("SDL_CreateTextureFromSurface: %s\n", SDL_GetError());
+        goto end;
+    }
+    atlas->count = count;
+
+    log_info("Packed %zu images into a %dx%d atlas\n", count, ATLAS_WIDTH, height);
+    result = 0;
+
+end:
+    if (surface != NULL) {
+        SDL_FreeSurface(surface);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        texture_image_free(&images[i]);
+    }
+
+    return result;
+}
@@ -0,0 +1,30 @@
+#ifndef ATLAS_H_
+#define ATLAS_H_
+
+#include <SDL.h>
+
+#include "sdl/texture.h"
+
+#define ATLAS_CAPACITY 16
+#define ATLAS_WIDTH 512
+// Empty pixels around every image, so nothing bleeds into its
+// neighbours when the texture is sampled
+#define ATLAS_PADDING 1
+
+// Several images packed into a single texture, so drawing any of them
+// does not switch textures
+typedef struct {
+    SDL_Texture *texture;
+    size_t count;
+    SDL_Rect rects[ATLAS_CAPACITY];
+} Atlas;
+
+// Places the images on shelves of an ATLAS_WIDTH wide texture, the
+// tallest first. rects[i] is where images[i] ended up. The images are
+// freed either way.
+int atlas_pack(Atlas *atlas,
+               Texture_Image images[],
+               size_t count,
+               SDL_Renderer *renderer);
+
+#endif  // ATLAS_H_
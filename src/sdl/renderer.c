@@ -135,6 +135,89 @@ int fill_triangle(SDL_Renderer *render,
     return 0;
 }
 
+#define SPAN_BATCH_CAPACITY 1024
+
+typedef struct {
+    SDL_Renderer *render;
+    int count;
+    SDL_Rect spans[SPAN_BATCH_CAPACITY];
+} SpanBatch;
+
+static int span_batch_flush(SpanBatch *batch)
+{
+    trace_assert(batch);
+
+    if (batch->count > 0) {
+        if (SDL_RenderFillRects(batch->render, batch->spans, batch->count) < 0) {
+            log_fail("SDL_RenderFillRects: %s\n", SDL_GetError());
+            return -1;
+        }
+        batch->count = 0;
+    }
+
+    return 0;
+}
+
+static int span_batch_push(SpanBatch *batch, float x0, float x1, int y)
+{
+    trace_assert(batch);
+
+    if (batch->count >= SPAN_BATCH_CAPACITY) {
+        if (span_batch_flush(batch) < 0) {
+            return -1;
+        }
+    }
+
+    const int left = (int) roundf(fminf(x0, x1));
+    const int right = (int) roundf(fmaxf(x0, x1));
+    const SDL_Rect span = {left, y, right - left + 1, 1};
+    batch->spans[batch->count++] = span;
+
+    return 0;
+}
+
+static float edge_x(Vec2f a, Vec2f b, float y)
+{
+    if (fabsf(b.y - a.y) < 1e-6f) {
+        return a.x;
+    }
+    return a.x + (y - a.y) * (b.x - a.x) / (b.y - a.y);
+}
+
+int fill_triangles(SDL_Renderer *render,
+                   const Triangle *ts,
+                   size_t count)
+{
+    trace_assert(render);
+    trace_assert(ts || count == 0);
+
+    SpanBatch batch;
+    batch.render = render;
+    batch.count = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        const Triangle t = triangle_sorted_by_y(ts[i]);
+        const int y0 = (int) roundf(t.p1.y);
+        const int y1 = (int) roundf(t.p3.y);
+
+        for (int y = y0; y <= y1; ++y) {
+            // Sample in the middle of the scanline, but never outside
+            // of the triangle, so the flat ones still get a span
+            const float sy = fminf(fmaxf((float) y, t.p1.y), t.p3.y);
+            const float long_x = edge_x(t.p1, t.p3, sy);
+            const float short_x = sy < t.p2.y
+                ? edge_x(t.p1, t.p2, sy)
+                : edge_x(t.p2, t.p3, sy);
+
+            if (span_batch_push(&batch, long_x, short_x, y) < 0) {
+                return -1;
+            }
+        }
+    }
+
+    return span_batch_flush(&batch);
+}
+
 int fill_rect(SDL_Renderer *render, Rect r, Color c)
 {
     const SDL_Rect sdl_rect = rect_for_sdl(r);
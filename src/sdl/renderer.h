@@ -14,6 +14,12 @@ int draw_triangle(SDL_Renderer *render,
 int fill_triangle(SDL_Renderer *render,
                   Triangle t);
 
+// Rasterizes all of the triangles into horizontal spans and submits
+// them with as few SDL_RenderFillRects calls as possible
+int fill_triangles(SDL_Renderer *render,
+                   const Triangle *ts,
+                   size_t count);
+
 int fill_rect(SDL_Renderer *render,
               Rect r,
               Color c);
@@ -1,42 +1,64 @@
 #include <SDL.h>
 
+#include "system/assets.h"
 #include "system/stacktrace.h"
 #include "system/log.h"
 #include "texture.h"
 
-SDL_Texture *texture_from_bmp(const char *bmp_file_name,
-                              SDL_Renderer *renderer)
+int texture_image_load(Texture_Image *image, const char *asset_name)
 {
-    trace_assert(bmp_file_name);
-    trace_assert(renderer);
+    trace_assert(image);
+    trace_assert(asset_name);
+
+    image->surface = NULL;
+    if (assets_open(asset_name, &image->asset) < 0) {
+        return -1;
+    }
 
-    SDL_Surface * surface = SDL_LoadBMP(bmp_file_name);
-    if (surface == NULL) {
-        log_fail("Could not load %s: %s\n", bmp_file_name, SDL_GetError());
+    image->surface = asset_surface(&image->asset);
+    if (image->surface == NULL) {
+        log_fail("Could not load %s: %s\n", asset_name, SDL_GetError());
         goto fail;
     }
 
-    if (SDL_SetColorKey(surface,
+    if (SDL_SetColorKey(image->surface,
                         SDL_TRUE,
-                        SDL_MapRGB(surface->format, 0, 0, 0)) < 0) {
+                        SDL_MapRGB(image->surface->format, 0, 0, 0)) < 0) {
         log_fail("SDL_SetColorKey: %s\n", SDL_GetError());
         goto fail;
     }
 
-    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
+    return 0;
+
+fail:
+    texture_image_free(image);
+    return -1;
+}
+
+SDL_Texture *texture_image_upload(Texture_Image *image,
+                                  SDL_Renderer *renderer)
+{
+    trace_assert(image);
+    trace_assert(image->surface);
+    trace_assert(renderer);
+
+    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, image->surface);
     if (texture == NULL) {
         log_fail("SDL_CreateTextureFromSurface: %s\n", SDL_GetError());
-        goto fail;
     }
 
-    SDL_FreeSurface(surface);
+    texture_image_free(image);
 
     return texture;
+}
 
-fail:
-    if (surface != NULL) {
-        SDL_FreeSurface(surface);
-    }
+void texture_image_free(Texture_Image *image)
+{
+    trace_assert(image);
 
-    return NULL;
+    if (image->surface != NULL) {
+        SDL_FreeSurface(image->surface);
+        image->surface = NULL;
+    }
+    assets_close(&image->asset);
 }
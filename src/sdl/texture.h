@@ -1,7 +1,24 @@
 #ifndef TEXTURE_H_
 #define TEXTURE_H_
 
-SDL_Texture *texture_from_bmp(const char *bmp_file_name,
-                              SDL_Renderer *renderer);
+#include <SDL.h>
+
+#include "system/assets.h"
+
+// An image that is decoded and ready to be uploaded. Loading an image
+// does not touch the renderer, so it can be done on any thread. Only
+// the upload has to happen on the render thread.
+typedef struct {
+    Asset asset;
+    SDL_Surface *surface;
+} Texture_Image;
+
+// The image is opened with assets_open, see system/assets.h. Black
+// is transparent in the loaded images.
+int texture_image_load(Texture_Image *image, const char *asset_name);
+// Frees the image whether the upload succeeds or not
+SDL_Texture *texture_image_upload(Texture_Image *image,
+                                  SDL_Renderer *renderer);
+void texture_image_free(Texture_Image *image);
 
 #endif  // TEXTURE_H_
@@ -0,0 +1,275 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "system/assets.h"
+#include "system/log.h"
+#include "system/nth_alloc.h"
+#include "system/stacktrace.h"
+
+#define ASSETS_FOLDER "./assets/"
+
+static uint8_t *assets_pack;
+static const Assets_Pack_Entry *assets_entries;
+static size_t assets_entries_count;
+static int assets_loose_override;
+
+static
+int assets_fail_pack(const char *pack_path, const char *reason)
+{
+    log_warn("Ignoring assets pack %s: %s\n", pack_path, reason);
+    free(assets_pack);
+    assets_pack = NULL;
+    return -1;
+}
+
+int assets_load_pack(const char *pack_path)
+{
+    trace_assert(pack_path);
+    trace_assert(assets_pack == NULL);
+
+    FILE *f = fopen(pack_path, "rb");
+    if (f == NULL) {
+        log_warn("Could not open assets pack %s, using the loose files\n", pack_path);
+        return -1;
+    }
+
+    long size = -1;
+    if (fseek(f, 0, SEEK_END) == 0) {
+        size = ftell(f);
+        fseek(f, 0, SEEK_SET);
+    }
+    if (size < (long) sizeof(Assets_Pack_Header)) {
+        fclose(f);
+        return assets_fail_pack(pack_path, "too small");
+    }
+
+    assets_pack = nth_calloc(1, (size_t) size);
+    if (assets_pack == NULL) {
+        fclose(f);
+        return -1;
+    }
+
+    const size_t n = fread(assets_pack, 1, (size_t) size, f);
+    fclose(f);
+    if (n != (size_t) size) {
+        return assets_fail_pack(pack_path, "could not read it");
+    }
+
+    Assets_Pack_Header header;
+    memcpy(&header, assets_pack, sizeof(header));
+    if (header.magic != ASSETS_PACK_MAGIC) {
+        return assets_fail_pack(pack_path, "not an assets pack");
+    }
+    if (header.version != ASSETS_PACK_VERSION) {
+        return assets_fail_pack(pack_path, "unsupported version");
+    }
+    if (sizeof(header) + header.count * sizeof(Assets_Pack_Entry) > (size_t) size) {
+        return assets_fail_pack(pack_path, "truncated index");
+    }
+
+    const Assets_Pack_Entry *entries =
+        (const Assets_Pack_Entry *) (const void *) (assets_pack + sizeof(header));
+    for (size_t i = 0; i < header.count; ++i) {
+        if ((size_t) entries[i].offset + entries[i].size > (size_t) size) {
+            return assets_fail_pack(pack_path, "truncated data");
+        }
+    }
+
+    assets_entries = entries;
+    assets_entries_count = header.count;
+
+    log_info("Loaded %zu assets from %s\n", assets_entries_count, pack_path);
+
+    return 0;
+}
+
+void assets_unload_pack(void)
+{
+    free(assets_pack);
+    assets_pack = NULL;
+    assets_entries = NULL;
+    assets_entries_count = 0;
+}
+
+void assets_set_loose_override(int enabled)
+{
+    assets_loose_override = enabled;
+}
+
+static
+int assets_open_packed(const char *name, Asset *asset)
+{
+    for (size_t i = 0; i < assets_entries_count; ++i) {
+        const Assets_Pack_Entry *entry = &assets_entries[i];
+        if (strncmp(entry->name, name, ASSETS_NAME_CAPACITY) != 0) {
+            continue;
+        }
+
+        memset(asset, 0, sizeof(*asset));
+        asset->kind = (Asset_Kind) entry->kind;
+        asset->data = assets_pack + entry->offset;
+        asset->size = entry->size;
+        asset->width = (int) entry->width;
+        asset->height = (int) entry->height;
+        asset->pitch = (int) entry->pitch;
+        asset->spec.freq = (int) entry->freq;
+        asset->spec.format = (SDL_AudioFormat) entry->format;
+        asset->spec.channels = (Uint8) entry->channels;
+        return 0;
+    }
+
+    return -1;
+}
+
+static
+Asset_Kind asset_kind_of_name(const char *name)
+{
+    const char *ext = strrchr(name, '.');
+    if (ext == NULL) {
+        return ASSET_KIND_RAW;
+    }
+
+    if (strcmp(ext, ".bmp") == 0) {
+        return ASSET_KIND_IMAGE;
+    } else if (strcmp(ext, ".wav") == 0) {
+        return ASSET_KIND_SOUND;
+    }
+
+    return ASSET_KIND_RAW;
+}
+
+static
+int assets_open_loose(const char *name, Asset *asset)
+{
+    char path[sizeof(ASSETS_FOLDER) + ASSETS_NAME_CAPACITY];
+    snprintf(path, sizeof(path), "%s%s", ASSETS_FOLDER, name);
+
+    memset(asset, 0, sizeof(*asset));
+    asset->kind = asset_kind_of_name(name);
+
+    switch (asset->kind) {
+    case ASSET_KIND_IMAGE: {
+        SDL_Surface *bmp = SDL_LoadBMP(path);
+        if (bmp == NULL) {
+            return -1;
+        }
+
+        // Converted to the same format the packed images have
+        SDL_Surface *surface = SDL_ConvertSurfaceFormat(bmp, SDL_PIXELFORMAT_ARGB8888, 0);
+        SDL_FreeSurface(bmp);
+        if (surface == NULL) {
+            return -1;
+        }
+
+        asset->loose = surface;
+        asset->data = surface->pixels;
+        asset->width = surface->w;
+        asset->height = surface->h;
+        asset->pitch = surface->pitch;
+        asset->size = (size_t) (surface->pitch * surface->h);
+    } break;
+
+    case ASSET_KIND_SOUND: {
+        Uint8 *samples = NULL;
+        Uint32 samples_size = 0;
+        if (SDL_LoadWAV(path, &asset->spec, &samples, &samples_size) == NULL) {
+            return -1;
+        }
+
+        asset->loose = samples;
+        asset->data = samples;
+        asset->size = samples_size;
+    } break;
+
+    case ASSET_KIND_RAW: {
+        FILE *f = fopen(path, "rb");
+        if (f == NULL) {
+            SDL_SetError("Could not open %s", path);
+            return -1;
+        }
+
+        long size = -1;
+        if (fseek(f, 0, SEEK_END) == 0) {
+            size = ftell(f);
+            fseek(f, 0, SEEK_SET);
+        }
+
+        void *data = size >= 0 ? malloc((size_t) size + 1) : NULL;
+        if (data == NULL || fread(data, 1, (size_t) size, f) != (size_t) size) {
+            SDL_SetError("Could not read %s", path);
+            free(data);
+            fclose(f);
+            return -1;
+        }
+        fclose(f);
+
+        asset->loose = data;
+        asset->data = data;
+        asset->size = (size_t) size;
+    } break;
+    }
+
+    return 0;
+}
+
+int assets_open(const char *name, Asset *asset)
+{
+    trace_assert(name);
+    trace_assert(asset);
+
+    if (strlen(name) >= ASSETS_NAME_CAPACITY) {
+        log_fail("Asset name %s is too long\n", name);
+        return -1;
+    }
+
+    if (assets_loose_override && assets_open_loose(name, asset) == 0) {
+        return 0;
+    }
+
+    if (assets_open_packed(name, asset) == 0) {
+        return 0;
+    }
+
+    if (!assets_loose_override && assets_open_loose(name, asset) == 0) {
+        return 0;
+    }
+
+    log_fail("Could not open asset %s: %s\n", name, SDL_GetError());
+    return -1;
+}
+
+void assets_close(Asset *asset)
+{
+    trace_assert(asset);
+
+    if (asset->loose != NULL) {
+        switch (asset->kind) {
+        case ASSET_KIND_IMAGE:
+            SDL_FreeSurface(asset->loose);
+            break;
+        case ASSET_KIND_SOUND:
+            SDL_FreeWAV(asset->loose);
+            break;
+        case ASSET_KIND_RAW:
+            free(asset->loose);
+            break;
+        }
+    }
+
+    memset(asset, 0, sizeof(*asset));
+}
+
+SDL_Surface *asset_surface(const Asset *asset)
+{
+    trace_assert(asset);
+    trace_assert(asset->kind == ASSET_KIND_IMAGE);
+
+    return SDL_CreateRGBSurfaceWithFormatFrom(
+        asset->data,
+        asset->width,
+        asset->height,
+        32,
+        asset->pitch,
+        SDL_PIXELFORMAT_ARGB8888);
+}
@@ -0,0 +1,82 @@
+#ifndef ASSETS_H_
+#define ASSETS_H_
+
+#include <stdint.h>
+
+#include <SDL.h>
+
+// The assets are packed into a single file at build time (see
+// tools/pack_assets.c). The images are stored already decoded as
+// ARGB8888 pixels and the sounds as raw PCM, so opening an asset is a
+// lookup in the index. The whole pack is read with a single fread.
+//
+// The assets are named by their path relative to the assets folder,
+// e.g. "images/cursor.bmp". Anything missing from the pack is loaded
+// from the loose file, and with the loose override enabled the loose
+// files always take precedence, so the assets can be edited without
+// repacking.
+
+#define ASSETS_PACK_MAGIC 0x4b50544e // "NTPK"
+#define ASSETS_PACK_VERSION 1
+#define ASSETS_NAME_CAPACITY 64
+// Every asset starts at an offset aligned to that
+#define ASSETS_PACK_ALIGNMENT 16
+
+typedef enum {
+    ASSET_KIND_RAW = 0,
+    ASSET_KIND_IMAGE,
+    ASSET_KIND_SOUND
+} Asset_Kind;
+
+// The pack file is the header, followed by count entries, followed by
+// the data. It uses the native byte order, since it is produced by
+// the same build.
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t count;
+    uint32_t reserved;
+} Assets_Pack_Header;
+
+typedef struct {
+    char name[ASSETS_NAME_CAPACITY];
+    uint32_t kind;
+    uint32_t offset;
+    uint32_t size;
+    // ASSET_KIND_IMAGE
+    uint32_t width;
+    uint32_t height;
+    uint32_t pitch;
+    // ASSET_KIND_SOUND
+    uint32_t freq;
+    uint32_t format;
+    uint32_t channels;
+} Assets_Pack_Entry;
+
+typedef struct {
+    Asset_Kind kind;
+    void *data;
+    size_t size;
+    // ASSET_KIND_IMAGE, always SDL_PIXELFORMAT_ARGB8888
+    int width;
+    int height;
+    int pitch;
+    // ASSET_KIND_SOUND
+    SDL_AudioSpec spec;
+    // Whatever owns the data of a loose asset. NULL for packed assets,
+    // which live as long as the pack.
+    void *loose;
+} Asset;
+
+int assets_load_pack(const char *pack_path);
+void assets_unload_pack(void);
+void assets_set_loose_override(int enabled);
+
+int assets_open(const char *name, Asset *asset);
+void assets_close(Asset *asset);
+
+// The surface points to the pixels of the asset, so it must be freed
+// before the asset is closed
+SDL_Surface *asset_surface(const Asset *asset);
+
+#endif  // ASSETS_H_
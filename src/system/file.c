@@ -96,3 +96,20 @@ end:
     if (f) fclose(f);
     return result;
 }
+
+int make_directory(const char *dirpath)
+{
+    trace_assert(dirpath);
+
+#ifdef _WIN32
+    if (!CreateDirectory(dirpath, NULL) && GetLastError() != ERROR_ALREADY_EXISTS) {
+        return -1;
+    }
+#else
+    if (mkdir(dirpath, 0755) < 0 && errno != EEXIST) {
+        return -1;
+    }
+#endif
+
+    return 0;
+}
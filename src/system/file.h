@@ -8,6 +8,7 @@
 #endif
 #ifndef _WIN32
 #include <dirent.h>
+#include <sys/stat.h>
 #endif
 
 #include "system/s.h"
@@ -27,4 +28,7 @@ void closedir(DIR *dirp);
 
 String read_whole_file(Memory *memory, const char *filepath);
 
+// Succeeds if the directory already exists
+int make_directory(const char *dirpath);
+
 #endif  // FILE_H_
@@ -0,0 +1,177 @@
+#include <SDL.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "./id_table.h"
+#include "system/s.h"
+#include "system/stacktrace.h"
+
+#define ID_TABLE_CHUNK_SIZE (64 * 1024)
+#define ID_TABLE_INITIAL_CAPACITY 256
+
+// Strings live in chunks that are never moved, so the pointers handed
+// out by id_table_cstr stay valid while the table grows
+typedef struct IdChunk {
+    struct IdChunk *next;
+    size_t size;
+    char data[ID_TABLE_CHUNK_SIZE];
+} IdChunk;
+
+static struct {
+    SDL_SpinLock lock;
+
+    IdChunk *chunks;
+
+    // strings[id] is the string of the id. strings[ID_NONE] is unused.
+    const char **strings;
+    uint32_t *hashes;
+    size_t count;
+    size_t capacity;
+
+    // Open addressing with linear probing. ID_NONE is an empty slot.
+    Id *slots;
+    size_t slots_capacity;
+} id_table = {0};
+
+static
+size_t id_table_slot(const char *id, uint32_t hash)
+{
+    const size_t mask = id_table.slots_capacity - 1;
+    size_t slot = hash & mask;
+    while (id_table.slots[slot] != ID_NONE) {
+        const Id candidate = id_table.slots[slot];
+        if (id_table.hashes[candidate] == hash
+            && strcmp(id_table.strings[candidate], id) == 0) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+static
+const char *id_table_copy_string(const char *id)
+{
+    const size_t size = strlen(id) + 1;
+    trace_assert(size <= ID_TABLE_CHUNK_SIZE);
+
+    if (id_table.chunks == NULL || id_table.chunks->size + size > ID_TABLE_CHUNK_SIZE) {
+        IdChunk *chunk = malloc(sizeof(IdChunk));
+        trace_assert(chunk);
+        chunk->next = id_table.chunks;
+        chunk->size = 0;
+        id_table.chunks = chunk;
+    }
+
+    char *result = id_table.chunks->data + id_table.chunks->size;
+    memcpy(result, id, size);
+    id_table.chunks->size += size;
+    return result;
+}
+
+static
+void id_table_grow(void)
+{
+    if (id_table.count + 1 >= id_table.capacity) {
+        id_table.capacity = id_table.capacity == 0
+            ? ID_TABLE_INITIAL_CAPACITY
+            : id_table.capacity * 2;
+        id_table.strings = realloc(id_table.strings, sizeof(id_table.strings[0]) * id_table.capacity);
+        id_table.hashes = realloc(id_table.hashes, sizeof(id_table.hashes[0]) * id_table.capacity);
+        trace_assert(id_table.strings);
+        trace_assert(id_table.hashes);
+    }
+
+    // Keep the load factor under 1/2
+    if ((id_table.count + 1) * 2 >= id_table.slots_capacity) {
+        free(id_table.slots);
+        id_table.slots_capacity = id_table.slots_capacity == 0
+            ? ID_TABLE_INITIAL_CAPACITY * 2
+            : id_table.slots_capacity * 2;
+        id_table.slots = calloc(id_table.slots_capacity, sizeof(id_table.slots[0]));
+        trace_assert(id_table.slots);
+
+        const size_t mask = id_table.slots_capacity - 1;
+        for (Id id = 1; id <= id_table.count; ++id) {
+            size_t slot = id_table.hashes[id] & mask;
+            while (id_table.slots[slot] != ID_NONE) {
+                slot = (slot + 1) & mask;
+            }
+            id_table.slots[slot] = id;
+        }
+    }
+}
+
+Id id_table_intern(const char *id)
+{
+    trace_assert(id);
+
+    const uint32_t hash = string_hash(string_nt(id));
+
+    SDL_AtomicLock(&id_table.lock);
+
+    id_table_grow();
+
+    const size_t slot = id_table_slot(id, hash);
+    if (id_table.slots[slot] == ID_NONE) {
+        const Id result = (Id) ++id_table.count;
+        id_table.strings[result] = id_table_copy_string(id);
+        id_table.hashes[result] = hash;
+        id_table.slots[slot] = result;
+    }
+    const Id result = id_table.slots[slot];
+
+    SDL_AtomicUnlock(&id_table.lock);
+
+    return result;
+}
+
+Id id_table_find(const char *id)
+{
+    trace_assert(id);
+
+    const uint32_t hash = string_hash(string_nt(id));
+    Id result = ID_NONE;
+
+    SDL_AtomicLock(&id_table.lock);
+    if (id_table.slots_capacity > 0) {
+        result = id_table.slots[id_table_slot(id, hash)];
+    }
+    SDL_AtomicUnlock(&id_table.lock);
+
+    return result;
+}
+
+const char *id_table_cstr(Id id)
+{
+    SDL_AtomicLock(&id_table.lock);
+    trace_assert(id != ID_NONE && id <= id_table.count);
+    const char *result = id_table.strings[id];
+    SDL_AtomicUnlock(&id_table.lock);
+
+    return result;
+}
+
+void id_table_free(void)
+{
+    SDL_AtomicLock(&id_table.lock);
+
+    while (id_table.chunks != NULL) {
+        IdChunk *next = id_table.chunks->next;
+        free(id_table.chunks);
+        id_table.chunks = next;
+    }
+
+    free(id_table.strings);
+    free(id_table.hashes);
+    free(id_table.slots);
+
+    id_table.strings = NULL;
+    id_table.hashes = NULL;
+    id_table.slots = NULL;
+    id_table.count = 0;
+    id_table.capacity = 0;
+    id_table.slots_capacity = 0;
+
+    SDL_AtomicUnlock(&id_table.lock);
+}
@@ -0,0 +1,24 @@
+#ifndef ID_TABLE_H_
+#define ID_TABLE_H_
+
+#include <stdint.h>
+
+// Process wide table of interned entity ids. Every distinct id string
+// gets a small integer handle, so the runtime structures can store and
+// compare the handles instead of the strings. The table is safe to use
+// from several threads.
+
+typedef uint32_t Id;
+
+// Never returned for an interned string
+#define ID_NONE 0
+
+Id id_table_intern(const char *id);
+// Returns ID_NONE if the string was never interned
+Id id_table_find(const char *id);
+// The string stays valid until id_table_free
+const char *id_table_cstr(Id id);
+
+void id_table_free(void);
+
+#endif  // ID_TABLE_H_
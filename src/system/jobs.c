@@ -0,0 +1,433 @@
+#include <stdlib.h>
+
+#include "./jobs.h"
+#include "system/log.h"
+#include "system/lt.h"
+#include "system/nth_alloc.h"
+#include "system/stacktrace.h"
+
+#define JOBS_DEQUE_CAPACITY 1024
+#define JOBS_DEFERRED_CAPACITY 256
+#define JOBS_MAX_WORKERS 63
+// How long an idle worker sleeps before checking the deques again in
+// case it missed a wake up. In milliseconds.
+#define JOBS_IDLE_TIMEOUT 2
+// How many ranges per thread jobs_parallel_for makes when grain == 0
+#define JOBS_PARALLEL_FOR_SPLIT 4
+
+typedef struct {
+    Job job;
+    Job_Counter *counter;
+} Job_Entry;
+
+typedef struct {
+    Job_Entry entry;
+    Job_Counter *dependency;
+} Deferred_Job;
+
+// The owner pushes and pops at the bottom, the thieves take from the
+// top. top and bottom only grow and are wrapped on access.
+typedef struct {
+    SDL_SpinLock lock;
+    size_t top;
+    size_t bottom;
+    Job_Entry entries[JOBS_DEQUE_CAPACITY];
+} Job_Deque;
+
+typedef struct {
+    Jobs *jobs;
+    size_t index;
+    SDL_Thread *thread;
+    // Written by the worker itself before create_jobs returns (see
+    // started), so everybody who gets the Jobs sees all of them
+    SDL_threadID id;
+} Job_Worker;
+
+struct Jobs
+{
+    Lt *lt;
+
+    size_t workers_count;
+    Job_Worker *workers;
+    // workers_count + 1 deques. The last one belongs to the thread
+    // that created Jobs and to any other thread that is not a worker.
+    Job_Deque *deques;
+
+    SDL_atomic_t quit;
+    SDL_atomic_t sleeping;
+    SDL_sem *wake;
+    // Posted by every worker once its id is set
+    SDL_sem *started;
+
+    SDL_SpinLock deferred_lock;
+    size_t deferred_count;
+    Deferred_Job deferred[JOBS_DEFERRED_CAPACITY];
+};
+
+static
+int job_deque_push(Job_Deque *deque, Job_Entry entry)
+{
+    int result = -1;
+
+    SDL_AtomicLock(&deque->lock);
+    if (deque->bottom - deque->top < JOBS_DEQUE_CAPACITY) {
+        deque->entries[deque->bottom % JOBS_DEQUE_CAPACITY] = entry;
+        deque->bottom++;
+        result = 0;
+    }
+    SDL_AtomicUnlock(&deque->lock);
+
+    return result;
+}
+
+static
+int job_deque_pop(Job_Deque *deque, Job_Entry *entry)
+{
+    int result = 0;
+
+    SDL_AtomicLock(&deque->lock);
+    if (deque->bottom > deque->top) {
+        deque->bottom--;
+        *entry = deque->entries[deque->bottom % JOBS_DEQUE_CAPACITY];
+        result = 1;
+    }
+    SDL_AtomicUnlock(&deque->lock);
+
+    return result;
+}
+
+static
+int job_deque_steal(Job_Deque *deque, Job_Entry *entry)
+{
+    int result = 0;
+
+    SDL_AtomicLock(&deque->lock);
+    if (deque->bottom > deque->top) {
+        *entry = deque->entries[deque->top % JOBS_DEQUE_CAPACITY];
+        deque->top++;
+        result = 1;
+    }
+    SDL_AtomicUnlock(&deque->lock);
+
+    return result;
+}
+
+static
+size_t jobs_current_deque(const Jobs *jobs)
+{
+    trace_assert(jobs);
+
+    const SDL_threadID id = SDL_ThreadID();
+    for (size_t i = 0; i < jobs->workers_count; ++i) {
+        if (jobs->workers[i].id == id) {
+            return i;
+        }
+    }
+
+    return jobs->workers_count;
+}
+
+static void jobs_push(Jobs *jobs, size_t index, Job_Entry entry);
+
+static
+void jobs_release_deferred(Jobs *jobs, size_t index)
+{
+    trace_assert(jobs);
+
+    Job_Entry ready[JOBS_DEFERRED_CAPACITY];
+    size_t ready_count = 0;
+
+    SDL_AtomicLock(&jobs->deferred_lock);
+    for (size_t i = 0; i < jobs->deferred_count;) {
+        if (SDL_AtomicGet(&jobs->deferred[i].dependency->pending) == 0) {
+            ready[ready_count++] = jobs->deferred[i].entry;
+            jobs->deferred[i] = jobs->deferred[--jobs->deferred_count];
+        } else {
+            ++i;
+        }
+    }
+    SDL_AtomicUnlock(&jobs->deferred_lock);
+
+    for (size_t i = 0; i < ready_count; ++i) {
+        jobs_push(jobs, index, ready[i]);
+    }
+}
+
+static
+void jobs_execute(Jobs *jobs, size_t index, Job_Entry entry)
+{
+    entry.job.func(entry.job.data, entry.job.begin, entry.job.end);
+
+    if (entry.counter != NULL
+        && SDL_AtomicAdd(&entry.counter->pending, -1) == 1
+        && jobs != NULL) {
+        jobs_release_deferred(jobs, index);
+    }
+}
+
+static
+void jobs_push(Jobs *jobs, size_t index, Job_Entry entry)
+{
+    trace_assert(jobs);
+
+    if (job_deque_push(&jobs->deques[index], entry) < 0) {
+        // The deque is full. Doing the job right away is as good as
+        // any other place to put it.
+        jobs_execute(jobs, index, entry);
+        return;
+    }
+
+    if (SDL_AtomicGet(&jobs->sleeping) > 0) {
+        SDL_SemPost(jobs->wake);
+    }
+}
+
+static
+int jobs_run_one(Jobs *jobs, size_t index)
+{
+    trace_assert(jobs);
+
+    Job_Entry entry;
+    if (job_deque_pop(&jobs->deques[index], &entry)) {
+        jobs_execute(jobs, index, entry);
+        return 1;
+    }
+
+    const size_t deques_count = jobs->workers_count + 1;
+    for (size_t i = 1; i < deques_count; ++i) {
+        if (job_deque_steal(&jobs->deques[(index + i) % deques_count], &entry)) {
+            jobs_execute(jobs, index, entry);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static
+int jobs_worker(void *data)
+{
+    Job_Worker *worker = data;
+    trace_assert(worker);
+    Jobs *jobs = worker->jobs;
+
+    worker->id = SDL_ThreadID();
+    SDL_SemPost(jobs->started);
+
+    while (!SDL_AtomicGet(&jobs->quit)) {
+        if (jobs_run_one(jobs, worker->index)) {
+            continue;
+        }
+
+        // Check the deques once more after announcing the sleep,
+        // otherwise a job pushed in between would not wake us up.
+        SDL_AtomicIncRef(&jobs->sleeping);
+        if (!jobs_run_one(jobs, worker->index)) {
+            SDL_SemWaitTimeout(jobs->wake, JOBS_IDLE_TIMEOUT);
+        }
+        SDL_AtomicAdd(&jobs->sleeping, -1);
+    }
+
+    return 0;
+}
+
+static
+void jobs_stop_workers(Jobs *jobs)
+{
+    trace_assert(jobs);
+
+    SDL_AtomicSet(&jobs->quit, 1);
+    for (size_t i = 0; i < jobs->workers_count; ++i) {
+        SDL_SemPost(jobs->wake);
+    }
+
+    for (size_t i = 0; i < jobs->workers_count; ++i) {
+        if (jobs->workers[i].thread != NULL) {
+            SDL_WaitThread(jobs->workers[i].thread, NULL);
+            jobs->workers[i].thread = NULL;
+        }
+    }
+}
+
+size_t jobs_default_workers_count(void)
+{
+    const int cpu_count = SDL_GetCPUCount();
+    return cpu_count > 1 ? (size_t) (cpu_count - 1) : 0;
+}
+
+Jobs *create_jobs(size_t workers_count)
+{
+    Lt *lt = create_lt();
+
+    Jobs *jobs = PUSH_LT(lt, nth_calloc(1, sizeof(Jobs)), free);
+    if (jobs == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+    jobs->lt = lt;
+
+    if (workers_count > JOBS_MAX_WORKERS) {
+        workers_count = JOBS_MAX_WORKERS;
+    }
+    jobs->workers_count = workers_count;
+
+    jobs->deques = PUSH_LT(lt, nth_calloc(workers_count + 1, sizeof(Job_Deque)), free);
+    if (jobs->deques == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+
+    jobs->wake = PUSH_LT(lt, SDL_CreateSemaphore(0), SDL_DestroySemaphore);
+    if (jobs->wake == NULL) {
+        log_fail("Could not create the semaphore for the jobs: %s\n", SDL_GetError());
+        RETURN_LT(lt, NULL);
+    }
+
+    jobs->started = PUSH_LT(lt, SDL_CreateSemaphore(0), SDL_DestroySemaphore);
+    if (jobs->started == NULL) {
+        log_fail("Could not create the semaphore for the jobs: %s\n", SDL_GetError());
+        RETURN_LT(lt, NULL);
+    }
+
+    if (workers_count > 0) {
+        jobs->workers = PUSH_LT(lt, nth_calloc(workers_count, sizeof(Job_Worker)), free);
+        if (jobs->workers == NULL) {
+            RETURN_LT(lt, NULL);
+        }
+    }
+
+    // Destroyed first, so the workers are stopped before their memory
+    // is freed
+    PUSH_LT(lt, jobs, jobs_stop_workers);
+
+    for (size_t i = 0; i < workers_count; ++i) {
+        jobs->workers[i].jobs = jobs;
+        jobs->workers[i].index = i;
+        jobs->workers[i].thread = SDL_CreateThread(jobs_worker, "Job Worker", &jobs->workers[i]);
+        if (jobs->workers[i].thread == NULL) {
+            log_fail("Could not create a job worker: %s\n", SDL_GetError());
+            RETURN_LT(lt, NULL);
+        }
+    }
+
+    // No job can be submitted before this returns, so no worker looks
+    // up the ids (see jobs_current_deque) before they are all set
+    for (size_t i = 0; i < workers_count; ++i) {
+        SDL_SemWait(jobs->started);
+    }
+
+    log_info("Started %lu job workers\n", (unsigned long) workers_count);
+
+    return jobs;
+}
+
+void destroy_jobs(Jobs *jobs)
+{
+    trace_assert(jobs);
+    RETURN_LT0(jobs->lt);
+}
+
+size_t jobs_workers_count(const Jobs *jobs)
+{
+    return jobs != NULL ? jobs->workers_count : 0;
+}
+
+void jobs_submit(Jobs *jobs, Job j, Job_Counter *counter)
+{
+    trace_assert(j.func);
+
+    if (counter != NULL) {
+        SDL_AtomicIncRef(&counter->pending);
+    }
+
+    Job_Entry entry = {j, counter};
+
+    if (jobs == NULL) {
+        jobs_execute(NULL, 0, entry);
+        return;
+    }
+
+    jobs_push(jobs, jobs_current_deque(jobs), entry);
+}
+
+void jobs_submit_after(Jobs *jobs, Job j, Job_Counter *counter,
+                       Job_Counter *dependency)
+{
+    trace_assert(j.func);
+    trace_assert(dependency);
+
+    if (jobs == NULL) {
+        trace_assert(SDL_AtomicGet(&dependency->pending) == 0);
+        jobs_submit(jobs, j, counter);
+        return;
+    }
+
+    if (counter != NULL) {
+        SDL_AtomicIncRef(&counter->pending);
+    }
+
+    Job_Entry entry = {j, counter};
+
+    // The dependency is checked under the lock, so whoever finishes
+    // its last job either sees the deferred job or we see zero here.
+    SDL_AtomicLock(&jobs->deferred_lock);
+    const int deferred = SDL_AtomicGet(&dependency->pending) > 0
+        && jobs->deferred_count < JOBS_DEFERRED_CAPACITY;
+    if (deferred) {
+        jobs->deferred[jobs->deferred_count].entry = entry;
+        jobs->deferred[jobs->deferred_count].dependency = dependency;
+        jobs->deferred_count++;
+    }
+    SDL_AtomicUnlock(&jobs->deferred_lock);
+
+    if (!deferred) {
+        // Either the dependency is already satisfied or there is no
+        // space left to defer the job
+        jobs_wait(jobs, dependency);
+        jobs_push(jobs, jobs_current_deque(jobs), entry);
+    }
+}
+
+void jobs_wait(Jobs *jobs, Job_Counter *counter)
+{
+    trace_assert(counter);
+
+    if (jobs == NULL) {
+        trace_assert(SDL_AtomicGet(&counter->pending) == 0);
+        return;
+    }
+
+    const size_t index = jobs_current_deque(jobs);
+    while (SDL_AtomicGet(&counter->pending) > 0) {
+        if (!jobs_run_one(jobs, index)) {
+            // The rest of the jobs are being done by the workers
+            SDL_Delay(0);
+        }
+    }
+}
+
+void jobs_parallel_for(Jobs *jobs,
+                       Job_Func func, void *data,
+                       size_t count, size_t grain)
+{
+    trace_assert(func);
+
+    if (count == 0) {
+        return;
+    }
+
+    if (grain == 0) {
+        const size_t ranges_count = (jobs_workers_count(jobs) + 1) * JOBS_PARALLEL_FOR_SPLIT;
+        grain = (count + ranges_count - 1) / ranges_count;
+    }
+
+    if (jobs == NULL || jobs->workers_count == 0 || grain >= count) {
+        func(data, 0, count);
+        return;
+    }
+
+    Job_Counter counter = {{0}};
+    for (size_t begin = 0; begin < count; begin += grain) {
+        const size_t end = count - begin > grain ? begin + grain : count;
+        jobs_submit(jobs, job(func, data, begin, end), &counter);
+    }
+    jobs_wait(jobs, &counter);
+}
@@ -0,0 +1,69 @@
+#ifndef JOBS_H_
+#define JOBS_H_
+
+#include <stddef.h>
+#include <SDL.h>
+
+// Work-stealing thread pool. Every worker owns a deque of jobs: it
+// pushes and pops at the bottom of its own deque and steals from the
+// top of the others when it runs out of work. The thread that created
+// the pool has a deque too and takes part in the work whenever it
+// waits for something (see jobs_wait).
+//
+// All the functions accept jobs == NULL, in which case the work is
+// done right away on the calling thread.
+
+typedef struct Jobs Jobs;
+
+typedef void (*Job_Func)(void *data, size_t begin, size_t end);
+
+typedef struct {
+    Job_Func func;
+    void *data;
+    size_t begin;
+    size_t end;
+} Job;
+
+// Number of submitted jobs that are not finished yet. Must be zero
+// initialized.
+typedef struct {
+    SDL_atomic_t pending;
+} Job_Counter;
+
+static inline
+Job job(Job_Func func, void *data, size_t begin, size_t end)
+{
+    Job result = {
+        .func = func,
+        .data = data,
+        .begin = begin,
+        .end = end
+    };
+    return result;
+}
+
+size_t jobs_default_workers_count(void);
+
+Jobs *create_jobs(size_t workers_count);
+void destroy_jobs(Jobs *jobs);
+
+size_t jobs_workers_count(const Jobs *jobs);
+
+// counter may be NULL if nobody is going to wait for the job
+void jobs_submit(Jobs *jobs, Job j, Job_Counter *counter);
+// The job is not started until dependency drops to zero. The jobs of
+// the dependency must be already submitted.
+void jobs_submit_after(Jobs *jobs, Job j, Job_Counter *counter,
+                       Job_Counter *dependency);
+
+// Runs pending jobs on the calling thread until counter drops to zero
+void jobs_wait(Jobs *jobs, Job_Counter *counter);
+
+// Splits [0, count) into ranges of at most grain elements, runs them
+// in parallel and waits for all of them. grain == 0 picks the range
+// size based on the amount of workers.
+void jobs_parallel_for(Jobs *jobs,
+                       Job_Func func, void *data,
+                       size_t count, size_t grain);
+
+#endif  // JOBS_H_
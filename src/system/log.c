@@ -1,28 +1,354 @@
 #include <stdarg.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 
+#include <SDL.h>
+
 #include "./log.h"
 
-#define SEVERITY_FAIL "FAIL"
-#define SEVERITY_WARN "WARN"
-#define SEVERITY_INFO "INFO"
+// Must be a power of two, so the positions can wrap around
+#define LOG_RING_CAPACITY 256
+#define LOG_MESSAGE_CAPACITY 256
+// How often the flusher wakes up on its own, in milliseconds
+#define LOG_FLUSH_INTERVAL 10
+#define LOG_RATE_LIMIT_SLOTS 64
+// How many slots after its home one a call site is looked for in
+#define LOG_RATE_LIMIT_PROBES 8
+#define LOG_RATE_LIMIT_BURST 10
+#define LOG_RATE_LIMIT_WINDOW 1000
+
+static const char *const severity_names[] = {
+    [LOG_SEVERITY_INFO] = "INFO",
+    [LOG_SEVERITY_WARN] = "WARN",
+    [LOG_SEVERITY_FAIL] = "FAIL"
+};
+
+// The state of a slot is 2 * lap when it's free for the producer of
+// that lap and 2 * lap + 1 when its message is ready for the consumer
+// of that lap, where lap = position / LOG_RING_CAPACITY.
+typedef struct {
+    SDL_atomic_t state;
+    Log_Severity severity;
+    Uint32 ticks;
+    char message[LOG_MESSAGE_CAPACITY];
+} Log_Entry;
+
+// NULL format is a free slot
+typedef struct {
+    const char *format;
+    Log_Severity severity;
+    Uint32 window_begin;
+    int count;
+    int suppressed;
+} Log_Rate;
+
+static Log_Entry log_ring[LOG_RING_CAPACITY];
+static SDL_atomic_t log_head;
+static SDL_atomic_t log_tail;
+static SDL_atomic_t log_dropped;
+static SDL_atomic_t log_min_severity;
+// Only one thread at a time consumes the ring
+static SDL_SpinLock log_consumer_lock;
+
+static SDL_atomic_t log_started;
+static SDL_atomic_t log_quit;
+static SDL_sem *log_wake;
+static SDL_Thread *log_flusher;
+
+static SDL_SpinLock log_rate_lock;
+static Log_Rate log_rates[LOG_RATE_LIMIT_SLOTS];
+
+static unsigned int log_lap_state(unsigned int position, unsigned int ready)
+{
+    return position / LOG_RING_CAPACITY * 2 + ready;
+}
+
+static void log_write(Log_Severity severity, Uint32 ticks, const char *message)
+{
+    fprintf(stderr, "[%5u.%03u] [%s] %s",
+            ticks / 1000, ticks % 1000,
+            severity_names[severity],
+            message);
+}
+
+static int log_push(Log_Severity severity, Uint32 ticks, const char *format, va_list args)
+{
+    unsigned int position = (unsigned int) SDL_AtomicGet(&log_head);
+
+    for (;;) {
+        Log_Entry *entry = &log_ring[position % LOG_RING_CAPACITY];
+        const unsigned int state = (unsigned int) SDL_AtomicGet(&entry->state);
+        const int diff = (int) (state - log_lap_state(position, 0));
+
+        if (diff == 0) {
+            if (SDL_AtomicCAS(&log_head, (int) position, (int) (position + 1))) {
+                entry->severity = severity;
+                entry->ticks = ticks;
+                vsnprintf(entry->message, LOG_MESSAGE_CAPACITY, format, args);
+                SDL_AtomicSet(&entry->state, (int) log_lap_state(position, 1));
+                break;
+            }
+        } else if (diff < 0) {
+            // The consumer has not got to this slot yet
+            SDL_AtomicIncRef(&log_dropped);
+            return -1;
+        }
+
+        position = (unsigned int) SDL_AtomicGet(&log_head);
+    }
+
+    const unsigned int pending = position + 1 - (unsigned int) SDL_AtomicGet(&log_tail);
+    if (severity == LOG_SEVERITY_FAIL || pending > LOG_RING_CAPACITY / 2) {
+        SDL_SemPost(log_wake);
+    }
+
+    return 0;
+}
+
+static int log_rate_expired(const Log_Rate *rate, Uint32 ticks)
+{
+    return ticks - rate->window_begin >= LOG_RATE_LIMIT_WINDOW;
+}
 
-static int log_core(const char *severity, const char *format, va_list args)
+// Returns 0 if the message must be suppressed. The table is best
+// effort: if another thread is using it or there is no room for the
+// call site the message just goes through.
+static int log_rate_limit(const char *format,
+                          Log_Severity severity,
+                          Uint32 ticks,
+                          int *suppressed)
 {
-    int err = fprintf(stderr, "[%s] ", severity);
-    if (err < 0) {
-        return err;
+    *suppressed = 0;
+
+    if (!SDL_AtomicTryLock(&log_rate_lock)) {
+        return 1;
+    }
+
+    // Linear probing. A slot that is free or whose window is over and
+    // has nothing left to report can be taken by another call site.
+    const size_t home = (size_t) (((uintptr_t) format >> 3) % LOG_RATE_LIMIT_SLOTS);
+    Log_Rate *rate = NULL;
+    Log_Rate *vacant = NULL;
+    for (size_t i = 0; i < LOG_RATE_LIMIT_PROBES; ++i) {
+        Log_Rate *probe = &log_rates[(home + i) % LOG_RATE_LIMIT_SLOTS];
+        if (probe->format == format) {
+            rate = probe;
+            break;
+        }
+
+        if (vacant == NULL &&
+            (probe->format == NULL ||
+             (probe->suppressed == 0 && log_rate_expired(probe, ticks)))) {
+            vacant = probe;
+        }
+    }
+
+    if (rate == NULL) {
+        if (vacant == NULL) {
+            SDL_AtomicUnlock(&log_rate_lock);
+            return 1;
+        }
+
+        rate = vacant;
+        rate->format = format;
+        rate->window_begin = ticks;
+        rate->count = 0;
+        rate->suppressed = 0;
+    } else if (log_rate_expired(rate, ticks)) {
+        *suppressed = rate->suppressed;
+        rate->window_begin = ticks;
+        rate->count = 0;
+        rate->suppressed = 0;
+    }
+    rate->severity = severity;
+
+    int result = 1;
+    if (rate->count < LOG_RATE_LIMIT_BURST) {
+        rate->count++;
+    } else {
+        rate->suppressed++;
+        result = 0;
+    }
+
+    SDL_AtomicUnlock(&log_rate_lock);
+
+    return result;
+}
+
+// Reports the call sites that were suppressed and went quiet since
+// then, whose count would otherwise wait for their next message.
+// With everything the windows that are not over yet are reported too.
+static void log_report_suppressed(int everything)
+{
+    Log_Rate reports[LOG_RATE_LIMIT_SLOTS];
+    size_t reports_count = 0;
+    const Uint32 ticks = SDL_GetTicks();
+
+    SDL_AtomicLock(&log_rate_lock);
+    for (size_t i = 0; i < LOG_RATE_LIMIT_SLOTS; ++i) {
+        Log_Rate *rate = &log_rates[i];
+        if (rate->format != NULL && rate->suppressed > 0 &&
+            (everything || log_rate_expired(rate, ticks))) {
+            reports[reports_count++] = *rate;
+            rate->suppressed = 0;
+        }
+    }
+    SDL_AtomicUnlock(&log_rate_lock);
+
+    for (size_t i = 0; i < reports_count; ++i) {
+        const char *format = reports[i].format;
+        const size_t n = strcspn(format, "\n");
+        char message[LOG_MESSAGE_CAPACITY];
+        snprintf(message, LOG_MESSAGE_CAPACITY,
+                 "%d messages like \"%.*s\" were suppressed\n",
+                 reports[i].suppressed, (int) n, format);
+        log_write(reports[i].severity, ticks, message);
+    }
+}
+
+void log_flush(void)
+{
+    SDL_AtomicLock(&log_consumer_lock);
+
+    unsigned int position = (unsigned int) SDL_AtomicGet(&log_tail);
+    for (;;) {
+        Log_Entry *entry = &log_ring[position % LOG_RING_CAPACITY];
+        if ((unsigned int) SDL_AtomicGet(&entry->state) != log_lap_state(position, 1)) {
+            break;
+        }
+
+        log_write(entry->severity, entry->ticks, entry->message);
+
+        // Free for the producer of the next lap
+        SDL_AtomicSet(&entry->state, (int) log_lap_state(position + LOG_RING_CAPACITY, 0));
+        position++;
+        SDL_AtomicSet(&log_tail, (int) position);
     }
 
-    return vfprintf(stderr, format, args);
+    const int dropped = SDL_AtomicSet(&log_dropped, 0);
+    if (dropped > 0) {
+        char message[LOG_MESSAGE_CAPACITY];
+        snprintf(message, LOG_MESSAGE_CAPACITY, "%d log messages were dropped\n", dropped);
+        log_write(LOG_SEVERITY_WARN, SDL_GetTicks(), message);
+    }
+
+    log_report_suppressed(0);
+
+    fflush(stderr);
+
+    SDL_AtomicUnlock(&log_consumer_lock);
+}
+
+static int log_flusher_thread(void *data)
+{
+    (void) data;
+
+    while (!SDL_AtomicGet(&log_quit)) {
+        log_flush();
+        SDL_SemWaitTimeout(log_wake, LOG_FLUSH_INTERVAL);
+    }
+
+    return 0;
+}
+
+int log_start(void)
+{
+    if (SDL_AtomicGet(&log_started)) {
+        return 0;
+    }
+
+    // The semaphore outlives log_stop, because a producer that has
+    // not noticed the stop yet may still post it
+    if (log_wake == NULL) {
+        log_wake = SDL_CreateSemaphore(0);
+    }
+    if (log_wake == NULL) {
+        fprintf(stderr, "[%s] Could not create the semaphore for the logger: %s\n",
+                severity_names[LOG_SEVERITY_FAIL], SDL_GetError());
+        return -1;
+    }
+
+    SDL_AtomicSet(&log_quit, 0);
+    log_flusher = SDL_CreateThread(log_flusher_thread, "Log Flusher", NULL);
+    if (log_flusher == NULL) {
+        fprintf(stderr, "[%s] Could not start the logger thread: %s\n",
+                severity_names[LOG_SEVERITY_FAIL], SDL_GetError());
+        return -1;
+    }
+
+    SDL_AtomicSet(&log_started, 1);
+
+    return 0;
+}
+
+void log_stop(void)
+{
+    if (!SDL_AtomicGet(&log_started)) {
+        return;
+    }
+
+    SDL_AtomicSet(&log_started, 0);
+    SDL_AtomicSet(&log_quit, 1);
+    SDL_SemPost(log_wake);
+    SDL_WaitThread(log_flusher, NULL);
+    log_flusher = NULL;
+
+    // Whatever the producers managed to push while we were stopping,
+    // and the counts of the windows that are not over yet
+    log_flush();
+    log_report_suppressed(1);
+    fflush(stderr);
+}
+
+void log_set_min_severity(Log_Severity severity)
+{
+    SDL_AtomicSet(&log_min_severity, (int) severity);
+}
+
+static int log_message(Log_Severity severity, const char *format, ...);
+
+static int log_core(Log_Severity severity, const char *format, va_list args)
+{
+    if ((int) severity < SDL_AtomicGet(&log_min_severity)) {
+        return 0;
+    }
+
+    const Uint32 ticks = SDL_GetTicks();
+
+    int suppressed = 0;
+    if (!log_rate_limit(format, severity, ticks, &suppressed)) {
+        return 0;
+    }
+
+    if (suppressed > 0) {
+        log_message(severity, "%d similar messages were suppressed\n", suppressed);
+    }
+
+    if (!SDL_AtomicGet(&log_started)) {
+        char message[LOG_MESSAGE_CAPACITY];
+        vsnprintf(message, LOG_MESSAGE_CAPACITY, format, args);
+        log_write(severity, ticks, message);
+        return 0;
+    }
+
+    return log_push(severity, ticks, format, args);
+}
+
+static int log_message(Log_Severity severity, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int err = log_core(severity, format, args);
+    va_end(args);
+    return err;
 }
 
 int log_fail(const char *format, ...)
 {
     va_list args;
     va_start(args, format);
-    int err = log_core(SEVERITY_FAIL, format, args);
+    int err = log_core(LOG_SEVERITY_FAIL, format, args);
     va_end(args);
     return err;
 }
@@ -31,7 +357,7 @@ int log_warn(const char *format, ...)
 {
     va_list args;
     va_start(args, format);
-    int err = log_core(SEVERITY_WARN, format, args);
+    int err = log_core(LOG_SEVERITY_WARN, format, args);
     va_end(args);
     return err;
 }
@@ -40,7 +366,7 @@ int log_info(const char *format, ...)
 {
     va_list args;
     va_start(args, format);
-    int err = log_core(SEVERITY_INFO, format, args);
+    int err = log_core(LOG_SEVERITY_INFO, format, args);
     va_end(args);
     return err;
 }
@@ -1,6 +1,33 @@
 #ifndef LOG_H_
 #define LOG_H_
 
+typedef enum {
+    LOG_SEVERITY_INFO = 0,
+    LOG_SEVERITY_WARN,
+    LOG_SEVERITY_FAIL
+} Log_Severity;
+
+// The messages are put into a ring buffer and written to stderr by a
+// background thread, so logging never waits for the I/O. A message
+// that does not fit into the ring is dropped and counted. Until
+// log_start is called (and after log_stop) the messages are written
+// right away on the calling thread.
+//
+// Every call site (format string) gets at most LOG_RATE_LIMIT_BURST
+// messages per LOG_RATE_LIMIT_WINDOW, the rest are counted. The count
+// is reported with the next message of the call site after the window
+// is over, or by log_flush if the call site went quiet.
+
+int log_start(void);
+void log_stop(void);
+// Writes out everything that is in the ring right now
+void log_flush(void);
+
+// Messages less severe than that are ignored. LOG_SEVERITY_INFO by
+// default.
+void log_set_min_severity(Log_Severity severity);
+
+// Return -1 if the message was dropped
 int log_fail(const char *format, ...);
 int log_warn(const char *format, ...);
 int log_info(const char *format, ...);
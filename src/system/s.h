@@ -1,6 +1,7 @@
 #ifndef S_H_
 #define S_H_
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
@@ -65,6 +66,36 @@ int string_equal(String a, String b)
     return memcmp(a.data, b.data, a.count) == 0;
 }
 
+// FNV-1a
+static inline
+uint32_t string_hash(String s)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < s.count; ++i) {
+        hash = (hash ^ (uint8_t) s.data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+#define STRING_HASH64_BASIS 14695981039346656037ull
+
+// 64 bit FNV-1a of whatever was hashed into hash (STRING_HASH64_BASIS
+// for nothing) followed by s
+static inline
+uint64_t string_hash64_append(uint64_t hash, String s)
+{
+    for (size_t i = 0; i < s.count; ++i) {
+        hash = (hash ^ (uint8_t) s.data[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+static inline
+uint64_t string_hash64(String s)
+{
+    return string_hash64_append(STRING_HASH64_BASIS, s);
+}
+
 static inline
 String trim_begin(String input)
 {
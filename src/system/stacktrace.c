@@ -7,6 +7,7 @@
 #endif
 
 #include "./stacktrace.h"
+#include "./log.h"
 
 
 void print_stacktrace(void)
@@ -28,6 +29,9 @@ void print_stacktrace(void)
 
 void __trace_assert(const char *file, int line, const char *function, const char *message)
 {
+    // Get the queued messages out before we crash
+    log_flush();
+
     fprintf(
         stderr,
         "%s:%d: %s: Assertion `%s' failed\n",
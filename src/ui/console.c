@@ -1,5 +1,9 @@
 #include <ctype.h>
+#include <errno.h>
 #include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
 
 #include "system/stacktrace.h"
 
@@ -14,19 +18,32 @@
 #include "ui/edit_field.h"
 #include "ui/history.h"
 #include "math/extrema.h"
+#include "math/rand.h"
+#include "cvars.h"
+#include "config.h"
 
 #define FONT_WIDTH_SCALE 3.0f
 #define FONT_HEIGHT_SCALE 3.0f
 
-#define CONSOLE_LOG_CAPACITY 10
+#define CONSOLE_LOG_VISIBLE_LINES 10
+// Enough to scroll back through a good while of `profile` output
+#define CONSOLE_LOG_LINES_CAPACITY 65536
+#define CONSOLE_LOG_BYTES_CAPACITY (4 * 1024 * 1024)
+#define CONSOLE_LOG_WHEEL_LINES 3
 #define HISTORY_CAPACITY 20
 #define PROMPT_HEIGHT (FONT_HEIGHT_SCALE * FONT_CHAR_HEIGHT)
-#define CONSOLE_LOG_HEIGHT (FONT_HEIGHT_SCALE * FONT_CHAR_HEIGHT * CONSOLE_LOG_CAPACITY)
+#define CONSOLE_LOG_HEIGHT (FONT_HEIGHT_SCALE * FONT_CHAR_HEIGHT * CONSOLE_LOG_VISIBLE_LINES)
 
 #define CONSOLE_HEIGHT (CONSOLE_LOG_HEIGHT + PROMPT_HEIGHT)
 
 #define SLIDE_DOWN_TIME 0.4f
 
+// Must be a power of two and bigger than the amount of the commands
+#define CONSOLE_COMMANDS_HASH_CAPACITY 32
+// The most frames `bench frames N` can measure
+#define CONSOLE_BENCH_CAPACITY 10000
+#define CONSOLE_SPAWN_SEED 69
+
 #define CONSOLE_ALPHA (0.80f)
 #define CONSOLE_BACKGROUND (rgba(0.20f, 0.20f, 0.20f, CONSOLE_ALPHA))
 #define CONSOLE_FOREGROUND (rgba(0.80f, 0.80f, 0.80f, CONSOLE_ALPHA))
@@ -40,7 +57,82 @@ struct Console
     History *history;
     Game *game;
     float a;
+    // Indices into console_commands plus one, zero is an empty slot
+    size_t commands_hash[CONSOLE_COMMANDS_HASH_CAPACITY];
+
+    Rng spawn_rng;
+
+    // `bench frames N` collects the times of the next bench_target
+    // frames. Zero when there is no bench going on.
+    size_t bench_target;
+    size_t bench_count;
+    float *bench_frame_times;
+    float bench_update_time;
+    float bench_render_time;
+
+    // `profile start <file>` writes the time of every frame into the
+    // file until `profile stop`
+    FILE *profile;
+    size_t profile_frame;
+};
+
+typedef int (*Console_Command_Func)(Console *console, String args);
+
+typedef struct {
+    const char *name;
+    Console_Command_Func func;
+} Console_Command;
+
+static int console_command_load(Console *console, String args);
+static int console_command_menu(Console *console, String args);
+static int console_command_set(Console *console, String args);
+static int console_command_get(Console *console, String args);
+static int console_command_list(Console *console, String args);
+static int console_command_spawn_boxes(Console *console, String args);
+static int console_command_clear_boxes(Console *console, String args);
+static int console_command_bench(Console *console, String args);
+static int console_command_profile(Console *console, String args);
+
+static const Console_Command console_commands[] = {
+    {"load", console_command_load},
+    {"menu", console_command_menu},
+    {"set", console_command_set},
+    {"get", console_command_get},
+    {"list", console_command_list},
+    {"spawn_boxes", console_command_spawn_boxes},
+    {"clear_boxes", console_command_clear_boxes},
+    {"bench", console_command_bench},
+    {"profile", console_command_profile}
 };
+#define CONSOLE_COMMANDS_COUNT (sizeof(console_commands) / sizeof(console_commands[0]))
+
+static
+void console_build_commands_hash(Console *console)
+{
+    for (size_t i = 0; i < CONSOLE_COMMANDS_COUNT; ++i) {
+        size_t slot = string_hash(string_nt(console_commands[i].name))
+            & (CONSOLE_COMMANDS_HASH_CAPACITY - 1);
+        while (console->commands_hash[slot] != 0) {
+            slot = (slot + 1) & (CONSOLE_COMMANDS_HASH_CAPACITY - 1);
+        }
+        console->commands_hash[slot] = i + 1;
+    }
+}
+
+static
+const Console_Command *console_find_command(const Console *console, String name)
+{
+    size_t slot = string_hash(name) & (CONSOLE_COMMANDS_HASH_CAPACITY - 1);
+    while (console->commands_hash[slot] != 0) {
+        const Console_Command *command = &console_commands[console->commands_hash[slot] - 1];
+        if (string_equal(string_nt(command->name), name)) {
+            return command;
+        }
+        slot = (slot + 1) & (CONSOLE_COMMANDS_HASH_CAPACITY - 1);
+    }
+
+    return NULL;
+}
 
 /* TODO(#356): Console does not support autocompletion */
 
@@ -61,8 +153,13 @@ Console *create_console(Game *game)
         lt,
         create_console_log(
             vec(FONT_WIDTH_SCALE, FONT_HEIGHT_SCALE),
-            CONSOLE_LOG_CAPACITY),
+            CONSOLE_LOG_VISIBLE_LINES,
+            CONSOLE_LOG_LINES_CAPACITY,
+            CONSOLE_LOG_BYTES_CAPACITY),
         destroy_console_log);
+    if (console->console_log == NULL) {
+        RETURN_LT(lt, NULL);
+    }
 
     console->a = 0;
 
@@ -76,15 +173,312 @@ Console *create_console(Game *game)
 
     console->game = game;
 
+    console_build_commands_hash(console);
+
+    console->spawn_rng = create_rng(CONSOLE_SPAWN_SEED, 0);
+
+    console->bench_frame_times = PUSH_LT(
+        lt,
+        nth_calloc(CONSOLE_BENCH_CAPACITY, sizeof(float)),
+        free);
+    if (console->bench_frame_times == NULL) {
+        RETURN_LT(lt, NULL);
+    }
+
     return console;
 }
 
 void destroy_console(Console *console)
 {
     trace_assert(console);
+    if (console->profile != NULL) {
+        fclose(console->profile);
+    }
     RETURN_LT0(console->lt);
 }
 
+static int console_command_load(Console *console, String args)
+{
+    String level = chop_word(&args);
+    console_log_push_line(console->console_log, "Loading level:", NULL, CONSOLE_FOREGROUND);
+    console_log_push_line(console->console_log, level.data, level.data + level.count, CONSOLE_FOREGROUND);
+    char level_name[256];
+    memset(level_name, 0, 256);
+    memcpy(level_name, level.data, min_size_t(level.count, 255));
+
+    if (game_load_level(console->game, level_name) < 0) {
+        console_log_push_line(console->console_log, "Could not load level", NULL, CONSOLE_ERROR);
+    }
+
+    return 0;
+}
+
+static int console_command_menu(Console *console, String args)
+{
+    (void) args;
+    console_log_push_line(console->console_log, "Loading menu", NULL, CONSOLE_FOREGROUND);
+    game_switch_state(console->game, GAME_STATE_LEVEL_PICKER);
+    return 0;
+}
+
+static int console_print_cvar(Console *console, const Cvar *cvar)
+{
+    char line[256];
+    char value[64];
+    cvar_format(cvar, value, sizeof(value));
+    snprintf(line, sizeof(line), "%s = %s", cvar->name, value);
+    return console_log_push_line(console->console_log, line, NULL, CONSOLE_FOREGROUND);
+}
+
+static int console_command_set(Console *console, String args)
+{
+    String name = chop_word(&args);
+    String value = trim(args);
+
+    Cvar *cvar = cvars_find(name);
+    if (cvar == NULL) {
+        console_log_push_line(console->console_log, "Unknown variable", NULL, CONSOLE_ERROR);
+        return 0;
+    }
+
+    if (cvar_set(cvar, value) < 0) {
+        console_log_push_line(console->console_log, "Bad value", NULL, CONSOLE_ERROR);
+        return 0;
+    }
+
+    if (cvars_save(CVARS_FILE_PATH) < 0) {
+        console_log_push_line(console->console_log, "Could not save the variables", NULL, CONSOLE_ERROR);
+    }
+
+    return console_print_cvar(console, cvar);
+}
+
+static int console_command_get(Console *console, String args)
+{
+    Cvar *cvar = cvars_find(chop_word(&args));
+    if (cvar == NULL) {
+        console_log_push_line(console->console_log, "Unknown variable", NULL, CONSOLE_ERROR);
+        return 0;
+    }
+
+    return console_print_cvar(console, cvar);
+}
+
+static int console_command_list(Console *console, String args)
+{
+    (void) args;
+    for (size_t i = 0; i < cvars_count(); ++i) {
+        if (console_print_cvar(console, cvars_at(i)) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int console_error(Console *console, const char *message)
+{
+    return console_log_push_line(console->console_log, message, NULL, CONSOLE_ERROR);
+}
+
+static int console_printf(Console *console, const char *format, ...)
+{
+    char line[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    return console_log_push_line(console->console_log, line, NULL, CONSOLE_FOREGROUND);
+}
+
+// Returns -1 unless the whole word is a finite number
+static int string_to_float(String s, float *result)
+{
+    char buffer[64];
+    if (s.count == 0 || s.count >= sizeof(buffer)) {
+        return -1;
+    }
+    memcpy(buffer, s.data, s.count);
+    buffer[s.count] = '\0';
+
+    char *end = NULL;
+    errno = 0;
+    *result = strtof(buffer, &end);
+    return errno == 0 && *end == '\0' && isfinite(*result) ? 0 : -1;
+}
+
+// Returns -1 unless the whole word is a non-negative integer
+static int string_to_size(String s, size_t *result)
+{
+    char buffer[64];
+    // strtoul skips the spaces and takes the sign, the word must start
+    // with a digit instead
+    if (s.count == 0 || s.count >= sizeof(buffer) || !isdigit((unsigned char) s.data[0])) {
+        return -1;
+    }
+    memcpy(buffer, s.data, s.count);
+    buffer[s.count] = '\0';
+
+    char *end = NULL;
+    errno = 0;
+    const unsigned long x = strtoul(buffer, &end, 10);
+    if (errno != 0 || *end != '\0') {
+        return -1;
+    }
+
+    *result = (size_t) x;
+    return 0;
+}
+
+static int console_command_spawn_boxes(Console *console, String args)
+{
+    Level *level = game_level(console->game);
+    if (level == NULL) {
+        return console_error(console, "No level is being played");
+    }
+
+    size_t count = 0;
+    if (string_to_size(chop_word(&args), &count) < 0 || count == 0) {
+        return console_error(console, "Usage: spawn_boxes <count> [area]");
+    }
+
+    // The boxes go into a square of that size around the center of the
+    // screen, or all over the screen by default
+    Rect area = game_view_port(console->game);
+    String area_size = chop_word(&args);
+    if (area_size.count > 0) {
+        float size = 0.0f;
+        if (string_to_float(area_size, &size) < 0 || size <= 0.0f) {
+            return console_error(console, "Usage: spawn_boxes <count> [area]");
+        }
+        area = rect(area.x + area.w * 0.5f - size * 0.5f,
+                    area.y + area.h * 0.5f - size * 0.5f,
+                    size, size);
+    }
+
+    const size_t spawned = level_spawn_boxes(
+        level, &console->spawn_rng, count, area);
+    return console_printf(console, "Spawned %zu boxes", spawned);
+}
+
+static int console_command_clear_boxes(Console *console, String args)
+{
+    (void) args;
+
+    Level *level = game_level(console->game);
+    if (level == NULL) {
+        return console_error(console, "No level is being played");
+    }
+
+    level_clear_boxes(level);
+    return console_printf(console, "Removed all the boxes");
+}
+
+static int console_command_bench(Console *console, String args)
+{
+    size_t frames = 0;
+    if (!string_equal(chop_word(&args), STRING_LIT("frames")) ||
+        string_to_size(chop_word(&args), &frames) < 0 ||
+        frames < 1 || frames > CONSOLE_BENCH_CAPACITY) {
+        return console_error(console, "Usage: bench frames <1..10000>");
+    }
+
+    console->bench_target = frames;
+    console->bench_count = 0;
+    console->bench_update_time = 0.0f;
+    console->bench_render_time = 0.0f;
+
+    return console_printf(console, "Measuring %zu frames...", console->bench_target);
+}
+
+static int console_command_profile(Console *console, String args)
+{
+    String action = chop_word(&args);
+
+    if (string_equal(action, STRING_LIT("start"))) {
+        String file_path = trim(args);
+        if (file_path.count == 0) {
+            return console_error(console, "Usage: profile start <file>");
+        }
+
+        char buffer[256];
+        snprintf(buffer, sizeof(buffer), "%.*s", (int) file_path.count, file_path.data);
+
+        if (console->profile != NULL) {
+            fclose(console->profile);
+        }
+        console->profile = fopen(buffer, "w");
+        if (console->profile == NULL) {
+            return console_error(console, "Could not open the file");
+        }
+        console->profile_frame = 0;
+        fprintf(console->profile, "frame,update_ms,render_cpu_ms\n");
+
+        return console_printf(console, "Profiling into %s", buffer);
+    } else if (string_equal(action, STRING_LIT("stop"))) {
+        if (console->profile == NULL) {
+            return console_error(console, "Not profiling");
+        }
+        fclose(console->profile);
+        console->profile = NULL;
+
+        return console_printf(console, "Profiled %zu frames", console->profile_frame);
+    }
+
+    return console_error(console, "Usage: profile start <file> | profile stop");
+}
+
+static int compare_floats(const void *a, const void *b)
+{
+    const float x = *(const float *) a;
+    const float y = *(const float *) b;
+    return (x > y) - (x < y);
+}
+
+static void console_report_bench(Console *console)
+{
+    const size_t n = console->bench_count;
+    float *times = console->bench_frame_times;
+    qsort(times, n, sizeof(times[0]), compare_floats);
+
+    float total = 0.0f;
+    for (size_t i = 0; i < n; ++i) {
+        total += times[i];
+    }
+
+    console_printf(console, "%zu frames: avg %.2f min %.2f max %.2f ms",
+                   n, (double) (total / (float) n),
+                   (double) times[0], (double) times[n - 1]);
+    console_printf(console, "p50 %.2f p99 %.2f ms",
+                   (double) times[n / 2],
+                   (double) times[(n * 99) / 100]);
+    console_printf(console, "update avg %.2f render (cpu) avg %.2f ms",
+                   (double) (console->bench_update_time / (float) n),
+                   (double) (console->bench_render_time / (float) n));
+}
+
+void console_record_frame(Console *console, float update_time, float render_time)
+{
+    trace_assert(console);
+
+    if (console->profile != NULL) {
+        fprintf(console->profile, "%zu,%.3f,%.3f\n",
+                console->profile_frame++,
+                (double) update_time,
+                (double) render_time);
+    }
+
+    if (console->bench_target > 0) {
+        console->bench_frame_times[console->bench_count++] = update_time + render_time;
+        console->bench_update_time += update_time;
+        console->bench_render_time += render_time;
+
+        if (console->bench_count >= console->bench_target) {
+            console_report_bench(console);
+            console->bench_target = 0;
+        }
+    }
+}
+
 static int console_eval_input(Console *console)
 {
     const char *input_text = edit_field_as_text(&console->edit_field);
@@ -105,22 +499,11 @@ static int console_eval_input(Console *console)
         return -1;
     }
 
-    if (string_equal(command, STRING_LIT("load"))) {
-        String level = chop_word(&input);
-        console_log_push_line(console->console_log, "Loading level:", NULL, CONSOLE_FOREGROUND);
-        console_log_push_line(console->console_log, level.data, level.data + level.count, CONSOLE_FOREGROUND);
-        char level_name[256];
-        memset(level_name, 0, 256);
-        memcpy(level_name, level.data, min_size_t(level.count, 255));
-
-        if (game_load_level(console->game, level_name) < 0) {
-            console_log_push_line(console->console_log, "Could not load level", NULL, CONSOLE_ERROR);
-        }
-    } else if (string_equal(command, STRING_LIT("menu"))) {
-        console_log_push_line(console->console_log, "Loading menu", NULL, CONSOLE_FOREGROUND);
-        game_switch_state(console->game, GAME_STATE_LEVEL_PICKER);
-    } else {
+    const Console_Command *console_command = console_find_command(console, command);
+    if (console_command == NULL) {
         console_log_push_line(console->console_log, "Unknown command", NULL, CONSOLE_ERROR);
+    } else if (console_command->func(console, input) < 0) {
+        return -1;
     }
 
     edit_field_clean(&console->edit_field);
@@ -176,8 +559,31 @@ int console_handle_event(Console *console,
                 return 0;
             }
         } break;
+
+        case SDLK_PAGEUP:
+            console_log_scroll(console->console_log, CONSOLE_LOG_VISIBLE_LINES - 1);
+            return 0;
+
+        case SDLK_PAGEDOWN:
+            console_log_scroll(console->console_log, -(CONSOLE_LOG_VISIBLE_LINES - 1));
+            return 0;
         }
     } break;
+
+    case SDL_MOUSEWHEEL: {
+        console_log_scroll(console->console_log, event->wheel.y * CONSOLE_LOG_WHEEL_LINES);
+        return 0;
+    } break;
+
+    case SDL_RENDER_TARGETS_RESET: {
+        console_log_render_targets_reset(console->console_log);
+        return 0;
+    } break;
+
+    case SDL_RENDER_DEVICE_RESET: {
+        console_log_render_device_reset(console->console_log);
+        return 0;
+    } break;
     }
 
     return edit_field_event(&console->edit_field, event);
@@ -202,9 +608,11 @@ int console_render(const Console *console,
         return -1;
     }
 
-    console_log_render(console->console_log,
-                       camera,
-                       vec(0.0f, y));
+    if (console_log_render(console->console_log,
+                           camera,
+                           vec(0.0f, y)) < 0) {
+        return -1;
+    }
 
     if (edit_field_render_screen(&console->edit_field,
                                  camera,
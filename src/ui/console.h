@@ -21,4 +21,10 @@ int console_update(Console *console,
 
 void console_slide_down(Console *console);
 
+// Feeds the `bench` and `profile` commands. The times are in
+// milliseconds. render_time is only the CPU time of issuing the
+// render commands, it doesn't include SDL_RenderPresent and whatever
+// the GPU does after that.
+void console_record_frame(Console *console, float update_time, float render_time);
+
 #endif  // CONSOLE_H_
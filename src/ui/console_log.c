@@ -1,30 +1,65 @@
 #include "system/stacktrace.h"
+#include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 #include <SDL.h>
 
 #include "color.h"
 #include "game/sprite_font.h"
 #include "console_log.h"
 #include "math/vec.h"
-#include "system/str.h"
+#include "system/log.h"
 #include "system/lt.h"
 #include "system/nth_alloc.h"
 
+typedef struct {
+    // Where the NUL terminated text of the line is in the bytes
+    size_t offset;
+    // Including the NUL
+    size_t size;
+    Color color;
+} Console_Line;
+
 struct Console_Log
 {
     Lt *lt;
 
     Vec2f font_size;
+    size_t visible_count;
+
+    char *bytes;
+    size_t bytes_capacity;
+    // Where the next line goes
+    size_t bytes_end;
+
+    // Oldest first, the lines are laid out in the bytes in the same
+    // order. So the lines right after bytes_end are always the oldest
+    // ones and they are the ones overwritten by the new lines.
+    Console_Line *lines;
+    size_t lines_capacity;
+    size_t lines_begin;
+    size_t lines_count;
 
-    Color *colors;
-    char **buffer;
-    size_t cursor;
-    size_t capacity;
+    // How many lines from the bottom the log is scrolled back
+    size_t scroll;
+
+    SDL_Texture *cache;
+    int cache_width;
+    bool cache_dirty;
+    // The renderer can't render into the textures, so the visible
+    // lines are rendered straight to the screen every frame
+    bool cache_failed;
 };
 
 Console_Log *create_console_log(Vec2f font_size,
-                                size_t capacity)
+                                size_t visible_count,
+                                size_t lines_capacity,
+                                size_t bytes_capacity)
 {
+    trace_assert(visible_count > 0);
+    trace_assert(lines_capacity > 0);
+    trace_assert(bytes_capacity > 1);
+
     Lt *lt = create_lt();
 
     Console_Log *console_log = PUSH_LT(lt, nth_calloc(1, sizeof(Console_Log)), free);
@@ -33,19 +68,21 @@ Console_Log *create_console_log(Vec2f font_size,
     }
     console_log->lt = lt;
     console_log->font_size = font_size;
-    console_log->capacity = capacity;
+    console_log->visible_count = visible_count;
 
-    console_log->buffer = PUSH_LT(lt, nth_calloc(capacity, sizeof(char*)), free);
-    if (console_log->buffer == NULL) {
+    console_log->bytes = PUSH_LT(lt, nth_calloc(bytes_capacity, sizeof(char)), free);
+    if (console_log->bytes == NULL) {
         RETURN_LT(lt, NULL);
     }
+    console_log->bytes_capacity = bytes_capacity;
 
-    console_log->colors = PUSH_LT(lt, nth_calloc(capacity, sizeof(Color)), free);
-    if (console_log->colors == NULL) {
+    console_log->lines = PUSH_LT(lt, nth_calloc(lines_capacity, sizeof(Console_Line)), free);
+    if (console_log->lines == NULL) {
         RETURN_LT(lt, NULL);
     }
+    console_log->lines_capacity = lines_capacity;
 
-    console_log->cursor = 0;
+    console_log->cache_dirty = true;
 
     return console_log;
 }
@@ -53,33 +90,91 @@ Console_Log *create_console_log(Vec2f font_size,
 void destroy_console_log(Console_Log *console_log)
 {
     trace_assert(console_log);
-    for (size_t i = 0; i < console_log->capacity; ++i) {
-        if (console_log->buffer[i]) {
-            free(console_log->buffer[i]);
-        }
+    if (console_log->cache != NULL) {
+        SDL_DestroyTexture(console_log->cache);
     }
     RETURN_LT0(console_log->lt);
 }
 
-void console_log_render(const Console_Log *console_log,
-                        const Camera *camera,
-                        Vec2f position)
+static inline
+const Console_Line *console_log_line(const Console_Log *console_log, size_t i)
 {
-    trace_assert(console_log);
-    trace_assert(camera);
+    trace_assert(i < console_log->lines_count);
+    return &console_log->lines[(console_log->lines_begin + i) % console_log->lines_capacity];
+}
+
+static inline
+size_t console_log_max_scroll(const Console_Log *console_log)
+{
+    return console_log->lines_count > console_log->visible_count
+        ? console_log->lines_count - console_log->visible_count
+        : 0;
+}
 
-    for (size_t i = 0; i < console_log->capacity; ++i) {
-        const size_t j = (i + console_log->cursor) % console_log->capacity;
-        if (console_log->buffer[j]) {
-            camera_render_text_screen(
-                camera,
-                console_log->buffer[j],
-                console_log->font_size,
-                console_log->colors[j],
-                vec_sum(position,
-                        vec(0.0f, FONT_CHAR_HEIGHT * console_log->font_size.y * (float) i)));
+static
+void console_log_drop_oldest(Console_Log *console_log)
+{
+    trace_assert(console_log->lines_count > 0);
+    console_log->lines_begin = (console_log->lines_begin + 1) % console_log->lines_capacity;
+    console_log->lines_count -= 1;
+}
+
+static
+void console_log_push_one_line(Console_Log *console_log,
+                               const char *text,
+                               size_t size,
+                               Color color)
+{
+    if (size + 1 > console_log->bytes_capacity) {
+        size = console_log->bytes_capacity - 1;
+    }
+
+    size_t at = console_log->bytes_end;
+    if (at + size + 1 > console_log->bytes_capacity) {
+        // The line does not fit into the rest of the ring, so it
+        // starts over from the beginning. The lines left in the rest
+        // are the oldest ones and they would be overwritten next
+        // anyway.
+        while (console_log->lines_count > 0 &&
+               console_log_line(console_log, 0)->offset >= at) {
+            console_log_drop_oldest(console_log);
         }
+        at = 0;
+    }
+
+    while (console_log->lines_count > 0) {
+        const Console_Line *oldest = console_log_line(console_log, 0);
+        if (oldest->offset >= at + size + 1 || at >= oldest->offset + oldest->size) {
+            break;
+        }
+        console_log_drop_oldest(console_log);
+    }
+
+    if (console_log->lines_count >= console_log->lines_capacity) {
+        console_log_drop_oldest(console_log);
     }
+
+    memcpy(console_log->bytes + at, text, size);
+    console_log->bytes[at + size] = '\0';
+    console_log->bytes_end = at + size + 1;
+
+    console_log->lines[(console_log->lines_begin + console_log->lines_count) % console_log->lines_capacity] =
+        (Console_Line) {
+            .offset = at,
+            .size = size + 1,
+            .color = color
+        };
+    console_log->lines_count += 1;
+
+    // Whoever scrolled back keeps looking at the same lines
+    if (console_log->scroll > 0) {
+        console_log->scroll += 1;
+    }
+    if (console_log->scroll > console_log_max_scroll(console_log)) {
+        console_log->scroll = console_log_max_scroll(console_log);
+    }
+
+    console_log->cache_dirty = true;
 }
 
 int console_log_push_line(Console_Log *console_log,
@@ -90,32 +185,190 @@ int console_log_push_line(Console_Log *console_log,
     trace_assert(console_log);
     trace_assert(line);
 
-    const size_t next_cursor = (console_log->cursor + 1) % console_log->capacity;
+    if (line_end == NULL) {
+        line_end = line + strlen(line);
+    }
+
+    for (;;) {
+        const char *newline = memchr(line, '\n', (size_t) (line_end - line));
+        const char *end = newline != NULL ? newline : line_end;
+
+        console_log_push_one_line(console_log, line, (size_t) (end - line), color);
 
-    if (console_log->buffer[console_log->cursor] != NULL) {
-        free(console_log->buffer[console_log->cursor]);
+        if (newline == NULL) {
+            break;
+        }
+        line = newline + 1;
     }
 
-    console_log->buffer[console_log->cursor] = string_duplicate(line, line_end);
-    console_log->colors[console_log->cursor] = color;
+    return 0;
+}
 
-    if (console_log->buffer[console_log->cursor] == NULL) {
+void console_log_scroll(Console_Log *console_log, int lines)
+{
+    trace_assert(console_log);
+
+    if (lines < 0) {
+        const size_t n = (size_t) -lines;
+        console_log->scroll = console_log->scroll > n ? console_log->scroll - n : 0;
+    } else {
+        console_log->scroll += (size_t) lines;
+        if (console_log->scroll > console_log_max_scroll(console_log)) {
+            console_log->scroll = console_log_max_scroll(console_log);
+        }
+    }
+
+    console_log->cache_dirty = true;
+}
+
+void console_log_clear(Console_Log *console_log)
+{
+    trace_assert(console_log);
+    console_log->bytes_end = 0;
+    console_log->lines_begin = 0;
+    console_log->lines_count = 0;
+    console_log->scroll = 0;
+    console_log->cache_dirty = true;
+}
+
+void console_log_render_targets_reset(Console_Log *console_log)
+{
+    trace_assert(console_log);
+    console_log->cache_dirty = true;
+}
+
+void console_log_render_device_reset(Console_Log *console_log)
+{
+    trace_assert(console_log);
+    if (console_log->cache != NULL) {
+        SDL_DestroyTexture(console_log->cache);
+        console_log->cache = NULL;
+    }
+    console_log->cache_dirty = true;
+}
+
+// Only the visible lines, the newest one at the bottom
+static
+void console_log_render_lines(const Console_Log *console_log,
+                              const Camera *camera,
+                              Vec2f position)
+{
+    const size_t bottom = console_log->lines_count - console_log->scroll;
+    const float line_height = FONT_CHAR_HEIGHT * console_log->font_size.y;
+
+    for (size_t row = 0; row < console_log->visible_count; ++row) {
+        if (bottom + row < console_log->visible_count) {
+            continue;
+        }
+
+        const Console_Line *line = console_log_line(
+            console_log,
+            bottom + row - console_log->visible_count);
+        camera_render_text_screen(
+            camera,
+            console_log->bytes + line->offset,
+            console_log->font_size,
+            line->color,
+            vec_sum(position, vec(0.0f, line_height * (float) row)));
+    }
+}
+
+static
+int console_log_update_cache(Console_Log *console_log,
+                             const Camera *camera,
+                             int width)
+{
+    const int height = (int) (FONT_CHAR_HEIGHT * console_log->font_size.y * (float) console_log->visible_count);
+
+    if (console_log->cache == NULL || console_log->cache_width != width) {
+        if (console_log->cache != NULL) {
+            SDL_DestroyTexture(console_log->cache);
+        }
+
+        console_log->cache = SDL_CreateTexture(
+            camera->renderer,
+            SDL_PIXELFORMAT_RGBA8888,
+            SDL_TEXTUREACCESS_TARGET,
+            width, height);
+        if (console_log->cache == NULL) {
+            log_fail("SDL_CreateTexture: %s\n", SDL_GetError());
+            return -1;
+        }
+
+        if (SDL_SetTextureBlendMode(console_log->cache, SDL_BLENDMODE_BLEND) < 0) {
+            log_fail("SDL_SetTextureBlendMode: %s\n", SDL_GetError());
+            return -1;
+        }
+
+        console_log->cache_width = width;
+        console_log->cache_dirty = true;
+    }
+
+    if (!console_log->cache_dirty) {
+        return 0;
+    }
+
+    SDL_Texture *const target = SDL_GetRenderTarget(camera->renderer);
+    if (SDL_SetRenderTarget(camera->renderer, console_log->cache) < 0) {
+        log_fail("SDL_SetRenderTarget: %s\n", SDL_GetError());
+        return -1;
+    }
+
+    if (SDL_SetRenderDrawColor(camera->renderer, 0, 0, 0, 0) < 0 ||
+        SDL_RenderClear(camera->renderer) < 0) {
+        log_fail("SDL_RenderClear: %s\n", SDL_GetError());
+        SDL_SetRenderTarget(camera->renderer, target);
+        return -1;
+    }
+
+    // The glyphs are copied into the cache as they are, with the
+    // alpha of the line, so blending the cache onto the screen later
+    // gives the same picture as rendering the lines straight to it
+    SDL_BlendMode font_blend_mode = SDL_BLENDMODE_BLEND;
+    SDL_GetTextureBlendMode(camera->font.texture, &font_blend_mode);
+    SDL_SetTextureBlendMode(camera->font.texture, SDL_BLENDMODE_NONE);
+    console_log_render_lines(console_log, camera, vec(0.0f, 0.0f));
+    SDL_SetTextureBlendMode(camera->font.texture, font_blend_mode);
+
+    if (SDL_SetRenderTarget(camera->renderer, target) < 0) {
+        log_fail("SDL_SetRenderTarget: %s\n", SDL_GetError());
         return -1;
     }
 
-    console_log->cursor = next_cursor;
+    console_log->cache_dirty = false;
 
     return 0;
 }
 
-void console_log_clear(Console_Log *console_log)
+int console_log_render(Console_Log *console_log,
+                       const Camera *camera,
+                       Vec2f position)
 {
     trace_assert(console_log);
-    console_log->cursor = 0;
-    for (size_t i = 0; i < console_log->capacity; ++i) {
-        if (console_log->buffer[i]) {
-            free(console_log->buffer[i]);
-            console_log->buffer[i] = 0;
+    trace_assert(camera);
+
+    if (!console_log->cache_failed) {
+        SDL_Rect view_port;
+        SDL_RenderGetViewport(camera->renderer, &view_port);
+
+        if (SDL_RenderTargetSupported(camera->renderer) &&
+            console_log_update_cache(console_log, camera, view_port.w) == 0) {
+            const SDL_Rect dest = rect_for_sdl(
+                rect(position.x, position.y,
+                     (float) console_log->cache_width,
+                     FONT_CHAR_HEIGHT * console_log->font_size.y * (float) console_log->visible_count));
+            if (SDL_RenderCopy(camera->renderer, console_log->cache, NULL, &dest) < 0) {
+                log_fail("SDL_RenderCopy: %s\n", SDL_GetError());
+                return -1;
+            }
+            return 0;
         }
+
+        log_warn("Could not cache the console log, rendering it line by line\n");
+        console_log->cache_failed = true;
     }
+
+    console_log_render_lines(console_log, camera, position);
+
+    return 0;
 }
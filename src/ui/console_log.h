@@ -4,21 +4,43 @@
 #include "math/vec.h"
 #include "game/camera.h"
 
+// The lines of the console. The text of all the lines lives in one
+// byte ring of bytes_capacity and the oldest lines are dropped when
+// either the bytes or the lines_capacity run out, so pushing a line
+// never allocates.
+//
+// Only visible_count lines at the bottom (or wherever the log is
+// scrolled to) are rendered. They are cached in a texture that is
+// redrawn only when the log changes.
 typedef struct Console_Log Console_Log;
 
 Console_Log *create_console_log(Vec2f font_size,
-                                size_t capacity);
+                                size_t visible_count,
+                                size_t lines_capacity,
+                                size_t bytes_capacity);
 void destroy_console_log(Console_Log *console_log);
 
-void console_log_render(const Console_Log *console_log,
-                        const Camera *camera,
-                        Vec2f position);
+int console_log_render(Console_Log *console_log,
+                       const Camera *camera,
+                       Vec2f position);
 
+// Pushes every '\n' separated line of [line, line_end) separately.
+// line_end can be NULL for a NUL terminated line.
 int console_log_push_line(Console_Log *console_log,
                           const char *line,
                           const char *line_end,
                           Color color);
 
+// Positive lines scroll back to the older lines
+void console_log_scroll(Console_Log *console_log, int lines);
+
 void console_log_clear(Console_Log *console_log);
 
+// The renderer lost the content of the render targets
+// (SDL_RENDER_TARGETS_RESET) or all of its textures
+// (SDL_RENDER_DEVICE_RESET). The cache is redrawn, or created again,
+// on the next render.
+void console_log_render_targets_reset(Console_Log *console_log);
+void console_log_render_device_reset(Console_Log *console_log);
+
 #endif  // CONSOLE_LOG_H_
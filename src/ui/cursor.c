@@ -2,6 +2,19 @@
 #include "cursor.h"
 #include "game.h"
 
+// Inverts whatever is under the cursor
+static
+SDL_BlendMode cursor_blend_mode(void)
+{
+    return SDL_ComposeCustomBlendMode(
+        SDL_BLENDFACTOR_ONE_MINUS_DST_COLOR,
+        SDL_BLENDFACTOR_ONE_MINUS_SRC_COLOR,
+        SDL_BLENDOPERATION_ADD,
+        SDL_BLENDFACTOR_ONE,
+        SDL_BLENDFACTOR_ZERO,
+        SDL_BLENDOPERATION_ADD);
+}
+
 int cursor_render(const Cursor *cursor, SDL_Renderer *renderer)
 {
     trace_assert(cursor);
@@ -12,7 +25,7 @@ int cursor_render(const Cursor *cursor, SDL_Renderer *renderer)
     cursor_x = (int) ((float) cursor_x * get_display_scale());
     cursor_y = (int) ((float) cursor_y * get_display_scale());
 
-    const SDL_Rect src = {0, 0, CURSOR_ICON_WIDTH, CURSOR_ICON_HEIGHT};
+    const SDL_Rect src = cursor->rects[cursor->style];
     const SDL_Rect dest = {
         cursor_x - cursor_style_tex_pivots[cursor->style][0],
         cursor_y - cursor_style_tex_pivots[cursor->style][1],
@@ -20,12 +33,24 @@ int cursor_render(const Cursor *cursor, SDL_Renderer *renderer)
         CURSOR_ICON_HEIGHT
     };
 
+    // The texture is shared with the text, so the state the text left
+    // behind is overridden here and the blending is restored after
+    if (SDL_SetTextureBlendMode(cursor->texture, cursor_blend_mode()) < 0 ||
+        SDL_SetTextureColorMod(cursor->texture, 255, 255, 255) < 0 ||
+        SDL_SetTextureAlphaMod(cursor->texture, 255) < 0) {
+        return -1;
+    }
+
     if (SDL_RenderCopy(
             renderer,
-            cursor->texs[cursor->style],
+            cursor->texture,
             &src, &dest) < 0) {
         return -1;
     }
 
+    if (SDL_SetTextureBlendMode(cursor->texture, SDL_BLENDMODE_BLEND) < 0) {
+        return -1;
+    }
+
     return 0;
 }
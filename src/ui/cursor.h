@@ -17,11 +17,11 @@ typedef enum {
 } Cursor_Style;
 
 static const char * const cursor_style_tex_files[CURSOR_STYLE_N] = {
-    "./assets/images/cursor.bmp",
-    "./assets/images/cursor-resize-vert.bmp",
-    "./assets/images/cursor-resize-horis.bmp",
-    "./assets/images/cursor-resize-diag1.bmp",
-    "./assets/images/cursor-resize-diag2.bmp"
+    "images/cursor.bmp",
+    "images/cursor-resize-vert.bmp",
+    "images/cursor-resize-horis.bmp",
+    "images/cursor-resize-diag1.bmp",
+    "images/cursor-resize-diag2.bmp"
 };
 
 static const int cursor_style_tex_pivots[CURSOR_STYLE_N][2] = {
@@ -33,7 +33,9 @@ static const int cursor_style_tex_pivots[CURSOR_STYLE_N][2] = {
 };
 
 typedef struct {
-    SDL_Texture *texs[CURSOR_STYLE_N];
+    // Usually the UI atlas shared with the font (see sdl/atlas.h)
+    SDL_Texture *texture;
+    SDL_Rect rects[CURSOR_STYLE_N];
     Cursor_Style style;
 } Cursor;
 
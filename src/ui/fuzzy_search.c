@@ -0,0 +1,226 @@
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "./fuzzy_search.h"
+#include "system/nth_alloc.h"
+#include "system/stacktrace.h"
+
+#define FUZZY_CONSECUTIVE_BONUS 5
+#define FUZZY_WORD_START_BONUS 3
+// Per character of the query
+#define FUZZY_FILE_NAME_BONUS 10
+
+static
+uint64_t fuzzy_char_bit(char c)
+{
+    if ('a' <= c && c <= 'z') {
+        return 1ull << (c - 'a');
+    }
+
+    if ('0' <= c && c <= '9') {
+        return 1ull << (26 + c - '0');
+    }
+
+    // The rest share the remaining bits, which only makes the
+    // rejection less precise
+    return 1ull << (36 + (uint8_t) c % 28);
+}
+
+static
+int is_word_start(const char *haystack, size_t i)
+{
+    if (i == 0) {
+        return 1;
+    }
+
+    const char prev = haystack[i - 1];
+    return prev == '/' || prev == '\\' || prev == '_' || prev == '-' || prev == '.' || prev == ' ';
+}
+
+// Greedily matches the query starting from haystack[from]. Returns 0
+// if it does not match.
+static
+int fuzzy_match(const char *haystack, size_t from,
+                const char *query, size_t query_size,
+                int *score)
+{
+    int result = 0;
+    size_t prev = 0;
+    size_t i = from;
+
+    for (size_t q = 0; q < query_size; ++q) {
+        while (haystack[i] != '\0' && haystack[i] != query[q]) {
+            i += 1;
+        }
+
+        if (haystack[i] == '\0') {
+            return 0;
+        }
+
+        result += 1;
+        if (q > 0 && i == prev + 1) {
+            result += FUZZY_CONSECUTIVE_BONUS;
+        }
+        if (is_word_start(haystack, i)) {
+            result += FUZZY_WORD_START_BONUS;
+        }
+
+        prev = i;
+        i += 1;
+    }
+
+    *score = result;
+    return 1;
+}
+
+static
+int fuzzy_search_score(const Fuzzy_Search *search, size_t index, int *score)
+{
+    const char *haystack = search->haystacks + search->offsets[index];
+
+    if (fuzzy_match(haystack, search->name_offsets[index],
+                    search->query, search->query_size, score)) {
+        *score += FUZZY_FILE_NAME_BONUS * (int) search->query_size;
+        return 1;
+    }
+
+    return fuzzy_match(haystack, 0, search->query, search->query_size, score);
+}
+
+static
+int compare_matches(const void *a, const void *b)
+{
+    const Fuzzy_Match *match_a = a;
+    const Fuzzy_Match *match_b = b;
+
+    if (match_a->score != match_b->score) {
+        return match_a->score > match_b->score ? -1 : 1;
+    }
+
+    // Keeps the order of the paths among the equal ones
+    return match_a->index < match_b->index ? -1 : match_a->index > match_b->index;
+}
+
+int create_fuzzy_search(Fuzzy_Search *search,
+                        const char *paths,
+                        const size_t *offsets,
+                        size_t count)
+{
+    trace_assert(search);
+    trace_assert(count == 0 || (paths && offsets));
+
+    memset(search, 0, sizeof(*search));
+    search->count = count;
+
+    size_t size = 0;
+    for (size_t i = 0; i < count; ++i) {
+        size += strlen(paths + offsets[i]) + 1;
+    }
+
+    search->haystacks = nth_calloc(size + 1, sizeof(char));
+    search->offsets = nth_calloc(count + 1, sizeof(size_t));
+    search->name_offsets = nth_calloc(count + 1, sizeof(size_t));
+    search->masks = nth_calloc(count + 1, sizeof(uint64_t));
+    search->matches = nth_calloc(count + 1, sizeof(Fuzzy_Match));
+    if (search->haystacks == NULL || search->offsets == NULL ||
+        search->name_offsets == NULL || search->masks == NULL ||
+        search->matches == NULL) {
+        destroy_fuzzy_search(search);
+        return -1;
+    }
+
+    size = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const char *path = paths + offsets[i];
+        char *haystack = search->haystacks + size;
+
+        search->offsets[i] = size;
+        for (size_t j = 0; path[j] != '\0'; ++j) {
+            haystack[j] = (char) tolower((unsigned char) path[j]);
+            search->masks[i] |= fuzzy_char_bit(haystack[j]);
+            if (haystack[j] == '/' || haystack[j] == '\\') {
+                search->name_offsets[i] = j + 1;
+            }
+            size += 1;
+        }
+        size += 1;
+
+        search->matches[i].index = i;
+    }
+    search->matches_count = count;
+
+    return 0;
+}
+
+void destroy_fuzzy_search(Fuzzy_Search *search)
+{
+    trace_assert(search);
+
+    free(search->haystacks);
+    free(search->offsets);
+    free(search->name_offsets);
+    free(search->masks);
+    free(search->matches);
+    memset(search, 0, sizeof(*search));
+}
+
+void fuzzy_search_update(Fuzzy_Search *search, const char *query)
+{
+    trace_assert(search);
+    trace_assert(query);
+
+    const size_t query_size = strlen(query);
+    if (query_size >= EDIT_FIELD_CAPACITY) {
+        return;
+    }
+
+    char lower[EDIT_FIELD_CAPACITY];
+    for (size_t i = 0; i <= query_size; ++i) {
+        lower[i] = (char) tolower((unsigned char) query[i]);
+    }
+
+    if (query_size == search->query_size && memcmp(lower, search->query, query_size) == 0) {
+        return;
+    }
+
+    // Whatever did not match the previous query can't match the longer
+    // one either
+    const int refining =
+        query_size > search->query_size &&
+        memcmp(lower, search->query, search->query_size) == 0;
+
+    memcpy(search->query, lower, query_size + 1);
+    search->query_size = query_size;
+
+    if (query_size == 0) {
+        for (size_t i = 0; i < search->count; ++i) {
+            search->matches[i].index = i;
+            search->matches[i].score = 0;
+        }
+        search->matches_count = search->count;
+        return;
+    }
+
+    uint64_t query_mask = 0;
+    for (size_t i = 0; i < query_size; ++i) {
+        query_mask |= fuzzy_char_bit(lower[i]);
+    }
+
+    const size_t candidates_count = refining ? search->matches_count : search->count;
+    size_t matches_count = 0;
+    for (size_t k = 0; k < candidates_count; ++k) {
+        const size_t i = refining ? search->matches[k].index : k;
+        int score = 0;
+
+        if ((search->masks[i] & query_mask) == query_mask &&
+            fuzzy_search_score(search, i, &score)) {
+            search->matches[matches_count].index = i;
+            search->matches[matches_count].score = score;
+            matches_count += 1;
+        }
+    }
+    search->matches_count = matches_count;
+
+    qsort(search->matches, search->matches_count, sizeof(Fuzzy_Match), compare_matches);
+}
@@ -0,0 +1,52 @@
+#ifndef FUZZY_SEARCH_H_
+#define FUZZY_SEARCH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config.h"
+
+typedef struct {
+    size_t index;
+    int score;
+} Fuzzy_Match;
+
+// Fuzzy search over a fixed set of paths. A path matches the query if
+// the query is a subsequence of it, ignoring the case. The matches are
+// ordered by score: the matches inside of the file name, the
+// consecutive characters and the characters that start a word score
+// higher.
+//
+// The search is incremental. When the new query just appends to the
+// previous one, only the previous matches are checked again, so
+// typing a query gets cheaper with every character.
+typedef struct {
+    size_t count;
+    // Lowercased copies of the paths, NUL terminated one after
+    // another
+    char *haystacks;
+    size_t *offsets;
+    // Where the file name starts in every haystack
+    size_t *name_offsets;
+    // The characters every haystack has (see fuzzy_char_bit). A path
+    // is skipped right away if it lacks some character of the query.
+    uint64_t *masks;
+
+    char query[EDIT_FIELD_CAPACITY];
+    size_t query_size;
+    // Best first
+    Fuzzy_Match *matches;
+    size_t matches_count;
+} Fuzzy_Search;
+
+// paths are NUL terminated strings at offsets, they are copied. The
+// query is empty, so everything matches.
+int create_fuzzy_search(Fuzzy_Search *search,
+                        const char *paths,
+                        const size_t *offsets,
+                        size_t count);
+void destroy_fuzzy_search(Fuzzy_Search *search);
+
+void fuzzy_search_update(Fuzzy_Search *search, const char *query);
+
+#endif  // FUZZY_SEARCH_H_
@@ -0,0 +1,126 @@
+// Measures how jobs_parallel_for (see src/system/jobs.h) scales with
+// the amount of workers. The same arithmetic heavy loop over an array
+// is run with 0, 1, ... N workers and the best time of a few runs is
+// reported next to the speed up over no workers at all.
+//
+// Usage: bench_jobs [--workers N] [--count N] [--runs N]
+//
+// --workers defaults to jobs_default_workers_count(), --count is the
+// amount of elements (1 << 20 by default) and --runs the amount of
+// runs per worker count (10 by default).
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL.h>
+
+#include "system/jobs.h"
+
+#define BENCH_DEFAULT_COUNT (1 << 20)
+#define BENCH_DEFAULT_RUNS 10
+// Iterations per element, so an element costs about as much as
+// updating a rigid body
+#define BENCH_ITERATIONS 32
+
+static
+void bench_kernel(void *data, size_t begin, size_t end)
+{
+    float *xs = data;
+    for (size_t i = begin; i < end; ++i) {
+        float x = xs[i];
+        for (int k = 0; k < BENCH_ITERATIONS; ++k) {
+            x = sqrtf(x * x + 1.0f) * 0.5f;
+        }
+        xs[i] = x;
+    }
+}
+
+static
+int parse_count(const char *flag, const char *value, size_t *count)
+{
+    char *end = NULL;
+    const long x = value != NULL ? strtol(value, &end, 10) : 0;
+    if (value == NULL || *end != '\0' || x < 0) {
+        fprintf(stderr, "%s expects a non-negative number\n", flag);
+        return -1;
+    }
+    *count = (size_t) x;
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t max_workers = jobs_default_workers_count();
+    size_t count = BENCH_DEFAULT_COUNT;
+    size_t runs = BENCH_DEFAULT_RUNS;
+
+    for (int i = 1; i < argc; i += 2) {
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        size_t *target = NULL;
+        if (strcmp(argv[i], "--workers") == 0) {
+            target = &max_workers;
+        } else if (strcmp(argv[i], "--count") == 0) {
+            target = &count;
+        } else if (strcmp(argv[i], "--runs") == 0) {
+            target = &runs;
+        } else {
+            fprintf(stderr, "Usage: bench_jobs [--workers N] [--count N] [--runs N]\n");
+            return 1;
+        }
+
+        if (parse_count(argv[i], value, target) < 0) {
+            return 1;
+        }
+    }
+
+    if (count == 0 || runs == 0) {
+        fprintf(stderr, "--count and --runs must be positive\n");
+        return 1;
+    }
+
+    float *xs = malloc(count * sizeof(float));
+    if (xs == NULL) {
+        fprintf(stderr, "Could not allocate %lu elements\n", (unsigned long) count);
+        return 1;
+    }
+
+    const double frequency = (double) SDL_GetPerformanceFrequency();
+    double baseline = 0.0;
+
+    printf("%8s %12s %8s\n", "workers", "best ms", "speedup");
+    for (size_t workers = 0; workers <= max_workers; ++workers) {
+        Jobs *jobs = create_jobs(workers);
+        if (jobs == NULL) {
+            free(xs);
+            return 1;
+        }
+
+        double best = 0.0;
+        for (size_t run = 0; run < runs; ++run) {
+            for (size_t i = 0; i < count; ++i) {
+                xs[i] = (float) i;
+            }
+
+            const Uint64 begin = SDL_GetPerformanceCounter();
+            jobs_parallel_for(jobs, bench_kernel, xs, count, 0);
+            const double ms = (double) (SDL_GetPerformanceCounter() - begin) * 1000.0 / frequency;
+
+            if (run == 0 || ms < best) {
+                best = ms;
+            }
+        }
+
+        if (workers == 0) {
+            baseline = best;
+        }
+        printf("%8lu %12.3f %8.2f\n", (unsigned long) workers, best, baseline / best);
+
+        destroy_jobs(jobs);
+    }
+
+    free(xs);
+
+    return 0;
+}
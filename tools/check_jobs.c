@@ -0,0 +1,246 @@
+// Checks the job system (see src/system/jobs.h) with no workers, one
+// worker and a few of them: every submitted job runs exactly once and
+// the counters drop to zero, jobs_submit_after does not start a job
+// before its dependency is done, jobs_wait inside of a job keeps
+// helping instead of blocking a worker, and jobs_parallel_for covers
+// the whole range exactly once.
+//
+// Usage: check_jobs
+// Exits with 1 if any check fails.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <SDL.h>
+
+#include "system/jobs.h"
+
+#define CHECK_JOBS_COUNT 1000
+#define CHECK_STAGE_COUNT 64
+#define CHECK_NESTED_OUTER 32
+#define CHECK_NESTED_INNER 500
+#define CHECK_RANGE_CAPACITY 10007
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                                \
+    do {                                                \
+        if (!(cond)) {                                  \
+            fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__); \
+            fprintf(stderr, __VA_ARGS__);               \
+            fprintf(stderr, "\n");                      \
+            failures += 1;                              \
+        }                                               \
+    } while (0)
+
+static SDL_atomic_t runs[CHECK_RANGE_CAPACITY];
+
+static
+void count_runs(void *data, size_t begin, size_t end)
+{
+    (void) data;
+    for (size_t i = begin; i < end; ++i) {
+        SDL_AtomicAdd(&runs[i], 1);
+    }
+}
+
+static
+void clear_runs(void)
+{
+    for (size_t i = 0; i < CHECK_RANGE_CAPACITY; ++i) {
+        SDL_AtomicSet(&runs[i], 0);
+    }
+}
+
+static
+void check_counters(Jobs *jobs)
+{
+    clear_runs();
+
+    Job_Counter counter = {{0}};
+    for (size_t i = 0; i < CHECK_JOBS_COUNT; ++i) {
+        jobs_submit(jobs, job(count_runs, NULL, i, i + 1), &counter);
+    }
+    jobs_wait(jobs, &counter);
+
+    CHECK(SDL_AtomicGet(&counter.pending) == 0,
+          "counter is %d after jobs_wait", SDL_AtomicGet(&counter.pending));
+    for (size_t i = 0; i < CHECK_JOBS_COUNT; ++i) {
+        CHECK(SDL_AtomicGet(&runs[i]) == 1,
+              "job %lu ran %d times", (unsigned long) i, SDL_AtomicGet(&runs[i]));
+    }
+}
+
+typedef struct {
+    SDL_atomic_t first_done;
+    SDL_atomic_t second_done;
+    SDL_atomic_t too_early;
+} Stages;
+
+static
+void first_stage(void *data, size_t begin, size_t end)
+{
+    (void) begin;
+    (void) end;
+    Stages *stages = data;
+    // Gives the second stage a chance to start too early
+    SDL_Delay(0);
+    SDL_AtomicAdd(&stages->first_done, 1);
+}
+
+static
+void second_stage(void *data, size_t begin, size_t end)
+{
+    (void) begin;
+    (void) end;
+    Stages *stages = data;
+    if (SDL_AtomicGet(&stages->first_done) != CHECK_STAGE_COUNT) {
+        SDL_AtomicAdd(&stages->too_early, 1);
+    }
+    SDL_AtomicAdd(&stages->second_done, 1);
+}
+
+static
+void third_stage(void *data, size_t begin, size_t end)
+{
+    (void) begin;
+    (void) end;
+    Stages *stages = data;
+    if (SDL_AtomicGet(&stages->second_done) != CHECK_STAGE_COUNT) {
+        SDL_AtomicAdd(&stages->too_early, 1);
+    }
+}
+
+static
+void check_submit_after(Jobs *jobs)
+{
+    Stages stages;
+    SDL_AtomicSet(&stages.first_done, 0);
+    SDL_AtomicSet(&stages.second_done, 0);
+    SDL_AtomicSet(&stages.too_early, 0);
+
+    Job_Counter first = {{0}};
+    Job_Counter second = {{0}};
+    Job_Counter third = {{0}};
+
+    for (size_t i = 0; i < CHECK_STAGE_COUNT; ++i) {
+        jobs_submit(jobs, job(first_stage, &stages, 0, 1), &first);
+    }
+    for (size_t i = 0; i < CHECK_STAGE_COUNT; ++i) {
+        jobs_submit_after(jobs, job(second_stage, &stages, 0, 1), &second, &first);
+    }
+    jobs_submit_after(jobs, job(third_stage, &stages, 0, 1), &third, &second);
+    jobs_wait(jobs, &third);
+
+    CHECK(SDL_AtomicGet(&stages.too_early) == 0,
+          "%d jobs started before their dependency was done",
+          SDL_AtomicGet(&stages.too_early));
+    CHECK(SDL_AtomicGet(&first.pending) == 0 && SDL_AtomicGet(&second.pending) == 0,
+          "the dependencies are not done after the dependent job");
+}
+
+typedef struct {
+    Jobs *jobs;
+    SDL_atomic_t sum;
+} Nested;
+
+static
+void nested_inner(void *data, size_t begin, size_t end)
+{
+    Nested *nested = data;
+    SDL_AtomicAdd(&nested->sum, (int) (end - begin));
+}
+
+static
+void nested_outer(void *data, size_t begin, size_t end)
+{
+    Nested *nested = data;
+    for (size_t i = begin; i < end; ++i) {
+        // Every worker ends up waiting in here at some point. The
+        // inner jobs only get done if the waiting ones help.
+        jobs_parallel_for(nested->jobs, nested_inner, nested,
+                          CHECK_NESTED_INNER, 7);
+    }
+}
+
+static
+void check_nested_wait(Jobs *jobs)
+{
+    Nested nested;
+    nested.jobs = jobs;
+    SDL_AtomicSet(&nested.sum, 0);
+
+    jobs_parallel_for(jobs, nested_outer, &nested, CHECK_NESTED_OUTER, 1);
+
+    CHECK(SDL_AtomicGet(&nested.sum) == CHECK_NESTED_OUTER * CHECK_NESTED_INNER,
+          "nested jobs did %d elements out of %d",
+          SDL_AtomicGet(&nested.sum), CHECK_NESTED_OUTER * CHECK_NESTED_INNER);
+}
+
+static
+void check_parallel_for(Jobs *jobs)
+{
+    static const size_t counts[] = {1, 2, 3, 63, 64, 65, 1000, CHECK_RANGE_CAPACITY};
+    static const size_t grains[] = {0, 1, 2, 7, 64, 100000};
+
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c) {
+        for (size_t g = 0; g < sizeof(grains) / sizeof(grains[0]); ++g) {
+            clear_runs();
+            jobs_parallel_for(jobs, count_runs, NULL, counts[c], grains[g]);
+
+            size_t wrong = 0;
+            for (size_t i = 0; i < CHECK_RANGE_CAPACITY; ++i) {
+                const int expected = i < counts[c] ? 1 : 0;
+                if (SDL_AtomicGet(&runs[i]) != expected) {
+                    wrong += 1;
+                }
+            }
+            CHECK(wrong == 0,
+                  "parallel_for of %lu with grain %lu got %lu elements wrong",
+                  (unsigned long) counts[c], (unsigned long) grains[g],
+                  (unsigned long) wrong);
+        }
+    }
+
+    clear_runs();
+    jobs_parallel_for(jobs, count_runs, NULL, 0, 0);
+    CHECK(SDL_AtomicGet(&runs[0]) == 0, "parallel_for of 0 ran something");
+}
+
+static
+void check_all(Jobs *jobs)
+{
+    check_counters(jobs);
+    check_submit_after(jobs);
+    check_nested_wait(jobs);
+    check_parallel_for(jobs);
+}
+
+int main(int argc, char *argv[])
+{
+    (void) argc;
+    (void) argv;
+
+    // No pool at all runs everything right away
+    check_all(NULL);
+
+    const size_t workers_counts[] = {0, 1, 2, 4, jobs_default_workers_count()};
+    for (size_t i = 0; i < sizeof(workers_counts) / sizeof(workers_counts[0]); ++i) {
+        Jobs *jobs = create_jobs(workers_counts[i]);
+        if (jobs == NULL) {
+            fprintf(stderr, "Could not create %lu workers\n",
+                    (unsigned long) workers_counts[i]);
+            return 1;
+        }
+        check_all(jobs);
+        destroy_jobs(jobs);
+    }
+
+    if (failures > 0) {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+
+    printf("All checks passed\n");
+    return 0;
+}
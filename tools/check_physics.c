@@ -0,0 +1,151 @@
+// Checks that the simulation does not depend on the amount of job
+// workers: a few piles of boxes, far enough from each other to be
+// separate contact islands, are dropped into a small level and
+// simulated for a few seconds with no pool, one worker and a few of
+// them. The level snapshots at the end must be the same byte for
+// byte.
+//
+// Usage: check_physics
+// Exits with 1 if the snapshots differ.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL.h>
+
+#include "game/level.h"
+#include "game/level/level_data.h"
+#include "math/rand.h"
+#include "system/id_table.h"
+#include "system/jobs.h"
+#include "system/memory.h"
+#include "system/nth_alloc.h"
+#include "system/s.h"
+#include "config.h"
+
+#define CHECK_FPS 60
+#define CHECK_DELTA_TIME (1.0f / (float) CHECK_FPS)
+#define CHECK_FRAMES (3 * CHECK_FPS)
+#define CHECK_PILES_COUNT 4
+#define CHECK_PILE_BOXES_COUNT 100
+#define CHECK_PILE_WIDTH 300.0f
+#define CHECK_PILE_STRIDE 550.0f
+#define CHECK_SEED 0x6e6f7468u
+
+// A floor with a wall on each side, so the boxes pile up instead of
+// sliding away
+static const char check_level[] =
+    "2\n"
+    "073642\n"
+    "100.0 400.0 b58900\n"
+    "3\n"
+    "floor -100.0 700.0 2200.0 100.0 657b83\n"
+    "left -100.0 -1000.0 100.0 1700.0 657b83\n"
+    "right 2000.0 -1000.0 100.0 1700.0 657b83\n"
+    "0\n"
+    "0\n"
+    "0\n"
+    "0\n"
+    "0\n"
+    "0\n";
+
+// Returns the snapshot of the level after CHECK_FRAMES or NULL
+static
+void *simulate(Memory *memory, Jobs *jobs, size_t *snapshot_size)
+{
+    memory_clean(memory);
+
+    Level_Data data;
+    if (level_data_load(&data, memory, STRING_LIT(check_level)) < 0) {
+        fprintf(stderr, "Could not load the level\n");
+        return NULL;
+    }
+
+    Level *level = create_level(&data);
+    if (level == NULL) {
+        return NULL;
+    }
+    level_disable_rewind(level);
+
+    Rng rng = create_rng(CHECK_SEED, 0);
+    for (size_t i = 0; i < CHECK_PILES_COUNT; ++i) {
+        level_spawn_boxes(
+            level, &rng, CHECK_PILE_BOXES_COUNT,
+            rect((float) i * CHECK_PILE_STRIDE, 0.0f, CHECK_PILE_WIDTH, 650.0f));
+    }
+
+    void *snapshot = NULL;
+    for (size_t frame = 0; frame < CHECK_FRAMES; ++frame) {
+        if (level_update(level, CHECK_DELTA_TIME, jobs) < 0) {
+            goto end;
+        }
+    }
+
+    *snapshot_size = level_snapshot_size(level);
+    snapshot = nth_calloc(1, *snapshot_size);
+    if (snapshot != NULL) {
+        level_snapshot(level, snapshot, *snapshot_size);
+    }
+
+end:
+    destroy_level(level);
+    return snapshot;
+}
+
+int main(int argc, char *argv[])
+{
+    (void) argc;
+    (void) argv;
+
+    Memory memory = {
+        .capacity = LEVEL_EDITOR_MEMORY_CAPACITY,
+        .buffer = nth_calloc(1, LEVEL_EDITOR_MEMORY_CAPACITY)
+    };
+    if (memory.buffer == NULL) {
+        return 1;
+    }
+
+    // No pool at all is the reference
+    size_t expected_size = 0;
+    void *expected = simulate(&memory, NULL, &expected_size);
+    if (expected == NULL) {
+        return 1;
+    }
+
+    int result = 0;
+    const size_t workers_counts[] = {1, 4};
+    for (size_t i = 0; i < sizeof(workers_counts) / sizeof(workers_counts[0]); ++i) {
+        Jobs *jobs = create_jobs(workers_counts[i]);
+        if (jobs == NULL) {
+            fprintf(stderr, "Could not create %lu workers\n",
+                    (unsigned long) workers_counts[i]);
+            return 1;
+        }
+
+        size_t size = 0;
+        void *snapshot = simulate(&memory, jobs, &size);
+        if (snapshot == NULL) {
+            return 1;
+        }
+
+        if (size != expected_size || memcmp(snapshot, expected, size) != 0) {
+            fprintf(stderr, "FAIL: %lu workers simulated the level differently than no pool\n",
+                    (unsigned long) workers_counts[i]);
+            result = 1;
+        }
+
+        free(snapshot);
+        destroy_jobs(jobs);
+    }
+
+    free(expected);
+    free(memory.buffer);
+    id_table_free();
+
+    if (result == 0) {
+        printf("All checks passed\n");
+    }
+
+    return result;
+}
@@ -0,0 +1,198 @@
+// Packs the assets into a single file that the game reads at startup
+// (see src/system/assets.h). The images are decoded into ARGB8888
+// pixels and the sounds into raw PCM here, so the game does not have
+// to parse any file formats.
+//
+// Usage: pack_assets <output> <assets-folder> <name>...
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL.h>
+
+#include "system/assets.h"
+
+#define PATH_CAPACITY 512
+
+typedef struct {
+    void *data;
+    size_t size;
+    void (*free_data)(void *);
+    void *owner;
+} Loaded;
+
+static
+void free_surface(void *surface)
+{
+    SDL_FreeSurface(surface);
+}
+
+static
+void free_wav(void *samples)
+{
+    SDL_FreeWAV(samples);
+}
+
+static
+int load_asset(const char *path, Assets_Pack_Entry *entry, Loaded *loaded)
+{
+    const char *ext = strrchr(path, '.');
+
+    if (ext != NULL && strcmp(ext, ".bmp") == 0) {
+        SDL_Surface *bmp = SDL_LoadBMP(path);
+        if (bmp == NULL) {
+            fprintf(stderr, "Could not load %s: %s\n", path, SDL_GetError());
+            return -1;
+        }
+
+        SDL_Surface *surface = SDL_ConvertSurfaceFormat(bmp, SDL_PIXELFORMAT_ARGB8888, 0);
+        SDL_FreeSurface(bmp);
+        if (surface == NULL) {
+            fprintf(stderr, "Could not convert %s: %s\n", path, SDL_GetError());
+            return -1;
+        }
+
+        entry->kind = ASSET_KIND_IMAGE;
+        entry->width = (uint32_t) surface->w;
+        entry->height = (uint32_t) surface->h;
+        entry->pitch = (uint32_t) surface->pitch;
+        loaded->data = surface->pixels;
+        loaded->size = (size_t) (surface->pitch * surface->h);
+        loaded->owner = surface;
+        loaded->free_data = free_surface;
+        return 0;
+    }
+
+    if (ext != NULL && strcmp(ext, ".wav") == 0) {
+        SDL_AudioSpec spec;
+        Uint8 *samples = NULL;
+        Uint32 samples_size = 0;
+        if (SDL_LoadWAV(path, &spec, &samples, &samples_size) == NULL) {
+            fprintf(stderr, "Could not load %s: %s\n", path, SDL_GetError());
+            return -1;
+        }
+
+        entry->kind = ASSET_KIND_SOUND;
+        entry->freq = (uint32_t) spec.freq;
+        entry->format = spec.format;
+        entry->channels = spec.channels;
+        loaded->data = samples;
+        loaded->size = samples_size;
+        loaded->owner = samples;
+        loaded->free_data = free_wav;
+        return 0;
+    }
+
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        fprintf(stderr, "Could not open %s\n", path);
+        return -1;
+    }
+
+    long size = -1;
+    if (fseek(f, 0, SEEK_END) == 0) {
+        size = ftell(f);
+        fseek(f, 0, SEEK_SET);
+    }
+
+    void *data = size >= 0 ? malloc((size_t) size + 1) : NULL;
+    if (data == NULL || fread(data, 1, (size_t) size, f) != (size_t) size) {
+        fprintf(stderr, "Could not read %s\n", path);
+        free(data);
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+
+    entry->kind = ASSET_KIND_RAW;
+    loaded->data = data;
+    loaded->size = (size_t) size;
+    loaded->owner = data;
+    loaded->free_data = free;
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3) {
+        fprintf(stderr, "Usage: pack_assets <output> <assets-folder> <name>...\n");
+        return 1;
+    }
+
+    const char *output_path = argv[1];
+    const char *folder = argv[2];
+    const size_t count = (size_t) (argc - 3);
+
+    Assets_Pack_Entry *entries = calloc(count + 1, sizeof(Assets_Pack_Entry));
+    Loaded *loaded = calloc(count + 1, sizeof(Loaded));
+    if (entries == NULL || loaded == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    int result = 0;
+    size_t offset = sizeof(Assets_Pack_Header) + count * sizeof(Assets_Pack_Entry);
+
+    for (size_t i = 0; i < count; ++i) {
+        const char *name = argv[i + 3];
+        if (strlen(name) >= ASSETS_NAME_CAPACITY) {
+            fprintf(stderr, "Asset name %s is too long\n", name);
+            result = 1;
+            goto end;
+        }
+
+        char path[PATH_CAPACITY];
+        snprintf(path, sizeof(path), "%s/%s", folder, name);
+
+        if (load_asset(path, &entries[i], &loaded[i]) < 0) {
+            result = 1;
+            goto end;
+        }
+
+        offset = (offset + ASSETS_PACK_ALIGNMENT - 1) / ASSETS_PACK_ALIGNMENT * ASSETS_PACK_ALIGNMENT;
+        strncpy(entries[i].name, name, ASSETS_NAME_CAPACITY - 1);
+        entries[i].offset = (uint32_t) offset;
+        entries[i].size = (uint32_t) loaded[i].size;
+        offset += loaded[i].size;
+    }
+
+    FILE *output = fopen(output_path, "wb");
+    if (output == NULL) {
+        fprintf(stderr, "Could not open %s\n", output_path);
+        result = 1;
+        goto end;
+    }
+
+    const Assets_Pack_Header header = {
+        .magic = ASSETS_PACK_MAGIC,
+        .version = ASSETS_PACK_VERSION,
+        .count = (uint32_t) count
+    };
+    fwrite(&header, sizeof(header), 1, output);
+    fwrite(entries, sizeof(Assets_Pack_Entry), count, output);
+
+    static const char padding[ASSETS_PACK_ALIGNMENT] = {0};
+    for (size_t i = 0; i < count; ++i) {
+        const long position = ftell(output);
+        fwrite(padding, 1, entries[i].offset - (size_t) position, output);
+        fwrite(loaded[i].data, 1, loaded[i].size, output);
+    }
+
+    if (ferror(output)) {
+        fprintf(stderr, "Could not write %s\n", output_path);
+        result = 1;
+    }
+    fclose(output);
+
+end:
+    for (size_t i = 0; i < count; ++i) {
+        if (loaded[i].free_data != NULL) {
+            loaded[i].free_data(loaded[i].owner);
+        }
+    }
+    free(loaded);
+    free(entries);
+
+    return result;
+}
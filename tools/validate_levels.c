@@ -0,0 +1,481 @@
+// Checks that the goals of the levels can be reached. The player is
+// simulated from the spawn point without the window: a breadth first
+// search over the input sequences, where every step holds one of the
+// moves below for VALIDATE_MOVE_FRAMES frames. The states are kept as
+// level snapshots and the moves of every step are simulated in
+// parallel, each worker restoring the snapshots into its own Level.
+//
+// The levels themselves are updated without a job pool, while the game
+// updates them on its workers. This relies on the simulation giving
+// the same result with any amount of workers, which ctest checks with
+// tools/check_physics.c. Otherwise the physics validated here would
+// not be the physics the players get.
+//
+// The search is not exhaustive. The states where the player and the
+// boxes end up in the cells that were already visited are dropped and
+// at most --beam states survive each step, so a goal that was not
+// reached is not necessarily unreachable. A reached one definitely is
+// reachable and the reported time is close to the fastest route.
+//
+// Usage: validate_levels [--beam N] [--seconds N] <level-file>...
+
+#include <stdbool.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL.h>
+
+#include "game/level.h"
+#include "game/level/boxes.h"
+#include "game/level/goals.h"
+#include "game/level/level_data.h"
+#include "system/file.h"
+#include "system/id_table.h"
+#include "system/jobs.h"
+#include "system/memory.h"
+#include "system/nth_alloc.h"
+#include "system/s.h"
+#include "system/stacktrace.h"
+#include "config.h"
+
+#define VALIDATE_FPS 60
+#define VALIDATE_DELTA_TIME (1.0f / (float) VALIDATE_FPS)
+#define VALIDATE_MOVE_FRAMES 10
+#define VALIDATE_DEFAULT_BEAM 128
+#define VALIDATE_DEFAULT_SECONDS 30
+// The reached goals of a state are a bit mask
+#define VALIDATE_GOALS_CAPACITY 64
+// The states where the player and the boxes are in the same cells
+// are considered the same
+#define VALIDATE_CELL_SIZE 20.0f
+#define VALIDATE_BOX_CELL_SIZE 40.0f
+// Must be a power of two
+#define VALIDATE_VISITED_CAPACITY (1 << 18)
+
+typedef struct {
+    int direction;
+    bool jump;
+} Move;
+
+static const Move moves[] = {
+    {0, false},
+    {-1, false},
+    {1, false},
+    {0, true},
+    {-1, true},
+    {1, true},
+};
+#define MOVES_COUNT (sizeof(moves) / sizeof(moves[0]))
+
+typedef struct {
+    size_t parent;
+    size_t move;
+    uint64_t key;
+    uint64_t reached;
+    bool alive;
+} Outcome;
+
+typedef struct {
+    Level **lanes;
+    size_t lanes_count;
+    size_t *lanes_frames;
+    size_t goals_count;
+
+    size_t snapshot_size;
+    uint8_t *frontier;
+    size_t frontier_count;
+    uint8_t *next;
+
+    Outcome *outcomes;
+    size_t outcomes_count;
+    size_t *survivors;
+    size_t survivors_count;
+
+    uint64_t *visited;
+    size_t visited_count;
+} Search;
+
+static
+uint64_t cell_of(Rect hitbox, float cell_size)
+{
+    const int32_t x = (int32_t) floorf(hitbox.x / cell_size);
+    const int32_t y = (int32_t) floorf(hitbox.y / cell_size);
+    return ((uint64_t) (uint32_t) x << 32) | (uint32_t) y;
+}
+
+static
+uint64_t hash_cell(uint64_t key, uint64_t cell)
+{
+    return string_hash64_append(key, string(sizeof(cell), (const char *) &cell));
+}
+
+// Two states of the level with the same key are considered the same
+static
+uint64_t state_key(Level *level, Rect begin)
+{
+    const Rect end = player_hitbox(level_player(level));
+    // Going up and falling down through the same cell are different
+    // states, only one of them can get higher
+    const uint64_t rising = end.y < begin.y;
+
+    uint64_t key = STRING_HASH64_BASIS;
+    key = hash_cell(key, cell_of(end, VALIDATE_CELL_SIZE));
+    key = hash_cell(key, rising);
+
+    // Some goals can only be reached by moving the boxes around
+    const Boxes *boxes = level_boxes(level);
+    const size_t n = boxes_count(boxes);
+    for (size_t i = 0; i < n; ++i) {
+        key = hash_cell(key, cell_of(boxes_hitbox(boxes, i), VALIDATE_BOX_CELL_SIZE));
+    }
+
+    return key;
+}
+
+static
+size_t simulate_move(Level *level, size_t goals_count,
+                     const Move *move, Outcome *outcome)
+{
+    Player *player = level_player(level);
+    const Goals *goals = level_goals(level);
+    const Rect begin = player_hitbox(player);
+
+    outcome->alive = true;
+    outcome->reached = 0;
+
+    size_t frame = 0;
+    while (frame < VALIDATE_MOVE_FRAMES) {
+        if (move->direction < 0) {
+            player_move_left(player);
+        } else if (move->direction > 0) {
+            player_move_right(player);
+        } else {
+            player_stop(player);
+        }
+
+        if (move->jump && frame == 0) {
+            player_jump(player);
+        }
+
+        frame += 1;
+        // No pool, the moves are already spread over the workers. The
+        // result is the same as in the game (see the top of the file).
+        if (level_update(level, VALIDATE_DELTA_TIME, NULL) < 0 || !player_alive(player)) {
+            outcome->alive = false;
+            break;
+        }
+
+        for (size_t i = 0; i < goals_count; ++i) {
+            if (goals_reached(goals, i, player)) {
+                outcome->reached |= (uint64_t) 1 << i;
+            }
+        }
+    }
+
+    outcome->key = state_key(level, begin);
+
+    return frame;
+}
+
+// [begin, end) are lanes, every lane simulates its share of the
+// outcomes on its own Level
+static
+void simulate_outcomes_job(void *data, size_t begin, size_t end)
+{
+    Search *search = data;
+    trace_assert(search);
+
+    for (size_t lane = begin; lane < end; ++lane) {
+        const size_t first = search->outcomes_count * lane / search->lanes_count;
+        const size_t last = search->outcomes_count * (lane + 1) / search->lanes_count;
+
+        for (size_t i = first; i < last; ++i) {
+            Outcome *outcome = &search->outcomes[i];
+            level_restore(
+                search->lanes[lane],
+                search->frontier + outcome->parent * search->snapshot_size,
+                search->snapshot_size);
+            search->lanes_frames[lane] += simulate_move(
+                search->lanes[lane],
+                search->goals_count,
+                &moves[outcome->move],
+                outcome);
+        }
+    }
+}
+
+// Simulates the survivors once more to snapshot them into the next
+// frontier. Keeping the snapshots of all the outcomes instead would
+// take MOVES_COUNT times more memory.
+static
+void advance_survivors_job(void *data, size_t begin, size_t end)
+{
+    Search *search = data;
+    trace_assert(search);
+
+    for (size_t lane = begin; lane < end; ++lane) {
+        const size_t first = search->survivors_count * lane / search->lanes_count;
+        const size_t last = search->survivors_count * (lane + 1) / search->lanes_count;
+
+        for (size_t i = first; i < last; ++i) {
+            Outcome outcome = search->outcomes[search->survivors[i]];
+            level_restore(
+                search->lanes[lane],
+                search->frontier + outcome.parent * search->snapshot_size,
+                search->snapshot_size);
+            search->lanes_frames[lane] += simulate_move(
+                search->lanes[lane],
+                search->goals_count,
+                &moves[outcome.move],
+                &outcome);
+            level_snapshot(
+                search->lanes[lane],
+                search->next + i * search->snapshot_size,
+                search->snapshot_size);
+        }
+    }
+}
+
+// Returns true if the state was not visited before
+static
+bool visit_state(Search *search, uint64_t key)
+{
+    // Zero marks an empty slot
+    key |= 1;
+    size_t slot = (size_t) (key >> 40) & (VALIDATE_VISITED_CAPACITY - 1);
+
+    while (search->visited[slot] != 0) {
+        if (search->visited[slot] == key) {
+            return false;
+        }
+        slot = (slot + 1) & (VALIDATE_VISITED_CAPACITY - 1);
+    }
+
+    // Keeps the probes short. Once the table is full every state is
+    // new, which only makes the search slower.
+    if (search->visited_count < VALIDATE_VISITED_CAPACITY / 4 * 3) {
+        search->visited[slot] = key;
+        search->visited_count += 1;
+    }
+
+    return true;
+}
+
+static
+int validate_level(Jobs *jobs, Memory *memory, const char *file_path,
+                   size_t beam, size_t max_steps)
+{
+    memory_clean(memory);
+    String input = read_whole_file(memory, file_path);
+    if (input.data == NULL) {
+        fprintf(stderr, "%s: could not open the file\n", file_path);
+        return -1;
+    }
+
+    Level_Data data;
+    if (level_data_load(&data, memory, input) < 0) {
+        fprintf(stderr, "%s: could not load the level\n", file_path);
+        return -1;
+    }
+
+    const Uint64 begin_time = SDL_GetPerformanceCounter();
+
+    int result = -1;
+    Search search;
+    memset(&search, 0, sizeof(search));
+    search.lanes_count = jobs_workers_count(jobs) + 1;
+
+    search.lanes = nth_calloc(search.lanes_count, sizeof(Level*));
+    search.lanes_frames = nth_calloc(search.lanes_count, sizeof(size_t));
+    if (search.lanes == NULL || search.lanes_frames == NULL) {
+        goto end;
+    }
+
+    for (size_t lane = 0; lane < search.lanes_count; ++lane) {
+        search.lanes[lane] = create_level(&data);
+        if (search.lanes[lane] == NULL) {
+            goto end;
+        }
+        level_disable_rewind(search.lanes[lane]);
+    }
+
+    search.goals_count = goals_count(level_goals(search.lanes[0]));
+    if (search.goals_count > VALIDATE_GOALS_CAPACITY) {
+        fprintf(stderr, "%s: only the first %d goals out of %zu are checked\n",
+                file_path, VALIDATE_GOALS_CAPACITY, search.goals_count);
+        search.goals_count = VALIDATE_GOALS_CAPACITY;
+    }
+
+    search.snapshot_size = level_snapshot_size(search.lanes[0]);
+    search.frontier = nth_calloc(beam, search.snapshot_size);
+    search.next = nth_calloc(beam, search.snapshot_size);
+    search.outcomes = nth_calloc(beam * MOVES_COUNT, sizeof(Outcome));
+    search.survivors = nth_calloc(beam, sizeof(size_t));
+    search.visited = nth_calloc(VALIDATE_VISITED_CAPACITY, sizeof(uint64_t));
+    if (search.frontier == NULL || search.next == NULL ||
+        search.outcomes == NULL || search.survivors == NULL ||
+        search.visited == NULL) {
+        goto end;
+    }
+
+    level_snapshot(search.lanes[0], search.frontier, search.snapshot_size);
+    search.frontier_count = 1;
+    visit_state(&search, state_key(
+                    search.lanes[0],
+                    player_hitbox(level_player(search.lanes[0]))));
+
+    // The step at which every goal was reached, zero if it wasn't
+    size_t reached_at[VALIDATE_GOALS_CAPACITY] = {0};
+    size_t reached_count = 0;
+
+    for (size_t step = 1;
+         step <= max_steps && search.frontier_count > 0 && reached_count < search.goals_count;
+         ++step) {
+        search.outcomes_count = search.frontier_count * MOVES_COUNT;
+        for (size_t i = 0; i < search.outcomes_count; ++i) {
+            search.outcomes[i].parent = i / MOVES_COUNT;
+            search.outcomes[i].move = i % MOVES_COUNT;
+        }
+        jobs_parallel_for(jobs, simulate_outcomes_job, &search, search.lanes_count, 1);
+
+        // Picked in the order of the outcomes, so the search does not
+        // depend on the amount of the workers either
+        search.survivors_count = 0;
+        for (size_t i = 0; i < search.outcomes_count; ++i) {
+            const Outcome *outcome = &search.outcomes[i];
+
+            for (size_t goal = 0; goal < search.goals_count; ++goal) {
+                if ((outcome->reached & ((uint64_t) 1 << goal)) && reached_at[goal] == 0) {
+                    reached_at[goal] = step;
+                    reached_count += 1;
+                }
+            }
+
+            if (outcome->alive &&
+                search.survivors_count < beam &&
+                visit_state(&search, outcome->key)) {
+                search.survivors[search.survivors_count++] = i;
+            }
+        }
+
+        jobs_parallel_for(jobs, advance_survivors_job, &search, search.lanes_count, 1);
+
+        uint8_t *frontier = search.frontier;
+        search.frontier = search.next;
+        search.next = frontier;
+        search.frontier_count = search.survivors_count;
+    }
+
+    size_t frames = 0;
+    for (size_t lane = 0; lane < search.lanes_count; ++lane) {
+        frames += search.lanes_frames[lane];
+    }
+    const float seconds =
+        (float) (SDL_GetPerformanceCounter() - begin_time)
+        / (float) SDL_GetPerformanceFrequency();
+
+    printf("%s: %zu/%zu goals reachable\n", file_path, reached_count, search.goals_count);
+    for (size_t goal = 0; goal < search.goals_count; ++goal) {
+        const char *id = id_table_cstr(goals_id(level_goals(search.lanes[0]), goal));
+        if (reached_at[goal] > 0) {
+            printf("    %s: reached in %.2f s\n", id,
+                   (double) (reached_at[goal] * VALIDATE_MOVE_FRAMES) / VALIDATE_FPS);
+        } else {
+            printf("    %s: NOT reached within %.2f s\n", id,
+                   (double) (max_steps * VALIDATE_MOVE_FRAMES) / VALIDATE_FPS);
+        }
+    }
+    if (frames > 0) {
+        printf("    simulated %zu frames in %.2f s on %zu threads, %.0fx real time\n",
+               frames, (double) seconds, search.lanes_count,
+               (double) ((float) frames / VALIDATE_FPS / seconds));
+    }
+
+    result = reached_count == search.goals_count ? 0 : 1;
+
+end:
+    free(search.visited);
+    free(search.survivors);
+    free(search.outcomes);
+    free(search.next);
+    free(search.frontier);
+    if (search.lanes != NULL) {
+        for (size_t lane = 0; lane < search.lanes_count; ++lane) {
+            if (search.lanes[lane] != NULL) {
+                destroy_level(search.lanes[lane]);
+            }
+        }
+    }
+    free(search.lanes_frames);
+    free(search.lanes);
+
+    return result;
+}
+
+static
+int parse_count(const char *flag, const char *value, size_t *count)
+{
+    char *end = NULL;
+    const long x = value != NULL ? strtol(value, &end, 10) : 0;
+    if (value == NULL || *end != '\0' || x <= 0) {
+        fprintf(stderr, "%s expects a positive number\n", flag);
+        return -1;
+    }
+    *count = (size_t) x;
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t beam = VALIDATE_DEFAULT_BEAM;
+    size_t seconds = VALIDATE_DEFAULT_SECONDS;
+
+    int i = 1;
+    for (; i < argc && strncmp(argv[i], "--", 2) == 0; i += 2) {
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(argv[i], "--beam") == 0) {
+            if (parse_count(argv[i], value, &beam) < 0) {
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--seconds") == 0) {
+            if (parse_count(argv[i], value, &seconds) < 0) {
+                return 1;
+            }
+        } else {
+            fprintf(stderr, "Unknown flag %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (i >= argc) {
+        fprintf(stderr, "Usage: validate_levels [--beam N] [--seconds N] <level-file>...\n");
+        return 1;
+    }
+
+    Memory memory = {
+        .capacity = LEVEL_EDITOR_MEMORY_CAPACITY,
+        .buffer = nth_calloc(1, LEVEL_EDITOR_MEMORY_CAPACITY)
+    };
+    Jobs *jobs = create_jobs(jobs_default_workers_count());
+    if (memory.buffer == NULL || jobs == NULL) {
+        return 1;
+    }
+
+    const size_t max_steps = seconds * VALIDATE_FPS / VALIDATE_MOVE_FRAMES;
+
+    int result = 0;
+    for (; i < argc; ++i) {
+        if (validate_level(jobs, &memory, argv[i], beam, max_steps) != 0) {
+            result = 1;
+        }
+    }
+
+    destroy_jobs(jobs);
+    free(memory.buffer);
+    id_table_free();
+
+    return result;
+}